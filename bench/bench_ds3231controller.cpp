@@ -0,0 +1,318 @@
+/**
+ * DS3231Controller Benchmarks
+ *
+ * Prices the schedule queries, a year of simulation, status formatting, state
+ * export and the persistence path per call, for 1 to MAX_SCHEDULES schedules:
+ * elapsed time, CPU time, I2C transactions and bytes, and heap allocations.
+ * Results are printed as JSON lines, one object per benchmark and schedule
+ * count, for bench/compare.py to diff against a baseline.
+ *
+ *   pio run -e bench_native -t exec            # host, mock DS3231 at 400 kHz
+ *   pio run -e bench_native_static -t exec     # host, DS3231_STATIC_STORAGE
+ *   pio run -e bench_esp32 -t upload -t monitor
+ *
+ * On the host, "us" is simulated time (the modelled bus latency, no CPU) and
+ * "cpu_ns" is wall time. On the ESP32 both are measured; I2C counts are only
+ * available from the host bus and read null there.
+ */
+
+#include <Wire.h>
+#include <DS3231Controller.h>
+
+#ifdef DS3231_NATIVE
+#include <DS3231Mock.h>
+#include <chrono>
+#include <new>
+#else
+#include <esp_heap_caps.h>
+#endif
+
+static constexpr uint32_t ITERATIONS = 200;
+static constexpr uint32_t SCHEMA_VERSION = 1;
+
+// 400 kHz: start, address and stop per transaction, 9 bit times per byte
+static constexpr uint32_t BUS_TRANSACTION_US = 25;
+static constexpr uint32_t BUS_BYTE_US = 23;
+
+struct HeapCounters {
+    uint32_t allocs;
+    uint32_t frees;
+    uint64_t bytes;
+};
+
+static HeapCounters heapCounters;
+static volatile bool countingHeap = false;
+
+#ifdef DS3231_NATIVE
+
+// Host: replace the global allocator; String (std::string here) and
+// std::vector both allocate through it
+void* operator new(size_t size) {
+    if (countingHeap) {
+        heapCounters.allocs++;
+        heapCounters.bytes += size;
+    }
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (p) {
+        if (countingHeap) {
+            heapCounters.frees++;
+        }
+        free(p);
+    }
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+static DS3231Mock mockRtc;
+
+#else
+
+// ESP32: bench_esp32 links with --wrap for the C allocator, which sees
+// Arduino String (realloc) as well as operator new (malloc). Only the
+// benchmark task is counted.
+static TaskHandle_t countingTask = nullptr;
+
+static inline bool countThisCall() {
+    return countingHeap && xTaskGetCurrentTaskHandle() == countingTask;
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* p, size_t size);
+void __real_free(void* p);
+
+void* __wrap_malloc(size_t size) {
+    if (countThisCall()) {
+        heapCounters.allocs++;
+        heapCounters.bytes += size;
+    }
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    if (countThisCall()) {
+        heapCounters.allocs++;
+        heapCounters.bytes += count * size;
+    }
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* p, size_t size) {
+    if (countThisCall()) {
+        heapCounters.allocs++;
+        heapCounters.bytes += size;
+    }
+    return __real_realloc(p, size);
+}
+
+void __wrap_free(void* p) {
+    if (p && countThisCall()) {
+        heapCounters.frees++;
+    }
+    __real_free(p);
+}
+}
+
+#endif
+
+DS3231Controller rtc;
+
+static uint8_t serializeBuffer[DS3231Controller::MAX_SCHEDULE_DATA_SIZE];
+static volatile uint32_t sink;  // Keeps results alive
+
+// exportState() target; drops the bytes
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+};
+static NullPrint nullPrint;
+
+static const char* platformName() {
+#ifdef DS3231_NATIVE
+    return "native";
+#else
+    return "esp32";
+#endif
+}
+
+static const char* storageName() {
+#ifdef DS3231_STATIC_STORAGE
+    return "static";
+#else
+    return "heap";
+#endif
+}
+
+// Weekday schedules staggered through the day, so the queries walk the
+// whole list before finding the next edge
+static bool rebuildSchedules(uint8_t count) {
+    rtc.clearAllSchedules();
+    for (uint8_t i = 0; i < count; i++) {
+        DS3231Controller::Schedule sched;
+        sched.id = 0;
+        sched.dayMask = (i & 1) ? 0b01000001 : 0b00111110;
+        sched.startHour = static_cast<uint8_t>((7 + i * 2) % 24);
+        sched.startMinute = 15;
+        sched.endHour = static_cast<uint8_t>((8 + i * 2) % 24);
+        sched.endMinute = 0;
+        sched.enabled = true;
+        char name[DS3231Controller::SCHEDULE_NAME_SIZE];
+        snprintf(name, sizeof(name), "Benchmark schedule %u", i + 1);
+        sched.name = name;
+        if (!rtc.addSchedule(sched)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printNumber(const char* key, double value, bool valid) {
+    if (valid) {
+        Serial.printf(",\"%s\":%.3f", key, value);
+    } else {
+        Serial.printf(",\"%s\":null", key);
+    }
+}
+
+template <typename Call>
+static void run(const char* bench, uint8_t schedules, Call call) {
+    call();  // Warm-up: first bus read, lazily grown buffers
+
+#ifdef DS3231_NATIVE
+    Wire.resetCounters();
+    auto cpuStart = std::chrono::steady_clock::now();
+#else
+    countingTask = xTaskGetCurrentTaskHandle();
+    uint32_t cyclesStart = ESP.getCycleCount();
+#endif
+    heapCounters = {};
+    int64_t start = esp_timer_get_time();
+    countingHeap = true;
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        call();
+    }
+
+    countingHeap = false;
+    int64_t elapsedUs = esp_timer_get_time() - start;
+#ifdef DS3231_NATIVE
+    double cpuNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - cpuStart).count());
+    double cycles = 0;
+    bool haveCycles = false;
+    double transactions = Wire.transactions();
+    double bytes = Wire.bytesTransferred();
+    bool haveBus = true;
+#else
+    double cycles = static_cast<uint32_t>(ESP.getCycleCount() - cyclesStart);
+    double cpuNs = cycles * 1000.0 / ESP.getCpuFreqMHz();
+    bool haveCycles = true;
+    double transactions = 0;
+    double bytes = 0;
+    bool haveBus = false;
+#endif
+
+    const double n = ITERATIONS;
+    Serial.printf("{\"bench\":\"%s\",\"schedules\":%u,\"iterations\":%u", bench, schedules,
+                  static_cast<unsigned>(ITERATIONS));
+    printNumber("us", elapsedUs / n, true);
+    printNumber("cpu_ns", cpuNs / n, true);
+    printNumber("cycles", cycles / n, haveCycles);
+    printNumber("i2c_transactions", transactions / n, haveBus);
+    printNumber("i2c_bytes", bytes / n, haveBus);
+    printNumber("allocs", heapCounters.allocs / n, true);
+    printNumber("alloc_bytes", static_cast<double>(heapCounters.bytes) / n, true);
+    printNumber("frees", heapCounters.frees / n, true);
+#ifdef DS3231_NATIVE
+    printNumber("heap_free", 0, false);
+    printNumber("fragmentation_pct", 0, false);
+#else
+    size_t heapFree = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    printNumber("heap_free", heapFree, true);
+    printNumber("fragmentation_pct", heapFree ? 100.0 - 100.0 * largest / heapFree : 0, true);
+#endif
+    Serial.println("}");
+}
+
+static void runSuite() {
+    Serial.printf("{\"suite\":\"DS3231Controller\",\"schema\":%u,\"platform\":\"%s\",\"storage\":\"%s\","
+                  "\"max_schedules\":%u,\"iterations\":%u}\n",
+                  static_cast<unsigned>(SCHEMA_VERSION), platformName(), storageName(),
+                  static_cast<unsigned>(DS3231Controller::MAX_SCHEDULES), static_cast<unsigned>(ITERATIONS));
+
+    DateTime at = rtc.now();
+    for (uint8_t count = 1; count <= DS3231Controller::MAX_SCHEDULES; count++) {
+        run("rebuildSchedules", count, [count] { sink = sink + rebuildSchedules(count); });
+        run("isWithinAnySchedule", count, [] { sink = sink + rtc.isWithinAnySchedule(); });
+        run("isWithinAnySchedule_at", count, [&at] { sink = sink + rtc.isWithinAnySchedule(at); });
+        run("getSecondsUntilNextEvent", count, [] { sink = sink + rtc.getSecondsUntilNextEvent(); });
+        run("evaluateAt", count, [&at] { sink = sink + rtc.evaluateAt(at).activeId; });
+        run("getScheduleStatus", count, [] {
+            char status[DS3231Controller::SCHEDULE_STATUS_SIZE];
+            sink = sink + rtc.getScheduleStatus(status, sizeof(status));
+        });
+        run("formatDayMask", count, [count] {
+            char days[DS3231Controller::DAY_MASK_TEXT_SIZE];
+            sink = sink + DS3231Controller::formatDayMask(count, days, sizeof(days));
+        });
+        run("serializeSchedules", count, [] {
+            sink = sink + rtc.serializeSchedules(serializeBuffer, sizeof(serializeBuffer));
+        });
+        run("simulate_year", count, [&at] {
+            sink = sink + rtc.simulate(at, at + TimeSpan(365, 0, 0, 0)).onMinutes;
+        });
+        run("exportState_json", count, [] { sink = sink + rtc.exportState(nullPrint); });
+        run("exportState_cbor", count, [] {
+            sink = sink + rtc.exportState(nullPrint, DS3231Controller::StateFormat::Cbor);
+        });
+
+        rtc.enableCachedClock(true);
+        run("isWithinAnySchedule_cached", count, [] { sink = sink + rtc.isWithinAnySchedule(); });
+        run("getSecondsUntilNextEvent_cached", count, [] { sink = sink + rtc.getSecondsUntilNextEvent(); });
+        rtc.enableCachedClock(false);
+    }
+    Serial.println("{\"done\":true}");
+}
+
+void setup() {
+    Serial.begin(115200);
+
+#ifdef DS3231_NATIVE
+    mockRtc.attach(Wire);
+    mockRtc.setTime(DateTime(2026, 3, 2, 6, 0, 0));  // Monday, before the first window
+    Wire.setLatency(BUS_TRANSACTION_US, BUS_BYTE_US);
+#else
+    delay(1000);
+    Wire.begin();
+    Wire.setClock(400000);
+#endif
+
+    if (!rtc.begin(&Wire)) {
+        Serial.println("{\"error\":\"DS3231 not found\"}");
+        return;
+    }
+    runSuite();
+}
+
+void loop() {
+    delay(1000);
+}
+
+#ifdef DS3231_NATIVE
+int main() {
+    setup();
+    return 0;
+}
+#endif
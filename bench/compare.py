@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# compare.py - part of the ESP32-DS3231Controller library
+#
+# Copyright (C) 2025-2026 packerlschupfer
+# SPDX-License-Identifier: GPL-3.0-or-later
+"""Compare two benchmark runs and fail on regressions.
+
+    python3 bench/compare.py baseline.jsonl current.jsonl [--time-tolerance 20]
+
+Reads the JSON lines printed by bench_ds3231controller.cpp (other lines,
+such as boot messages on a serial capture, are skipped). Bus and heap
+counts are deterministic and may not grow at all; "us" and "cpu_ns" may
+grow by up to --time-tolerance percent. Exits 1 on any regression.
+"""
+
+import argparse
+import json
+import sys
+
+COUNT_METRICS = ("i2c_transactions", "i2c_bytes", "allocs", "alloc_bytes")
+TIME_METRICS = ("us", "cpu_ns")
+
+
+def load(path):
+    results = {}
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            try:
+                row = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+            if "bench" in row:
+                results[(row["bench"], row["schedules"])] = row
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--time-tolerance", type=float, default=20.0,
+                        help="allowed time growth in percent (default 20)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+
+    for key in sorted(baseline):
+        if key not in current:
+            print(f"MISSING  {key[0]} x{key[1]}")
+            regressions += 1
+            continue
+        old, new = baseline[key], current[key]
+        for metric in COUNT_METRICS + TIME_METRICS:
+            a, b = old.get(metric), new.get(metric)
+            if a is None or b is None:
+                continue
+            limit = a * (1 + args.time_tolerance / 100) if metric in TIME_METRICS else a
+            if b > limit + 1e-9:
+                print(f"REGRESSED {key[0]} x{key[1]} {metric}: {a:.3f} -> {b:.3f}")
+                regressions += 1
+
+    print(f"{len(baseline)} results compared, {regressions} regression(s)")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,74 @@
+/**
+ * DS3231Controller Deep Sleep Example
+ * 
+ * Battery-powered schedule controller that deep sleeps between schedule
+ * edges. Alarm 1 is armed for the next start or end, the DS3231 pulls
+ * INT/SQW low when it fires, and that wakes the ESP32 (ext0). On wake,
+ * begin() restores the schedules from RTC memory instead of re-reading
+ * them, and the scheduler reports the edge that caused the wake.
+ * 
+ * Connections:
+ * - DS3231 SDA -> ESP32 GPIO 21
+ * - DS3231 SCL -> ESP32 GPIO 22
+ * - DS3231 SQW -> ESP32 GPIO 4 (must be an RTC GPIO)
+ * - DS3231 VCC -> 3.3V
+ * - DS3231 GND -> GND
+ * - Relay IN   -> ESP32 GPIO 25
+ */
+
+#include <Wire.h>
+#include <DS3231Controller.h>
+
+#define RTC_INT_PIN 4
+#define RELAY_PIN 25
+
+DS3231Controller rtc;
+
+void setup() {
+    Serial.begin(115200);
+    pinMode(RELAY_PIN, OUTPUT);
+
+    Wire.begin();
+
+    // Register callbacks before begin(): the scheduler starts inside begin()
+    // and reports the waking edge on its first pass
+    rtc.onScheduleEvent([](const DS3231Controller::Schedule& schedule, bool isStart) {
+        Serial.printf("%s %s\n", schedule.name.c_str(), isStart ? "started" : "ended");
+        digitalWrite(RELAY_PIN, rtc.isWithinAnySchedule() ? HIGH : LOW);
+    });
+
+    if (!rtc.begin(&Wire, RTC_INT_PIN)) {
+        Serial.println("Failed to initialize DS3231!");
+        while (1) delay(1000);
+    }
+
+    if (!rtc.isResumeFromDeepSleep()) {
+        // Cold boot: configure schedules once; they survive deep sleep
+        DS3231Controller::Schedule morning;
+        morning.name = "Morning";
+        morning.startHour = 6;
+        morning.startMinute = 0;
+        morning.endHour = 8;
+        morning.endMinute = 0;
+        morning.dayMask = 0b01111111;  // Every day
+        morning.enabled = true;
+
+        if (!rtc.addSchedule(morning)) {
+            Serial.println("Failed to add schedule");
+        }
+    }
+
+    // Give the scheduler task a moment to dispatch the waking edge
+    delay(50);
+
+    Serial.println("Going to deep sleep until the next schedule edge");
+    Serial.flush();
+
+    if (!rtc.enterDeepSleep()) {
+        Serial.println("Deep sleep not possible - check the INT/SQW wiring");
+    }
+}
+
+void loop() {
+    delay(1000);
+}
@@ -76,7 +76,8 @@ void setup() {
                      schedule.name.c_str(), 
                      isStart ? "STARTED" : "ENDED");
         
-        if (isStart) {
+        // Overlapping schedules keep the heater on when one of them ends
+        if (rtc.isWithinAnySchedule()) {
             activateHeater();
         } else {
             deactivateHeater();
@@ -87,6 +88,12 @@ void setup() {
         Serial.printf("Alarm %d fired!\n", alarmNumber);
     });
     
+    // The scheduler task sleeps until the next schedule edge and fires the
+    // callback above, so loop() no longer needs to poll the schedules
+    if (!rtc.startScheduler()) {
+        Serial.println("ERROR: Failed to start scheduler!");
+    }
+    
     // Print initial diagnostics
     rtc.printDiagnostics();
     
@@ -101,9 +108,6 @@ void setup() {
 }
 
 void loop() {
-    // Check if we're within any active schedule
-    bool shouldBeOn = rtc.isWithinAnySchedule();
-    
     // Check for pump exercise
     if (rtc.isPumpExerciseTime()) {
         Serial.println("PUMP EXERCISE: Starting monthly pump exercise");
@@ -113,24 +117,6 @@ void loop() {
         rtc.markPumpExerciseComplete();
     }
     
-    // Update heater state if needed
-    if (shouldBeOn != heaterState) {
-        if (shouldBeOn) {
-            activateHeater();
-        } else {
-            deactivateHeater();
-        }
-    }
-    
-    // Check for alarms
-    if (rtc.isAlarmFired(1)) {
-        rtc.acknowledgeAlarm(1);
-        // Without a next alarm the timer stops firing entirely, so report it.
-        if (!rtc.setAlarmForNextSchedule()) {
-            Serial.println("Failed to arm next schedule alarm");
-        }
-    }
-    
     // Periodic status update
     if (millis() - lastStatusPrint > STATUS_INTERVAL) {
         printStatus();
@@ -224,12 +210,18 @@ void deactivateHeater() {
 }
 
 void printStatus() {
+    // Caller buffers: no heap use however often this runs
+    char date[DS3231Controller::FORMATTED_DATE_SIZE];
+    char time[DS3231Controller::FORMATTED_TIME_SIZE];
+    char status[DS3231Controller::SCHEDULE_STATUS_SIZE];
+    rtc.getFormattedDate(date, sizeof(date));
+    rtc.getFormattedTime(time, sizeof(time));
+    rtc.getScheduleStatus(status, sizeof(status));
+
     Serial.println("\n--- Current Status ---");
-    Serial.printf("Time: %s %s\n", 
-                 rtc.getFormattedDate().c_str(), 
-                 rtc.getFormattedTime().c_str());
+    Serial.printf("Time: %s %s\n", date, time);
     Serial.printf("Heater: %s\n", heaterState ? "ON" : "OFF");
-    Serial.printf("Status: %s\n", rtc.getScheduleStatus().c_str());
+    Serial.printf("Status: %s\n", status);
     
     if (rtc.isVacationMode()) {
         auto vacation = rtc.getVacationMode();
@@ -286,15 +278,16 @@ void handleSerialCommands() {
         
         case '1'...'7': {
             uint8_t scheduleId = cmd - '0';
-            auto* schedule = rtc.getSchedule(scheduleId);
-            if (schedule) {
-                schedule->enabled = !schedule->enabled;
-                if (!rtc.updateSchedule(scheduleId, *schedule)) {
+            const auto* current = rtc.getSchedule(scheduleId);
+            if (current) {
+                auto schedule = *current;
+                schedule.enabled = !schedule.enabled;
+                if (!rtc.updateSchedule(scheduleId, schedule)) {
                     Serial.printf("Failed to update schedule %d\n", scheduleId);
                 }
                 Serial.printf("Schedule %d '%s' is now %s\n",
-                            scheduleId, schedule->name.c_str(),
-                            schedule->enabled ? "ENABLED" : "DISABLED");
+                            scheduleId, schedule.name.c_str(),
+                            schedule.enabled ? "ENABLED" : "DISABLED");
             } else {
                 Serial.printf("Schedule %d not found\n", scheduleId);
             }
@@ -26,36 +26,30 @@
 #include <RTClib.h>
 #include <vector>
 #include <functional>
+#include <atomic>
 #include <RecursiveMutexGuard.h>
 #include "DS3231ControllerLogging.h"
+#include "DS3231FixedStorage.h"
+#include "DS3231SeqLatch.h"
+#include "DS3231ScheduleStore.h"
+#include "DS3231TemperatureHistory.h"
+#include "DS3231TimeZone.h"
+#include "DS3231Stats.h"
+#include "DS3231StateCodec.h"
+#include "DS3231TimeSource.h"
+#include <esp_timer.h>
 
-class DS3231Controller {
-public:
-    // Schedule structure for hot water timing
-    struct Schedule {
-        uint8_t id;              // Unique schedule ID
-        uint8_t dayMask;         // Bit mask for days (bit 0 = Sunday, bit 6 = Saturday)
-        uint8_t startHour;       // 0-23
-        uint8_t startMinute;     // 0-59
-        uint8_t endHour;         // 0-23  
-        uint8_t endMinute;       // 0-59
-        bool enabled;            // Schedule active flag
-        String name;             // e.g., "Morning Shower", "Evening Bath"
-        
-        // Helper methods
-        bool isDayEnabled(uint8_t dayOfWeek) const {
-            return (dayMask & (1 << dayOfWeek)) != 0;
-        }
-        
-        void setDay(uint8_t dayOfWeek, bool enable) {
-            if (enable) {
-                dayMask |= (1 << dayOfWeek);
-            } else {
-                dayMask &= ~(1 << dayOfWeek);
-            }
-        }
-    };
+// Build with -DDS3231_STATIC_STORAGE to keep schedules in an inline array with
+// fixed-size names, so the controller never touches the heap after construction
+
+// Temperature samples kept by every controller (one per 64 s conversion)
+#ifndef DS3231_TEMPERATURE_HISTORY_SIZE
+#define DS3231_TEMPERATURE_HISTORY_SIZE 64
+#endif
 
+// Capacity-independent types and helpers shared by every DS3231ControllerT
+class DS3231ControllerBase {
+public:
     // Pump exercise feature to prevent seizing
     struct PumpExercise {
         bool enabled;
@@ -74,6 +68,23 @@ public:
         bool runPumpExercise;    // Still run pump exercise during vacation
     };
 
+    // How a schedule picks the days its window starts on
+    enum class Recurrence : uint8_t {
+        Weekly = 0,  // The days in dayMask
+        Monthly,     // Day of month 'interval' (1-31); past the end of a month, its last day
+        EveryNDays,  // Every 'interval' days, counted from firstDay
+        Once,        // firstDay only
+    };
+    static constexpr uint16_t NO_END_DAY = 0xFFFF;  // Open-ended Schedule::lastDay
+
+    // Calendar days since 2000-01-01, the unit of Schedule::firstDay/lastDay
+    static uint16_t dayNumber(const DateTime& dt);
+    static DateTime dateOfDay(uint16_t day);  // Midnight of that day
+
+    // "weekly", "monthly", "everyNDays", "once", as in the state document
+    static const char* recurrenceName(Recurrence recurrence);
+    static bool parseRecurrence(const char* name, Recurrence& out);
+
     // Temperature data from DS3231
     struct TemperatureData {
         float celsius;
@@ -81,47 +92,506 @@ public:
         DateTime timestamp;
     };
 
+    // The DS3231 refreshes its temperature registers once per conversion
+    static constexpr uint32_t TEMPERATURE_CONVERSION_PERIOD_MS = 64000;
+    static constexpr uint32_t TEMPERATURE_CONVERSION_TIMEOUT_MS = 300;  // Forced conversion, BSY included
+    using TemperatureSample = DS3231TemperatureSample;
+    using TemperatureHistory = DS3231TemperatureHistory<DS3231_TEMPERATURE_HISTORY_SIZE>;
+
+    // Hot-path counters (-DDS3231_STATS)
+    using Stats = DS3231Stats;
+    using StatOp = DS3231StatOp;
+    using StatError = DS3231StatError;
+
+    // State document (exportState()/importState())
+    using StateFormat = DS3231StateFormat;
+    using StateImportError = DS3231StateImportError;
+    using StateImportResult = DS3231StateImportResult;
+    static constexpr uint8_t STATE_DOCUMENT_VERSION = 1;
+
+    static constexpr uint8_t DS3231_REGISTER_COUNT = 0x13;  // 0x00 seconds .. 0x12 temperature LSB
+
+    // Whole DS3231 register file captured in one burst read
+    struct RegisterSnapshot {
+        DateTime time;           // 0x00-0x06
+        float temperatureC;      // 0x11-0x12, 0.25 °C resolution
+        uint8_t control;         // 0x0E
+        uint8_t status;          // 0x0F
+        int8_t agingOffset;      // 0x10
+        uint8_t raw[DS3231_REGISTER_COUNT];
+        int64_t capturedUs;      // esp_timer_get_time() at capture
+        bool valid;
+
+        bool oscillatorStopped() const { return (status & 0x80) != 0; }  // OSF: power was lost
+        bool alarmFired(uint8_t alarmNumber) const {
+            return (alarmNumber == 1 || alarmNumber == 2) && (status & alarmNumber) != 0;
+        }
+    };
+
+    // Decode a raw register file; false if the time registers are out of range
+    static bool parseRegisters(const uint8_t* regs, RegisterSnapshot& out);
+
+    // What begin() does about a clock that lost power (OSF set)
+    enum class PowerLossAction : uint8_t {
+        SetCompileTime,  // Set the firmware build time (default)
+        KeepTime,        // Leave the clock and OSF alone until setTime(), e.g. from NTP
+    };
+
+    // Set with setBootPolicy() before begin()
+    struct BootPolicy {
+        PowerLossAction onPowerLoss = PowerLossAction::SetCompileTime;
+        bool deferValidation = false;   // Probe only: no status or time read, power loss not checked
+        bool keepAlarmsOnWake = false;  // After an ext0/ext1 wake, leave A1F/A2F for the alarm callback
+    };
+
+    // What the last begin() did, and how long it took
+    struct BootReport {
+        uint32_t durationUs;      // begin() entry to return, store restore included
+        bool lostPower;           // OSF was set (unknown, so false, when deferred)
+        bool clockSet;            // Set to the build time, or switched to the other RTC
+        bool alarmsCleared;       // Fired alarm flags were cleared
+        bool alarmsKept;          // Fired alarm flags were left for the wake handler
+        bool validationDeferred;
+        bool resumedFromSleep;    // Deep-sleep fast resume: no register access at all
+    };
+
+    // Asynchronous bus requests (see startBusWorker())
+    struct AsyncHandle {
+        uint32_t ticket = 0;     // 0 = request was not queued
+        uint8_t slot = 0;
+        bool isValid() const { return ticket != 0; }
+    };
+    enum class AsyncStatus : uint8_t {
+        Invalid,     // Handle was never queued
+        Pending,     // Queued or running
+        Succeeded,
+        Failed,
+        Expired      // Completed, but its slot was reused before the result was read
+    };
+    using AsyncResultCallback = std::function<void(bool ok)>;
+    using AsyncTimeCallback = std::function<void(bool ok, const DateTime& time)>;
+    using AsyncSnapshotCallback = std::function<void(bool ok, const RegisterSnapshot& snapshot)>;
+    using BusJob = std::function<bool(TwoWire& wire)>;  // Runs on the worker with the bus locked
+
+    static constexpr uint8_t MAX_BUS_QUEUE_DEPTH = 16;
+
+    // RTC drift against an external reference (see enableDriftTracking()),
+    // accumulated per temperature bin. Error is RTC minus reference.
+    static constexpr uint8_t DRIFT_TEMP_BINS = 10;       // 5 °C wide from 0 °C, outer bins open-ended
+    static constexpr int8_t DRIFT_TEMP_BIN_MIN_C = 0;
+    static constexpr uint8_t DRIFT_TEMP_BIN_WIDTH_C = 5;
+    static constexpr float AGING_PPM_PER_LSB = 0.1f;     // Aging offset sensitivity near 25 °C
+    struct DriftBin {
+        int32_t errorSeconds;
+        uint32_t elapsedSeconds;
+        uint16_t samples;
+    };
+    struct DriftEstimate {
+        float ppm;                // Positive = RTC runs fast
+        uint32_t elapsedSeconds;  // Reference time the estimate covers
+        uint16_t samples;
+        bool referenceBand;       // Only 15-35 °C bins, where the aging trim is calibrated
+        bool valid;
+    };
+
     // Callbacks
     using TimeChangeCallback = std::function<void(const DateTime&)>;
     using AlarmCallback = std::function<void(uint8_t alarmNumber)>;
+
+    // Queued controller events (see startEventDispatcher()); plain data, so
+    // they are copied through a FreeRTOS queue without allocating
+    enum class EventType : uint8_t {
+        ScheduleStart,
+        ScheduleEnd,
+        AlarmFired,
+        TimeChanged,    // setTime() or setTimeFromUTC() stepped the clock
+        DstTransition,  // The time zone's UTC offset changed
+    };
+    struct Event {
+        EventType type;
+        uint8_t scheduleId;   // ScheduleStart/ScheduleEnd
+        uint8_t alarmNumber;  // AlarmFired
+        int32_t utcOffset;    // DstTransition: new offset, seconds east of UTC
+        uint32_t time;        // Wall-clock epoch of the edge, alarm, new time or transition (0 = unknown)
+    };
+    using EventCallback = std::function<void(const Event&)>;
+
+    static constexpr uint8_t MAX_EVENT_QUEUE_DEPTH = 64;
+
+    // What-if simulation (simulate()): transitions as the scheduler would
+    // see them, in time order, to the minute
+    enum class SimulationEventType : uint8_t {
+        ScheduleStart,  // Also for schedules already running at 'from'
+        ScheduleEnd,    // Also when a vacation suspends the schedule
+        HeatingOn,      // The merged run of schedules starts
+        HeatingOff,
+        VacationStart,
+        VacationEnd,
+        PumpExercise,   // The monthly run starts
+    };
+    struct SimulationEvent {
+        SimulationEventType type;
+        uint8_t scheduleId;  // ScheduleStart/ScheduleEnd
+        uint32_t time;       // Schedule-clock epoch
+    };
+    using SimulationSink = std::function<void(const SimulationEvent&)>;
+
+    struct SimulationResult {
+        uint32_t events;          // Passed to the sink
+        uint32_t scheduleStarts;
+        uint32_t heatingPeriods;  // HeatingOn events
+        uint32_t onMinutes;       // Heating on: schedules merged, vacation excluded
+        uint32_t pumpRuns;
+
+        float onHours() const { return onMinutes / 60.0f; }
+    };
+
+    // Clock health (getHealth()), as of the last time read or register transfer
+    enum class ClockHealth : uint8_t {
+        Healthy,   // Last read accepted, score at or above HEALTH_DEGRADED_SCORE
+        Degraded,  // Last read accepted, but recent ones failed or were implausible
+        Holdover,  // Last read failed; time extrapolated from esp_timer
+        Failed,    // Last read failed and there is no time to fall back on
+    };
+    struct HealthReport {
+        ClockHealth state;
+        uint8_t score;                 // 0-100, decaying average of recent outcomes
+        uint16_t consecutiveFailures;  // Time reads since the last accepted one
+        uint32_t failedReads;          // NACKed or invalid time reads
+        uint32_t implausibleReads;     // Valid reads that went backwards or jumped against esp_timer
+        uint32_t busErrors;            // Failed register transfers
+        uint32_t holdoverReads;        // Reads answered from esp_timer, bus skipped or failed
+        int64_t lastGoodUs;            // esp_timer_get_time() of the last accepted read, 0 = none
+        int64_t retryAtUs;             // Holdover: no time read goes to the bus before this
+    };
+
+    static constexpr uint8_t HEALTH_DEGRADED_SCORE = 75;
+    static constexpr uint32_t DEFAULT_MAX_HOLDOVER_SECONDS = 24 * 3600UL;
+
+    static constexpr uint32_t DEFAULT_REANCHOR_INTERVAL_SECONDS = 300;
+    static constexpr uint32_t DEFAULT_STORE_DEBOUNCE_MS = 2000;
+
+    // Drift over bins; prefers the 15-35 °C band once it has a day of data
+    static DriftEstimate estimateDrift(const DriftBin* bins);
+    static uint8_t driftBinFor(float temperatureC);
+
+    // Static utility methods
+    static const char* dayOfWeekStr(uint8_t dow);
+    static uint8_t dayOfWeekFromStr(const char* str);
+    static String formatDayMask(uint8_t dayMask);
+
+    // Allocation-free formatting. The buffer overloads behave like snprintf:
+    // they write at most size bytes, always terminated when size > 0, and
+    // return the full length, so a result >= size means it was truncated.
+    static constexpr size_t DAY_MASK_TEXT_SIZE = 21;   // "Su,Mo,Tu,We,Th,Fr,Sa"
+    static constexpr size_t FORMATTED_TIME_SIZE = 9;   // "HH:MM:SS"
+    static constexpr size_t FORMATTED_DATE_SIZE = 11;  // "YYYY-MM-DD"
+    static constexpr size_t TIMESTAMP_SIZE = 20;       // "YYYY-MM-DDTHH:MM:SS"
+    static const char* dayMaskText(uint8_t dayMask);   // From a 128-entry table; bit 7 ignored
+    static size_t formatDayMask(uint8_t dayMask, char* buffer, size_t size);
+    static size_t formatTimestamp(const DateTime& dt, char* buffer, size_t size);
+
+    // CRC-16/CCITT-FALSE, as used by the persisted schedule format
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+protected:
+    static constexpr uint16_t MINUTES_PER_DAY = 24 * 60;
+    static constexpr uint16_t MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+
+    static const DateTime kInvalidTime;  // Fails isValid(), unlike DateTime()
+
+    static uint16_t minuteOfWeek(const DateTime& at);
+    static uint32_t minuteSince2000(const DateTime& at);
+
+    // Compiled form of a schedule's recurrence and date bounds
+    struct DayRule {
+        Recurrence recurrence;
+        uint8_t dayMask;
+        uint8_t interval;
+        uint16_t firstDay;
+        uint16_t lastDay;
+
+        bool isValid() const;
+        bool matches(uint16_t day) const;  // A window may start on this day
+        uint16_t period() const;           // Longest gap between matching days
+        bool isWeekly() const;             // Same every week: plain day mask, no date bounds
+    };
+
+    // Persisted schedule format. v2 layout (multi-byte fields little-endian):
+    //   header    magic D3 23 | version 2 | flags | record count
+    //   removed   count | ids...                          (FLAG_DELTA only)
+    //   record    id | dayMask:7 enabled:1 | start:11 end:11 rule:1 (3 bytes)
+    //             | name length | name bytes
+    //             | recurrence | interval | first day u16 | last day u16  (rule bit only)
+    //   vacation  enabled:1 runPump:1 | start epoch u32 | end epoch u32  (FLAG_VACATION)
+    //   pump      enabled | day | hour | minute | duration u16 | last run u32 (FLAG_PUMP)
+    //   crc16     over everything before it
+    // Epochs are Unix seconds, 0 = unset. A full blob carries every schedule and
+    // both sections; a delta only what changed and is applied on top of one.
+    // A blob with any rule record is written as v3 so older decoders reject it.
+    static constexpr uint8_t SCHEDULE_FORMAT_MAGIC_0 = 0xD3;
+    static constexpr uint8_t SCHEDULE_FORMAT_MAGIC_1 = 0x23;
+    static constexpr uint8_t SCHEDULE_FORMAT_V1 = 1;
+    static constexpr uint8_t SCHEDULE_FORMAT_V2 = 2;
+    static constexpr uint8_t SCHEDULE_FORMAT_V3 = 3;
+    static constexpr uint32_t SCHEDULE_RECORD_RULE_BIT = 1UL << 22;  // In the packed times
+    static constexpr uint8_t SCHEDULE_FLAG_DELTA = 0x01;
+    static constexpr uint8_t SCHEDULE_FLAG_VACATION = 0x02;
+    static constexpr uint8_t SCHEDULE_FLAG_PUMP = 0x04;
+    static constexpr size_t SCHEDULE_V2_HEADER_SIZE = 5;
+    static constexpr size_t SCHEDULE_V2_RECORD_FIXED_SIZE = 6;  // Everything but the name bytes
+    static constexpr size_t SCHEDULE_V3_RULE_SIZE = 6;
+    static constexpr size_t SCHEDULE_V2_VACATION_SIZE = 9;
+    static constexpr size_t SCHEDULE_V2_PUMP_SIZE = 10;
+    static constexpr size_t SCHEDULE_V2_CRC_SIZE = 2;
+
+    // What changed since the last full serialize/deserialize, for delta blobs
+    struct ChangeSet {
+        uint32_t persistedIds[8];  // Ids in the last persisted state
+        uint32_t dirtyIds[8];      // Ids added or edited since
+        uint8_t dirtySections;     // SCHEDULE_FLAG_VACATION | SCHEDULE_FLAG_PUMP
+
+        static bool contains(const uint32_t* set, uint8_t id) { return (set[id >> 5] >> (id & 31)) & 1; }
+        static void insert(uint32_t* set, uint8_t id) { set[id >> 5] |= 1u << (id & 31); }
+    };
+
+    static void putU16(uint8_t* p, uint16_t value) { p[0] = value; p[1] = value >> 8; }
+    static void putU32(uint8_t* p, uint32_t value) { putU16(p, value); putU16(p + 2, value >> 16); }
+    static uint16_t getU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+    static uint32_t getU32(const uint8_t* p) { return getU16(p) | (static_cast<uint32_t>(getU16(p + 2)) << 16); }
+};
+
+// Controller with compile-time capacity: MaxSchedules schedules with names of
+// up to NameSize - 1 characters. Schedule storage, the serialized layout, the
+// edge table and the deep sleep cache are all sized from these. Use the
+// DS3231Controller alias for the defaults.
+template <uint8_t MaxSchedules = 10, size_t NameSize = 32>
+class DS3231ControllerT : public DS3231ControllerBase, public DS3231TimeSource {
+    // Ids and the serialized count are one byte; id 255 means "none"
+    static_assert(MaxSchedules >= 1 && MaxSchedules <= 254, "MaxSchedules must be 1-254");
+    static_assert(NameSize >= 2, "NameSize must leave room for at least one character");
+
+public:
+    static constexpr uint8_t MAX_SCHEDULES = MaxSchedules;
+    static constexpr size_t SCHEDULE_NAME_SIZE = NameSize;  // Including terminator
+    static constexpr size_t SCHEDULE_RECORD_SIZE =  // Serialized bytes per schedule, at most
+        SCHEDULE_V2_RECORD_FIXED_SIZE + SCHEDULE_NAME_SIZE - 1 + SCHEDULE_V3_RULE_SIZE;
+
+#ifdef DS3231_STATIC_STORAGE
+    using ScheduleName = DS3231FixedString<SCHEDULE_NAME_SIZE>;
+#else
+    using ScheduleName = String;
+#endif
+
+    // Schedule structure for hot water timing
+    struct Schedule {
+        uint8_t id;              // Unique schedule ID
+        uint8_t dayMask;         // Bit mask for days (bit 0 = Sunday, bit 6 = Saturday)
+        uint8_t startHour;       // 0-23
+        uint8_t startMinute;     // 0-59
+        uint8_t endHour;         // 0-23  
+        uint8_t endMinute;       // 0-59
+        bool enabled;            // Schedule active flag
+        ScheduleName name;       // e.g., "Morning Shower", "Evening Bath"
+
+        // Recurrence beyond the weekly dayMask, and the days it applies between.
+        // The defaults keep a plain weekly schedule.
+        Recurrence recurrence = Recurrence::Weekly;
+        uint8_t interval = 0;           // Monthly: day of month; EveryNDays: N
+        uint16_t firstDay = 0;          // dayNumber(); EveryNDays counts from it, Once runs on it
+        uint16_t lastDay = NO_END_DAY;  // Inclusive
+
+        bool hasRule() const {
+            return recurrence != Recurrence::Weekly || firstDay != 0 || lastDay != NO_END_DAY;
+        }
+
+        void setDateRange(const DateTime& first, const DateTime& last) {
+            firstDay = dayNumber(first);
+            lastDay = dayNumber(last);
+        }
+        void setDateRange(const DateTime& first) {  // Open-ended
+            firstDay = dayNumber(first);
+            lastDay = NO_END_DAY;
+        }
+
+        // Helper methods
+        bool isDayEnabled(uint8_t dayOfWeek) const {
+            return (dayMask & (1 << dayOfWeek)) != 0;
+        }
+        
+        void setDay(uint8_t dayOfWeek, bool enable) {
+            if (enable) {
+                dayMask |= (1 << dayOfWeek);
+            } else {
+                dayMask &= ~(1 << dayOfWeek);
+            }
+        }
+    };
+
+    // Result of evaluating all schedules against one time snapshot
+    struct ScheduleEvaluation {
+        DateTime at;             // Snapshot the evaluation was made for
+        bool vacationActive;     // Vacation period covers 'at' (schedules suppressed)
+        const Schedule* active;  // First schedule active at 'at', ignoring vacation (nullptr if none)
+        uint8_t activeId;        // Id of that schedule (0 if none)
+        DateTime nextStart;      // Next schedule start after 'at' (invalid if none)
+        DateTime nextEnd;        // End of the merged run of overlapping or touching active
+                                 // schedules (invalid if none, or no gap within a week)
+        DateTime nextScheduleEnd;  // Earliest end of a single active schedule (invalid if none)
+        bool pumpExerciseDue;    // Pump exercise minute, not yet run this month, not held off by vacation
+
+        // True when heating should be on: a schedule is active and vacation is not
+        bool isOn() const { return activeId != 0 && !vacationActive; }
+    };
+
+#ifdef DS3231_STATIC_STORAGE
+    using ScheduleList = DS3231FixedVector<Schedule, MAX_SCHEDULES>;
+#else
+    using ScheduleList = std::vector<Schedule>;
+#endif
+
+    // Callbacks
     using ScheduleCallback = std::function<void(const Schedule&, bool isStart)>;
 
     // Constructor/Destructor
-    DS3231Controller();
-    ~DS3231Controller();
+    DS3231ControllerT();
+    ~DS3231ControllerT();
 
     // Initialization
-    [[nodiscard]] bool begin(TwoWire* wire = &Wire);
+    // interruptPin: GPIO wired to DS3231 INT/SQW for interrupt-driven alarms (-1 = poll)
+    [[nodiscard]] bool begin(TwoWire* wire = &Wire, int8_t interruptPin = -1);
     [[nodiscard]] bool isRunning() const;
 
+    // A full begin() costs a probe, one burst read of the time and status, and
+    // at most one status write to clear fired alarms
+    void setBootPolicy(const BootPolicy& policy) { _bootPolicy = policy; }
+    [[nodiscard]] const BootPolicy& getBootPolicy() const noexcept { return _bootPolicy; }
+    [[nodiscard]] const BootReport& getBootReport() const noexcept { return _bootReport; }
+
+    // Follower: an independent schedule set on another controller's clock
+    // (or any DS3231TimeSource), with no RTC of its own. Schedule queries,
+    // the scheduler task, vacation and persistence work as usual; alarms,
+    // setTime(), temperature, snapshots, aging and edge capture fail. Set the
+    // same time zone as the source if it has one. The source must outlive
+    // the follower.
+    [[nodiscard]] bool begin(DS3231TimeSource& source);
+    [[nodiscard]] bool isFollower() const noexcept { return _timeSource != nullptr; }
+
+    // DS3231TimeSource: one locked clock read (cached clock when enabled)
+    DateTime readSourceTime() const override;
+
+    // Redundant RTC on a second bus. A read that fails or returns an invalid
+    // time switches to the standby chip, which then stays active until
+    // usePrimaryRtc(). Attached before begin(), begin() also starts on the
+    // secondary when the primary is missing or lost power, and sets a chip
+    // that lost power from the other. setTime() writes both. Alarm and
+    // edge-capture GPIOs stay wired to the primary; after a failover alarms
+    // are armed on the secondary and the scheduler task relies on its timed
+    // wakeups. The secondary must sit on its own bus (same address).
+    [[nodiscard]] bool attachSecondaryRtc(TwoWire* wire);
+    [[nodiscard]] bool usePrimaryRtc();  // True once the primary is active and reads a valid time
+    [[nodiscard]] bool isOnSecondaryRtc() const noexcept { return _onSecondary; }
+    [[nodiscard]] uint32_t getRtcFailoverCount() const noexcept { return _failovers; }
+
     // Time management
     [[nodiscard]] bool setTime(const DateTime& dt);
     [[nodiscard]] DateTime now() const;
-    [[nodiscard]] bool adjustDrift(int32_t secondsPerMonth);
+    [[nodiscard]] bool adjustDrift(int32_t secondsPerMonth);  // Trims the aging offset; positive = RTC gains
+
+    // Aging offset register (0x10). Changing it restarts drift tracking.
+    [[nodiscard]] bool getAgingOffset(int8_t& offset) const;
+    [[nodiscard]] bool setAgingOffset(int8_t offset);
+
+    // Drift tracking: each setTimeFromUTC() compares the RTC against the
+    // reference and accumulates the error per temperature bin. While enabled,
+    // a reference that agrees with the RTC to the second does not step it, so
+    // frequent syncs still measure long intervals. With autoTrim the aging
+    // offset is corrected once a week of drift has been measured.
+    void enableDriftTracking(bool enable, bool autoTrim = true);
+    [[nodiscard]] bool isDriftTrackingEnabled() const noexcept { return _drift.enabled; }
+    [[nodiscard]] DriftEstimate getDriftEstimate() const;
+    [[nodiscard]] const DriftBin* getDriftBins() const noexcept { return _drift.bins; }  // DRIFT_TEMP_BINS entries
+    void resetDriftTracking();
+
+    // Cached clock: serve now() and schedule queries from esp_timer, re-reading
+    // the DS3231 only every reanchorIntervalSeconds (or sooner if drift demands)
+    void enableCachedClock(bool enable, uint32_t reanchorIntervalSeconds = DEFAULT_REANCHOR_INTERVAL_SECONDS);
+    [[nodiscard]] bool isCachedClockEnabled() const noexcept { return _cachedClockEnabled; }
+    [[nodiscard]] bool reanchorClock();
+    [[nodiscard]] float getClockDriftPpm() const;  // esp_timer vs RTC, positive = RTC faster
+
+    // Holdover: when a time read fails or is implausible, answer from esp_timer
+    // since the last accepted read for up to maxHoldoverSeconds, and back off
+    // the bus (1 s doubling to 64 s) until a retry succeeds. Health is tracked
+    // either way from the traffic the controller makes anyway; getHealth() is
+    // lock-free and costs no bus access.
+    void enableHoldover(bool enable, uint32_t maxHoldoverSeconds = DEFAULT_MAX_HOLDOVER_SECONDS);
+    [[nodiscard]] bool isHoldoverEnabled() const noexcept { return _holdoverEnabled; }
+    [[nodiscard]] HealthReport getHealth() const { return _health.load(); }
+    [[nodiscard]] bool isInHoldover() const { return getHealth().state == ClockHealth::Holdover; }
 
     // Timezone-aware time management
     [[nodiscard]] bool setTimeFromUTC(uint32_t utcEpoch, int32_t offsetSeconds = 0);
     [[nodiscard]] uint32_t nowUTC(int32_t offsetSeconds = 0) const;
 
-    // System time synchronization (RTC -> ESP32 system clock)
+    // Time zone rules as a POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3"
+    // (nullptr clears). While set, the RTC keeps UTC and the offset arguments
+    // above are ignored; now(), setTime() and the alarms use local wall time.
+    // Schedules run each local minute once across DST changes: a skipped one
+    // maps to the transition, a repeated one to its first occurrence. Set the
+    // time again after switching an RTC that kept local time.
+    [[nodiscard]] bool setTimeZone(const char* posixTz);
+    [[nodiscard]] bool hasTimeZone() const noexcept { return _timeZoneEnabled; }
+    [[nodiscard]] DS3231TimeZone getTimeZone() const { return _timeZone.load(); }
+    [[nodiscard]] int32_t getUtcOffset() const;  // Seconds east of UTC now, 0 without a zone
+
+    // System time synchronization (RTC -> ESP32 system clock). With edge
+    // capture enabled the system clock is aligned to the second boundary.
     [[nodiscard]] bool syncSystemTime() const;
 
+    // 1 Hz edge capture: the DS3231 drives a 1 Hz square wave on INT/SQW and
+    // an ISR timestamps each falling edge (the seconds rollover) with
+    // esp_timer. syncSystemTime() and the cached clock anchor on those edges
+    // instead of whole-second reads. INT/SQW is a single pin, so alarm
+    // interrupts on it fall back to polling until capture is disabled.
+    [[nodiscard]] bool enableSecondEdgeCapture(int8_t pin);
+    void disableSecondEdgeCapture();
+    [[nodiscard]] bool isSecondEdgeCaptureEnabled() const noexcept { return _edgePin >= 0; }
+
     // Schedule management
     [[nodiscard]] bool addSchedule(const Schedule& schedule);
     [[nodiscard]] bool updateSchedule(uint8_t scheduleId, const Schedule& schedule);
     [[nodiscard]] bool removeSchedule(uint8_t scheduleId);
-    [[nodiscard]] Schedule* getSchedule(uint8_t scheduleId);
-    [[nodiscard]] const std::vector<Schedule>& getAllSchedules() const noexcept { return _schedules; }
+    // Read-only: queries run on compiled state, so edits go through updateSchedule()
+    [[nodiscard]] const Schedule* getSchedule(uint8_t scheduleId) const;
+    [[nodiscard]] const ScheduleList& getAllSchedules() const noexcept { return _schedules; }
     void clearAllSchedules();
 
-    // Schedule queries
+    // Schedule queries (at most one RTC read; lock-free with the cached clock)
     [[nodiscard]] bool isWithinAnySchedule() const;
     [[nodiscard]] bool isWithinSchedule(uint8_t scheduleId) const;
     [[nodiscard]] Schedule* getCurrentActiveSchedule();
     [[nodiscard]] const Schedule* getCurrentActiveSchedule() const;
     [[nodiscard]] DateTime getNextScheduledStart() const;
-    [[nodiscard]] DateTime getNextScheduledEnd() const;
-    [[nodiscard]] uint32_t getSecondsUntilNextEvent() const;
+    [[nodiscard]] DateTime getNextScheduledEnd() const;        // When heating stops: overlaps merged
+    [[nodiscard]] uint32_t getSecondsUntilNextEvent() const;   // Any single schedule's start or end
+
+    // Snapshot queries: evaluate against a caller-provided time, no RTC access.
+    // All but evaluateAt() (which resolves 'active' under the mutex) are lock-free.
+    [[nodiscard]] ScheduleEvaluation evaluateAt(const DateTime& at) const;
+    [[nodiscard]] bool isWithinAnySchedule(const DateTime& at) const;
+    [[nodiscard]] bool isWithinSchedule(uint8_t scheduleId, const DateTime& at) const;
+
+    // Replays [from, to) on the compiled table without touching the RTC;
+    // lock-free, and the sink may call back into the controller
+    SimulationResult simulate(const DateTime& from, const DateTime& to, const SimulationSink& sink = nullptr) const;
+
+    // Event-driven scheduler: a background task that sleeps until the next
+    // schedule edge and fires onScheduleEvent() exactly once per start/end
+    [[nodiscard]] bool startScheduler(UBaseType_t priority = 2, BaseType_t core = tskNO_AFFINITY,
+                                      uint32_t stackSize = 4096);
+    void stopScheduler();  // Waits for the running callback and the task to exit; not from a callback
+    [[nodiscard]] bool isSchedulerRunning() const noexcept { return _schedulerTask != nullptr; }
 
     // Vacation mode
     void setVacationMode(bool enabled, const DateTime& start = DateTime(), const DateTime& end = DateTime());
@@ -135,9 +605,45 @@ public:
     [[nodiscard]] PumpExercise getPumpExercise() const noexcept { return _pumpExercise; }
     void markPumpExerciseComplete();
 
-    // Temperature monitoring
+    // Burst read of time, alarms, control/status, aging and temperature in a
+    // single I2C transaction. Re-anchors the cached clock when it is enabled.
+    [[nodiscard]] bool readSnapshot(RegisterSnapshot& out);
+    [[nodiscard]] RegisterSnapshot getLastSnapshot() const;
+    // Serve temperature, power-loss and diagnostics getters from a snapshot up
+    // to maxAgeMs old instead of reading the bus (0 = always read, default)
+    void setSnapshotMaxAge(uint32_t maxAgeMs) { _snapshotMaxAgeUs = static_cast<int64_t>(maxAgeMs) * 1000; }
+
+    // Async bus mode: a worker task runs queued transactions so callers never
+    // wait on I2C. The *Async() calls return the cached value at once and
+    // report the refreshed one through the callback (run on the worker) or
+    // the handle. submitBusJob() lets other devices on the same bus queue
+    // their transactions behind the RTC's; getBusMutex() is the lock the
+    // controller holds for every transaction, for drivers that stay blocking.
+    [[nodiscard]] bool startBusWorker(uint8_t queueDepth = 8, UBaseType_t priority = 3,
+                                      BaseType_t core = tskNO_AFFINITY, uint32_t stackSize = 4096);
+    void stopBusWorker();  // Runs what is queued and waits for the task to exit; not from a callback
+    [[nodiscard]] bool isBusWorkerRunning() const noexcept { return _busTask != nullptr; }
+    DateTime nowAsync(AsyncTimeCallback onDone = nullptr, AsyncHandle* handle = nullptr);
+    RegisterSnapshot readSnapshotAsync(AsyncSnapshotCallback onDone = nullptr, AsyncHandle* handle = nullptr);
+    [[nodiscard]] AsyncHandle setAlarm1Async(const DateTime& dt, bool matchSeconds = false,
+                                             AsyncResultCallback onDone = nullptr);
+    [[nodiscard]] AsyncHandle submitBusJob(BusJob job, AsyncResultCallback onDone = nullptr);
+    [[nodiscard]] AsyncStatus getAsyncStatus(const AsyncHandle& handle) const;
+    [[nodiscard]] AsyncStatus waitAsync(const AsyncHandle& handle, uint32_t timeoutMs) const;
+    [[nodiscard]] SemaphoreHandle_t getBusMutex() const noexcept { return _mutex; }
+
+    // Temperature monitoring. A reading is cached for one conversion period
+    // and every new conversion seen on the bus is appended to the history, so
+    // polling faster than the DS3231 converts costs no I2C traffic.
     [[nodiscard]] TemperatureData getTemperature();
     [[nodiscard]] float getTemperatureCelsius();
+    // Start a conversion now (unless one is running) and wait for the result
+    [[nodiscard]] bool forceTemperatureConversion(uint32_t timeoutMs = TEMPERATURE_CONVERSION_TIMEOUT_MS);
+    // Retained samples, read in place. Hold getBusMutex() while iterating: a
+    // new conversion overwrites the oldest entry. Sample epochs are RTC time,
+    // so UTC once setTimeZone() is set; getTemperature() reports local time.
+    [[nodiscard]] const TemperatureHistory& getTemperatureHistory() const noexcept { return _temperatureHistory; }
+    void clearTemperatureHistory();
     [[nodiscard]] bool isTemperatureCompensationEnabled() const;
 
     // Alarm management (DS3231 has 2 alarms)
@@ -147,61 +653,449 @@ public:
     void clearAlarm(uint8_t alarmNumber);
     [[nodiscard]] bool isAlarmFired(uint8_t alarmNumber);
     void acknowledgeAlarm(uint8_t alarmNumber);
+    [[nodiscard]] bool enableLightSleepWakeup();  // Wake from light sleep on INT/SQW low
+    [[nodiscard]] int8_t getInterruptPin() const noexcept { return _interruptPin; }
+
+    // Deep sleep: cache schedules and state in RTC memory, arm Alarm 1 for the
+    // next edge and wake on INT/SQW (ext0). The next begin() then fast-resumes.
+    // Register callbacks before begin() so the waking edge is not missed.
+    [[nodiscard]] bool prepareDeepSleep();
+    [[nodiscard]] bool enterDeepSleep();  // prepareDeepSleep() + esp_deep_sleep_start()
+    [[nodiscard]] bool isResumeFromDeepSleep() const noexcept { return _resumedFromSleep; }
 
     // Power management
     void enableBatteryBackup(bool enable);
     [[nodiscard]] bool isBatteryBackupEnabled() const;
     [[nodiscard]] float getBatteryVoltage() const;
 
-    // Callbacks
+    // Callbacks. Without an event queue they run in the task that caused the
+    // event (setTime()'s caller, the scheduler task), after the controller
+    // lock is released.
     void onTimeChange(TimeChangeCallback callback) { _timeChangeCallback = callback; }
     void onAlarm(AlarmCallback callback) { _alarmCallback = callback; }
     void onScheduleEvent(ScheduleCallback callback) { _scheduleCallback = callback; }
+    void onEvent(EventCallback callback) { _eventCallback = callback; }  // Every event, typed
+
+    // Event queue: events are queued instead of running callbacks in the
+    // task that caused them, and the dispatcher task runs the callbacks, so
+    // a slow handler (MQTT, HTTP) never delays the control path. A full
+    // queue drops the event and counts it. enableEventQueue() queues without
+    // a task; drain it with dispatchEvents() from a loop. Queued schedule
+    // events name the schedule by id: onScheduleEvent() gets its current
+    // data, and is skipped if it was removed before dispatch.
+    [[nodiscard]] bool startEventDispatcher(uint8_t queueDepth = 16, UBaseType_t priority = 1,
+                                            BaseType_t core = tskNO_AFFINITY, uint32_t stackSize = 4096);
+    [[nodiscard]] bool enableEventQueue(uint8_t queueDepth = 16);
+    void stopEventDispatcher();  // Dispatches what is queued, then removes the queue
+    uint8_t dispatchEvents(uint32_t timeoutMs = 0);  // Runs queued events here; returns how many
+    [[nodiscard]] bool isEventQueueEnabled() const noexcept { return _eventQueue != nullptr; }
+    [[nodiscard]] bool isEventDispatcherRunning() const noexcept { return _eventTask != nullptr; }
+    [[nodiscard]] uint32_t getDroppedEventCount() const noexcept { return _droppedEvents; }
 
     // Utility methods
     [[nodiscard]] String getFormattedTime() const;
     [[nodiscard]] String getFormattedDate() const;
     [[nodiscard]] String getScheduleStatus() const;
+    static constexpr size_t SCHEDULE_STATUS_SIZE =  // "Active: " + name, or the longest fixed status
+        8 + SCHEDULE_NAME_SIZE > 21 ? 8 + SCHEDULE_NAME_SIZE : 21;
+    size_t getFormattedTime(char* buffer, size_t size) const;  // snprintf-style, no heap use
+    size_t getFormattedDate(char* buffer, size_t size) const;
+    size_t getScheduleStatus(char* buffer, size_t size) const;
     void printDiagnostics();
 
-    // Persistence (save/load schedules)
+#ifdef DS3231_STATS
+    // Per-operation call counts, mutex wait histograms and I2C results.
+    // Readable from any task without the lock; see DS3231Stats.
+    [[nodiscard]] const Stats& getStats() const noexcept { return _stats.stats(); }
+    void resetStats() { _stats.reset(); }
+#endif
+
+    // Persistence (save/load schedules). Serializing writes format v2;
+    // deserializing accepts v1 and v2 full blobs and v2 deltas.
     [[nodiscard]] size_t getScheduleDataSize() const;
+    static constexpr size_t MAX_SCHEDULE_DATA_SIZE =  // Worst case, for static buffers
+        SCHEDULE_V2_HEADER_SIZE + MAX_SCHEDULES * SCHEDULE_RECORD_SIZE +
+        SCHEDULE_V2_VACATION_SIZE + SCHEDULE_V2_PUMP_SIZE + SCHEDULE_V2_CRC_SIZE;
     [[nodiscard]] bool serializeSchedules(uint8_t* buffer, size_t bufferSize);
     [[nodiscard]] bool deserializeSchedules(const uint8_t* buffer, size_t dataSize);
-    
-    // Static utility methods
-    static const char* dayOfWeekStr(uint8_t dow);
-    static uint8_t dayOfWeekFromStr(const char* str);
-    static String formatDayMask(uint8_t dayMask);
+
+    // Delta persistence: only schedules added, edited or removed (and the
+    // vacation/pump settings if changed) since the last serialize or load.
+    // Both serialize calls reset the change set.
+    static constexpr size_t MAX_SCHEDULE_DELTA_SIZE = MAX_SCHEDULE_DATA_SIZE + 1 + MAX_SCHEDULES;
+    [[nodiscard]] bool hasScheduleChanges() const;
+    [[nodiscard]] size_t getScheduleChangesSize() const;
+    [[nodiscard]] bool serializeScheduleChanges(uint8_t* buffer, size_t bufferSize, size_t& written);
+
+    // State document: schedules, vacation, pump exercise and temperature as
+    // JSON or CBOR, written in constant memory. The mutex is taken once per
+    // schedule rather than for the whole write, so a slow client never stalls
+    // the scheduler; edits made meanwhile may or may not appear.
+    size_t exportState(Print& out, StateFormat format = StateFormat::Json);
+
+    // Applies a state document as it streams in. Each schedule goes through
+    // updateSchedule() if its id exists, else addSchedule(); fields a record
+    // leaves out keep their current value. With replaceSchedules, schedules
+    // the document does not list are removed once it has been read in full.
+    class StateImporter : private DS3231StateReader::Handler {
+    public:
+        StateImporter(DS3231ControllerT& controller, StateFormat format, bool replaceSchedules = false);
+
+        bool feed(const uint8_t* data, size_t length);  // False once the import has stopped
+        bool feed(const char* text) { return feed(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+        bool done() const { return _reader.done(); }
+        [[nodiscard]] StateImportResult finish();
+
+    private:
+        enum class Field : uint8_t {
+            None, Id, Name, Enabled, Days, Start, End, Repeat, Interval, From, Until,
+            RunPump, DayOfMonth, Hour, Minute, Duration, LastRun
+        };
+        enum class Section : uint8_t { None, Schedules, Vacation, Pump };
+
+        void beginContainer(bool isMap) override;
+        void endContainer() override;
+        void key(const char* name) override;
+        void value(const DS3231StateReader::Value& value) override;
+        void applySchedule();
+        void applyVacation();
+        void applyPump();
+
+        DS3231ControllerT& _controller;
+        DS3231StateReader _reader;
+        bool _replace;
+        StateImportResult _result = {};
+        uint32_t _seenIds[8] = {};
+        uint8_t _depth = 0;
+        uint8_t _recordDepth = 0;  // Depth of the open record map, 0 = none
+        bool _inScheduleList = false;
+        Section _section = Section::None;
+        Field _field = Field::None;
+        uint32_t _present = 0;     // Bit per Field set in the open record
+        bool _invalid = false;     // A field in the open record was out of range
+
+        Schedule _schedule;
+        VacationMode _vacation;
+        PumpExercise _pump;
+    };
+
+    [[nodiscard]] StateImportResult importState(Stream& in, StateFormat format = StateFormat::Json,
+                                                bool replaceSchedules = false);
+
+    // Persistence backend. Once attached, schedule, vacation and pump exercise
+    // changes mark the controller dirty and a debounce timer commits the full
+    // blob from the esp_timer task, so callers never wait on a flash write.
+    // Edits keep pushing the commit back, up to STORE_MAX_DEFER_WINDOWS
+    // debounce windows. With restoreOnBegin, a store attached before begin() is
+    // restored once the bus is up (not after a deep sleep fast resume).
+    // The store must outlive the attachment.
+    [[nodiscard]] bool attachStore(DS3231ScheduleStore& store, uint32_t debounceMs = DEFAULT_STORE_DEBOUNCE_MS,
+                                   bool restoreOnBegin = false);
+    void detachStore();  // Flushes pending changes first
+    [[nodiscard]] bool restoreFromStore();  // One read from the store
+    [[nodiscard]] bool flushStore();        // Commit now if dirty
+    [[nodiscard]] bool hasUnsavedChanges() const;
 
 private:
+    // Constants
+    static constexpr uint16_t MAX_EDGES = MAX_SCHEDULES * 7;  // One start per weekday
+    static constexpr uint16_t MAX_COVERAGE = MAX_EDGES + MAX_SCHEDULES;  // Saturday windows split at the week end
+    static constexpr uint32_t NO_START_MINUTE = 0xFFFFFFFF;
+    static constexpr uint8_t SCHEDULE_CHECK_INTERVAL_SECONDS = 30;  // Alarm flag poll interval
+    static constexpr uint32_t SCHEDULER_MAX_SLEEP_SECONDS = 3600;
+    static constexpr uint32_t SCHEDULER_EDGE_MARGIN_MS = 50;
+    // Alarm 1 matches day-of-month, not month: two matches are at least 28 days apart
+    static constexpr uint32_t ALARM1_HORIZON_SECONDS = 27UL * 86400UL;
+    static constexpr uint32_t NOTIFY_RESCHEDULE = 1 << 0;
+    static constexpr uint32_t NOTIFY_STOP = 1 << 1;
+    static constexpr uint32_t NOTIFY_ALARM = 1 << 2;
+    static constexpr float CACHED_CLOCK_MAX_ERROR_MS = 500.0f;
+    static constexpr uint32_t DRIFT_MIN_BASELINE_SECONDS = 6 * 3600UL;
+    static constexpr float MAX_PLAUSIBLE_DRIFT_PPM = 200.0f;
+    static constexpr uint32_t HEALTH_SLACK_SECONDS = 2;      // Read jitter, plus 100 ppm of elapsed time
+    static constexpr uint8_t HEALTH_CONFIRM_READS = 3;       // Agreeing implausible reads that move the clock
+    static constexpr uint32_t HOLDOVER_BACKOFF_MS = 1000;     // First retry delay, doubled per failure
+    static constexpr uint8_t HOLDOVER_BACKOFF_MAX_SHIFT = 6;  // 64 s
+    static constexpr uint8_t ALARM_1 = 1;
+    static constexpr uint8_t ALARM_2 = 2;
+    static constexpr uint8_t DS3231_I2C_ADDRESS = 0x68;
+    static constexpr uint8_t DS3231_REG_CONTROL = 0x0E;
+    static constexpr uint8_t DS3231_REG_STATUS = 0x0F;
+    static constexpr uint8_t DS3231_REG_AGING = 0x10;
+    static constexpr uint8_t DS3231_CONTROL_CONV = 0x20;
+    static constexpr uint8_t DS3231_STATUS_BSY = 0x04;
+    static constexpr uint32_t TEMPERATURE_POLL_MS = 10;
+    static constexpr uint32_t DRIFT_MIN_SAMPLE_SECONDS = 6 * 3600UL;    // Shorter intervals are quantization noise
+    static constexpr uint32_t DRIFT_TRIM_MIN_SECONDS = 7 * 24 * 3600UL;
+    static constexpr uint32_t SECOND_EDGE_WAIT_MS = 1100;
+    static constexpr uint8_t DS3231_STATUS_A1F = 0x01;
+    static constexpr uint8_t DS3231_STATUS_A2F = 0x02;
+    static constexpr uint8_t DS3231_STATUS_OSF = 0x80;
+
     mutable RTC_DS3231 _rtc;
-    std::vector<Schedule> _schedules;
+    TwoWire* _wire = nullptr;
+
+    // Failover (attachSecondaryRtc()) and follower mode; written under _mutex
+    mutable RTC_DS3231 _secondaryRtc;
+    TwoWire* _secondaryWire = nullptr;
+    bool _secondaryReady = false;       // _secondaryRtc.begin() succeeded
+    mutable bool _onSecondary = false;
+    mutable uint32_t _failovers = 0;
+    DS3231TimeSource* _timeSource = nullptr;
+    int8_t _interruptPin = -1;
+    ScheduleList _schedules;
     VacationMode _vacationMode;
     PumpExercise _pumpExercise;
+    ChangeSet _changes = {};
+
+    // Persistence backend (attachStore()). _storeMutex orders commits and is
+    // never taken by mutators, so they don't wait for a flash write.
+    static constexpr uint8_t STORE_MAX_DEFER_WINDOWS = 5;
+    DS3231ScheduleStore* _store = nullptr;
+    SemaphoreHandle_t _storeMutex = nullptr;
+    esp_timer_handle_t _storeTimer = nullptr;
+    uint32_t _storeDebounceMs = DEFAULT_STORE_DEBOUNCE_MS;
+    int64_t _storeDirtySinceUs = 0;
+    bool _storeDirty = false;
+    bool _storeRestoreOnBegin = false;
+    bool _storeHasCrc = false;
+    uint16_t _storeCrc = 0;        // CRC of the blob last loaded or committed
+
+    // Compiled schedule state: the weekly transition table (window starts
+    // sorted by minute of week, binary-searched by queries), per-schedule
+    // windows with their day rules, the vacation range and the pump exercise
+    // window. Republished through _compiled on every mutation so queries on
+    // any core read it without the mutex.
+    struct ScheduleEdge {
+        uint16_t minuteOfWeek;   // 0 = Sunday 00:00 ... 10079 = Saturday 23:59
+        uint8_t window;          // Index into windows
+    };
+    struct CompiledWindow {
+        uint8_t id;
+        DayRule rule;
+        uint16_t startOfDay;     // Minutes since midnight
+        uint16_t duration;       // Minutes; 0 = disabled or empty
+    };
+    struct CoverageInterval {
+        uint16_t start;          // Minute of week
+        uint16_t end;            // Exclusive, at most MINUTES_PER_WEEK
+    };
+    struct CompiledState {
+        CompiledWindow windows[MAX_SCHEDULES];
+        ScheduleEdge edges[MAX_EDGES];
+        CoverageInterval coverage[MAX_COVERAGE];  // Union of the weekly windows: sorted, disjoint, not touching
+        uint16_t edgeCount;
+        uint16_t coverageCount;
+        uint8_t windowCount;
+        bool hasRuleWindows;     // Some windows are not weekly and are checked one by one
+        uint8_t lookaheadWeeks;  // Weeks of edges that hold a start for every rule
+        bool vacationEnabled;
+        bool vacationRunsPump;
+        uint32_t vacationStart;  // Epoch, inclusive
+        uint32_t vacationEnd;    // Epoch, inclusive
+        CompiledWindow pump;     // Monthly, one minute long
+        uint16_t pumpLastRunMonth;  // year * 12 + month of the last run, 0 = never
+    };
+    DS3231SeqLatch<CompiledState> _compiled;
+
     DateTime _lastCheck;
-    uint8_t _activeScheduleId;
+    uint8_t _activeIds[MAX_SCHEDULES];  // Schedules active at _lastCheck
+    uint8_t _activeCount;
+    TaskHandle_t volatile _schedulerTask = nullptr;
+    volatile bool _schedulerStopping = false;
+    SemaphoreHandle_t _schedulerExited = nullptr;  // Given by the task just before it deletes itself
     bool _initialized = false;  // Prevent double initialization
+    bool _resumedFromSleep = false;
+    BootPolicy _bootPolicy;
+    BootReport _bootReport = {};
     mutable SemaphoreHandle_t _mutex;  // Thread safety for I2C operations
+
+    // Cached clock state: written under _mutex, read lock-free through _clock
+    struct ClockAnchor {
+        uint32_t epoch;          // RTC time at anchor
+        int64_t micros;          // esp_timer_get_time() at anchor
+        bool valid;
+    };
+    struct ClockState {
+        ClockAnchor anchor;
+        ClockAnchor driftBaseline;  // First anchor since enable/setTime
+        float driftPpm;
+        int64_t reanchorIntervalUs;
+    };
+    mutable DS3231SeqLatch<ClockState> _clock;
+    bool _cachedClockEnabled = false;
+
+    // Clock health: the tracker is written under _mutex by every time read
+    // and register transfer, and published through _health
+    struct HealthTracker {
+        uint32_t referenceEpoch;  // Last accepted RTC time
+        int64_t referenceUs;      // esp_timer_get_time() when it was read
+        bool referenceValid;
+        uint32_t candidateEpoch;  // Last rejected time, which later reads may confirm
+        int64_t candidateUs;
+        uint8_t candidateReads;
+    };
+    mutable HealthTracker _healthTracker = {};
+    mutable DS3231SeqLatch<HealthReport> _health;
+    bool _holdoverEnabled = false;
+    uint32_t _maxHoldoverSeconds = DEFAULT_MAX_HOLDOVER_SECONDS;
+
+    // Time zone; the RTC keeps UTC while enabled. Lookups run lock-free on the
+    // latch; its transition cache is refreshed under _mutex.
+    mutable DS3231SeqLatch<DS3231TimeZone> _timeZone;
+    bool _timeZoneEnabled = false;
+
+    // 1 Hz edge capture. The ISR publishes the last edge time through a
+    // sequence count (odd while writing); edges before _edgeValidFromUs
+    // predate the last time write (or RTC failover) and are ignored.
+    volatile int8_t _edgePin = -1;
+    std::atomic<uint32_t> _edgeSeq{0};
+    volatile int64_t _edgeUs = 0;
+    mutable int64_t _edgeValidFromUs = 0;
+
+    // Drift tracking (enableDriftTracking()); written under _mutex, and
+    // restarted by a failover from const reads
+    struct DriftTracker {
+        DriftBin bins[DRIFT_TEMP_BINS];
+        uint32_t referenceEpoch;   // Reference time of the last RTC step, 0 = none yet
+        float referenceTempC;
+        bool enabled;
+        bool autoTrim;
+    };
+    mutable DriftTracker _drift = {};
+
+    mutable DS3231SeqLatch<RegisterSnapshot> _snapshot;  // Last burst read; written under _mutex
+    int64_t _snapshotMaxAgeUs = 0;
+
+    // Temperature cache and history; written under _mutex by any burst read
+    struct TemperatureCache {
+        TemperatureSample sample;
+        int64_t capturedUs;
+        bool valid;
+    };
+    mutable TemperatureCache _temperature = {};
+    mutable TemperatureHistory _temperatureHistory;
+
+    // Call, mutex wait and bus counters; empty unless built with DS3231_STATS
+    using StatsGuard = DS3231StatsGuard;
+    mutable DS3231StatsRecorder _stats;
+
+    // Async bus worker: request slots are handed out through _busFreeQueue and
+    // queued by index on _busPendingQueue, so slots never move while in use
+    struct BusRequest {
+        std::function<bool()> work;
+        std::atomic<uint32_t> ticket{0};
+        std::atomic<uint32_t> result{0};  // (ticket << 1) | ok, written on completion
+    };
+    static constexpr uint8_t BUS_STOP_REQUEST = 0xFF;
+    BusRequest _busRequests[MAX_BUS_QUEUE_DEPTH];
+    QueueHandle_t _busFreeQueue = nullptr;
+    QueueHandle_t _busPendingQueue = nullptr;
+    TaskHandle_t volatile _busTask = nullptr;
+    SemaphoreHandle_t _busGate = nullptr;    // Orders queueBusRequest() against start/stop
+    SemaphoreHandle_t _busExited = nullptr;  // Given by the task just before it deletes itself
+    std::atomic<uint32_t> _busNextTicket{1};
     
     // Callbacks
     TimeChangeCallback _timeChangeCallback;
     AlarmCallback _alarmCallback;
     ScheduleCallback _scheduleCallback;
+    EventCallback _eventCallback;
+
+    // Event queue (startEventDispatcher()); the dispatcher stops on EVENT_STOP
+    static constexpr EventType EVENT_STOP = static_cast<EventType>(0xFF);
+    QueueHandle_t volatile _eventQueue = nullptr;
+    TaskHandle_t volatile _eventTask = nullptr;
+    SemaphoreHandle_t _eventExited = nullptr;  // Given by the task just before it deletes itself
+    std::atomic<uint32_t> _droppedEvents{0};
+    int32_t _lastUtcOffset = 0;  // Scheduler task: offset at its last pass
+    bool _utcOffsetKnown = false;
     
     // Internal methods
-    bool isTimeInRange(const DateTime& current, uint8_t startHour, uint8_t startMinute,
-                      uint8_t endHour, uint8_t endMinute) const;
+    DateTime readTime() const;     // Caller holds _mutex; local wall time
+    DateTime readRtcTime() const;  // Caller holds _mutex; RTC time base (UTC with a zone)
+    DateTime rtcNow() const;       // now() in the RTC time base
+    DateTime scheduleNow() const;  // now() on the schedule clock
+    DateTime toWallClock(const DateTime& rtcTime) const;
+    DateTime toScheduleClock(const DateTime& rtcTime) const;
+    DateTime toRtcTime(const DateTime& localTime) const;
+    bool writeRtcTime(const DateTime& rtcTime);  // Caller holds _mutex
+    bool extrapolateTime(DateTime& out) const;
+    bool anchorClock() const;  // Caller holds _mutex
+    bool anchorClockAt(const DateTime& rtcTime, int64_t nowUs) const;
+    bool readSnapshotLocked(RegisterSnapshot& out) const;  // Caller holds _mutex
+    bool currentSnapshot(RegisterSnapshot& out) const;     // Cached if fresh enough
+    void noteTemperature(const RegisterSnapshot& snapshot) const;  // Caller holds _mutex
+    bool readTemperatureLocked(TemperatureSample& out);
+    bool isScheduleActiveAt(const Schedule& schedule, const DateTime& at) const;
+    static CompiledWindow compileWindow(const Schedule& schedule);
+    static bool isWindowActiveAt(const CompiledWindow& window, uint32_t minute, uint32_t* endMinute = nullptr);
+    static bool isVacationActiveAt(const CompiledState& state, const DateTime& at);
+    static uint16_t findNextEdge(const CompiledState& state, uint16_t minuteOfWeek);
+    static uint32_t findNextStart(const CompiledState& state, uint32_t minute);  // NO_START_MINUTE if none
+    static bool isCoveredAt(const CompiledState& state, uint32_t minute, uint32_t* endMinute = nullptr);
+    static uint32_t findMergedEnd(const CompiledState& state, uint32_t minute);  // NO_START_MINUTE if none
+    static void evaluateCompiled(const CompiledState& state, const DateTime& at, ScheduleEvaluation& eval);
+    static void simulateCompiled(const CompiledState& state, uint32_t fromMinute, uint32_t toMinute,
+                                 const SimulationSink& sink, SimulationResult& result);
+    ScheduleEvaluation evaluateLockFree(const DateTime& at) const;
+    void publishCompiledState();  // Caller holds _mutex
     uint8_t getNextFreeScheduleId() const;
-    void checkScheduleTransitions();
+    uint32_t checkScheduleTransitions();  // Fires edge callbacks, returns seconds to next edge
     void checkAlarms();
-    DateTime calculateNextOccurrence(const Schedule& schedule, const DateTime& from) const;
-    
-    // Constants
-    static constexpr uint8_t MAX_SCHEDULES = 10;
-    static constexpr uint8_t SCHEDULE_CHECK_INTERVAL_SECONDS = 30;
-    static constexpr uint8_t ALARM_1 = 1;
-    static constexpr uint8_t ALARM_2 = 2;
+    void notifyScheduler();
+    static void schedulerTaskEntry(void* arg);
+    void schedulerLoop();
+    bool attachAlarmInterrupt(int8_t pin);
+    static void alarmIsr(void* arg);
+    void handleAlarmInterrupt();
+    void emitEvent(const Event& event, const Schedule* schedule = nullptr);  // Not under _mutex: queues, or dispatches here
+    void emitEvent(EventType type, uint32_t time, uint8_t scheduleId = 0, uint8_t alarmNumber = 0,
+                   int32_t utcOffset = 0);
+    void dispatchEvent(const Event& event, const Schedule* schedule = nullptr);
+    static void eventTaskEntry(void* arg);
+    void eventLoop();
+    struct SleepCache;
+    static SleepCache s_sleepCache;
+    void saveSleepCache();
+    bool restoreSleepCache();
+    size_t encodeSchedules(uint8_t* buffer, bool delta) const;  // Caller holds _mutex; nullptr sizes only
+    bool decodeSchedulesV1(const uint8_t* buffer, size_t dataSize);
+    bool decodeSchedulesV2(const uint8_t* buffer, size_t dataSize);
+    void markSchedulesPersisted();  // Caller holds _mutex
+    void markStoreDirty();          // Caller holds _mutex
+    bool initialize(TwoWire* wire, int8_t interruptPin);  // begin() minus the store restore
+    static void storeTimerEntry(void* arg);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t length) const;
+    RTC_DS3231& activeRtc() const { return _onSecondary ? _secondaryRtc : _rtc; }
+    TwoWire* activeWire() const { return _onSecondary ? _secondaryWire : _wire; }
+    RTC_DS3231* standbyRtc() const;  // The other chip, if a secondary is attached
+    void applyIntSqwMode() const;    // Caller holds _mutex; INTCN/1 Hz on the active chip
+    // Caller holds _mutex: the time source, the active RTC with one failover, or holdover
+    DateTime readRtcClock(bool* fromHoldover = nullptr) const;
+    bool noteTimeRead(const DateTime& rtcTime, int64_t nowUs) const;  // Caller holds _mutex; false if rejected
+    void noteBusResult(bool ok) const;                                // Caller holds _mutex
+    void setHealthReference(uint32_t epoch, int64_t nowUs) const;     // Caller holds _mutex
+    DateTime holdoverTime(int64_t nowUs) const;                       // Invalid if there is none
+    bool failOver(const char* reason) const;  // Caller holds _mutex; false if there is nothing to switch to
+    DateTime cachedTime() const;  // Last anchor extrapolated, however old
+    AsyncHandle queueBusRequest(std::function<bool()> work);
+    void runBusRequest(uint8_t slot);
+    void releaseBusQueues();  // Caller holds _busGate; the task must have exited
+    static void busTaskEntry(void* arg);
+    void busWorkerLoop();
+    bool writeRegister(uint8_t reg, uint8_t value) const;
+    static void edgeIsr(void* arg);
+    bool lastSecondEdge(int64_t& edgeUs) const;
+    int64_t secondStartUs(int64_t readStartUs, int64_t readEndUs) const;  // Edge time if it began the read second
+    bool recordDriftSample(uint32_t referenceEpoch);  // Caller holds _mutex; true if no step is needed
+    bool writeAgingOffset(int8_t offset, const RegisterSnapshot& snapshot);  // Caller holds _mutex
 };
 
+using DS3231Controller = DS3231ControllerT<>;
+
+#include "DS3231ControllerImpl.h"
+
+extern template class DS3231ControllerT<>;
+
 #endif // DS3231_CONTROLLER_H
\ No newline at end of file
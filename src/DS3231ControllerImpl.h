@@ -0,0 +1,4896 @@
+/*
+ * DS3231ControllerImpl.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// Member definitions for DS3231ControllerT. Included by DS3231Controller.h;
+// the default DS3231Controller instantiation is compiled once in
+// DS3231Controller.cpp, other capacities are instantiated where used.
+
+#ifndef DS3231_CONTROLLER_IMPL_H
+#define DS3231_CONTROLLER_IMPL_H
+
+#include <algorithm>
+#include <math.h>
+#include <sys/time.h>
+#include <esp_timer.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <driver/rtc_io.h>
+#include <soc/soc_caps.h>
+// State carried across deep sleep in RTC slow memory. Cleared by power-on
+// reset, preserved through deep sleep; validated by magic + checksum.
+template <uint8_t MaxSchedules, size_t NameSize>
+struct DS3231ControllerT<MaxSchedules, NameSize>::SleepCache {
+    static constexpr uint32_t MAGIC = 0xD3231C5Fu;
+
+    struct Record {
+        uint8_t id;
+        uint8_t dayMask;
+        uint8_t startHour;
+        uint8_t startMinute;
+        uint8_t endHour;
+        uint8_t endMinute;
+        uint8_t enabled;
+        uint8_t recurrence;
+        uint8_t interval;
+        uint16_t firstDay;
+        uint16_t lastDay;
+        char name[SCHEDULE_NAME_SIZE];
+    };
+
+    uint32_t magic;
+    uint16_t checksum;           // Over everything after this field
+    uint8_t scheduleCount;
+    uint8_t activeCount;
+    Record schedules[MAX_SCHEDULES];
+    uint8_t activeIds[MAX_SCHEDULES];
+    uint32_t sleepEpoch;         // RTC time when we went to sleep
+    uint8_t vacationEnabled;
+    uint8_t vacationRunPump;
+    uint32_t vacationStart;
+    uint32_t vacationEnd;
+    uint8_t pumpEnabled;
+    uint8_t pumpDayOfMonth;
+    uint8_t pumpHour;
+    uint8_t pumpMinute;
+    uint16_t pumpDuration;
+    uint32_t pumpLastRun;        // 0 = never
+    ChangeSet changes;           // Unsaved persistence changes
+    uint8_t timeZoneEnabled;
+    uint8_t timeZone[sizeof(DS3231TimeZone)];  // Raw bytes: RTC memory must not run constructors
+
+    uint16_t computeChecksum() const {
+        // Fletcher-16 over the payload
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(this) + offsetof(SleepCache, scheduleCount);
+        size_t len = sizeof(SleepCache) - offsetof(SleepCache, scheduleCount);
+        uint16_t a = 0, b = 0;
+        while (len--) {
+            a = (a + *p++) % 255;
+            b = (b + a) % 255;
+        }
+        return static_cast<uint16_t>((b << 8) | a);
+    }
+
+    bool isValid() const { return magic == MAGIC && checksum == computeChecksum(); }
+};
+
+template <uint8_t MaxSchedules, size_t NameSize>
+RTC_DATA_ATTR typename DS3231ControllerT<MaxSchedules, NameSize>::SleepCache DS3231ControllerT<MaxSchedules, NameSize>::s_sleepCache;
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DS3231ControllerT<MaxSchedules, NameSize>::DS3231ControllerT()
+    : _activeCount(0), _mutex(nullptr),
+      _clock(ClockState{{0, 0, false}, {0, 0, false}, 0.0f,
+                        DEFAULT_REANCHOR_INTERVAL_SECONDS * 1000000LL}),
+      _health(HealthReport{ClockHealth::Healthy, 100, 0, 0, 0, 0, 0, -1, 0}) {
+    _mutex = xSemaphoreCreateRecursiveMutex();
+    _storeMutex = xSemaphoreCreateRecursiveMutex();
+    _busGate = xSemaphoreCreateRecursiveMutex();
+    _vacationMode.enabled = false;
+    _vacationMode.runPumpExercise = false;
+    _pumpExercise.enabled = false;
+    _pumpExercise.dayOfMonth = 1;
+    _pumpExercise.hour = 3;
+    _pumpExercise.minute = 0;
+    _pumpExercise.durationSeconds = 300;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DS3231ControllerT<MaxSchedules, NameSize>::~DS3231ControllerT() {
+    if (_interruptPin >= 0) {
+        detachInterrupt(digitalPinToInterrupt(_interruptPin));
+    }
+    stopScheduler();
+    stopBusWorker();
+    stopEventDispatcher();
+    detachStore();
+    if (_storeTimer) {
+        esp_timer_delete(_storeTimer);
+        _storeTimer = nullptr;
+    }
+    if (_storeMutex) {
+        vSemaphoreDelete(_storeMutex);
+        _storeMutex = nullptr;
+    }
+    if (_busGate) {
+        vSemaphoreDelete(_busGate);
+        _busGate = nullptr;
+    }
+    if (_mutex) {
+        vSemaphoreDelete(_mutex);
+        _mutex = nullptr;
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::begin(TwoWire* wire, int8_t interruptPin) {
+    bool firstBegin = !_initialized;
+    int64_t startUs = esp_timer_get_time();
+    if (!initialize(wire, interruptPin)) {
+        return false;
+    }
+
+    // Outside _mutex, which store commits take after the store lock
+    if (firstBegin && !_resumedFromSleep && _storeRestoreOnBegin && restoreFromStore()) {
+        StatsGuard lock(_mutex, _stats, StatOp::Begin);
+        if (lock.hasLock()) {
+            (void)setAlarmForNextSchedule();
+        }
+    }
+
+    if (firstBegin) {
+        _bootReport.durationUs = static_cast<uint32_t>(esp_timer_get_time() - startUs);
+        DS3231_LOG_I("Boot took %lu us", static_cast<unsigned long>(_bootReport.durationUs));
+    }
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::initialize(TwoWire* wire, int8_t interruptPin) {
+    // Prevent double initialization (which causes "Bus already started" warnings)
+    if (_initialized) {
+        DS3231_LOG_D("DS3231 already initialized - skipping");
+        return true;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Begin);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for begin()");
+        return false;
+    }
+
+    DS3231_LOG_I("Initializing DS3231 RTC controller");
+    _bootReport = {};
+
+    bool primaryFound = _rtc.begin(wire);
+    if (_secondaryWire) {
+        _secondaryReady = _secondaryRtc.begin(_secondaryWire);
+        if (!_secondaryReady) {
+            DS3231_LOG_W("Secondary DS3231 not found");
+        }
+    }
+    if (!primaryFound && !_secondaryReady) {
+        DS3231_LOG_E("Failed to initialize DS3231");
+        return false;
+    }
+
+    _wire = wire;
+    if (!primaryFound) {
+        DS3231_LOG_W("Primary DS3231 not found - running on the secondary");
+        _onSecondary = true;
+        _failovers++;
+    }
+
+    // Waking from deep sleep: the RTC kept running on battery and the alarm
+    // flag is the wake reason, so skip the power-loss check, alarm clearing
+    // and time read, and restore the schedules from RTC memory
+    esp_sleep_wakeup_cause_t wakeCause = esp_sleep_get_wakeup_cause();
+    if (wakeCause != ESP_SLEEP_WAKEUP_UNDEFINED && restoreSleepCache()) {
+        _initialized = true;
+        _resumedFromSleep = true;
+        _bootReport.resumedFromSleep = true;
+
+        DS3231_LOG_I("DS3231 resumed from deep sleep with %d schedules", _schedules.size());
+
+        if (interruptPin >= 0 && !attachAlarmInterrupt(interruptPin)) {
+            return false;
+        }
+        return true;
+    }
+
+    if (_bootPolicy.deferValidation) {
+        // Probe only: the first query reads the clock, and a power loss stays
+        // flagged in OSF until setTime() (e.g. once NTP is up) clears it
+        _bootReport.validationDeferred = true;
+        _lastCheck = kInvalidTime;
+        _initialized = true;
+        DS3231_LOG_I("DS3231 initialized, clock validation deferred");
+
+        if (interruptPin >= 0 && !attachAlarmInterrupt(interruptPin)) {
+            return false;
+        }
+        return true;
+    }
+
+    // One burst read covers the time, OSF and both alarm flags
+    uint8_t regs[DS3231_REGISTER_COUNT];
+    RegisterSnapshot snapshot;
+    bool timeValid = false;
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        if (!readRegisters(0x00, regs, sizeof(regs))) {
+            DS3231_LOG_E("Failed to read DS3231 registers");
+            return false;
+        }
+        timeValid = parseRegisters(regs, snapshot);
+        if (!(regs[DS3231_REG_STATUS] & DS3231_STATUS_OSF) || pass > 0) {
+            break;
+        }
+
+        _bootReport.lostPower = true;
+        RTC_DS3231* standby = primaryFound ? standbyRtc() : nullptr;
+        if (!standby || standby->lostPower() || !standby->now().isValid()) {
+            break;
+        }
+        DS3231_LOG_W("RTC lost power - switching to the other RTC");
+        _onSecondary = !_onSecondary;
+        _failovers++;
+        _bootReport.clockSet = true;
+    }
+
+    uint8_t status = regs[DS3231_REG_STATUS];
+    if (status & DS3231_STATUS_OSF) {
+        if (_bootPolicy.onPowerLoss == PowerLossAction::SetCompileTime) {
+            DS3231_LOG_W("RTC lost power, setting to compile time");
+            snapshot.time = DateTime(F(__DATE__), F(__TIME__));
+            activeRtc().adjust(snapshot.time);  // Clears OSF
+            status &= ~DS3231_STATUS_OSF;
+            timeValid = true;
+            _bootReport.clockSet = true;
+        } else {
+            DS3231_LOG_W("RTC lost power - keeping its time until setTime()");
+        }
+    }
+
+    // A standby chip that lost power follows the active one
+    RTC_DS3231* standby = primaryFound ? standbyRtc() : nullptr;
+    if (standby && standby->lostPower() && timeValid) {
+        DS3231_LOG_W("Standby RTC lost power - setting it from the active RTC");
+        standby->adjust(snapshot.time);
+    }
+
+    // Clear fired alarms with one write, unless one of them woke us
+    uint8_t fired = status & (DS3231_STATUS_A1F | DS3231_STATUS_A2F);
+    bool alarmWake = wakeCause == ESP_SLEEP_WAKEUP_EXT0 || wakeCause == ESP_SLEEP_WAKEUP_EXT1;
+    if (fired && _bootPolicy.keepAlarmsOnWake && alarmWake) {
+        _bootReport.alarmsKept = true;
+    } else if (fired) {
+        _bootReport.alarmsCleared = writeRegister(DS3231_REG_STATUS, status & ~fired);
+    }
+
+    _lastCheck = timeValid ? snapshot.time : kInvalidTime;
+    if (timeValid) {
+        setHealthReference(snapshot.time.unixtime(), esp_timer_get_time());
+    }
+    _initialized = true;
+
+    DS3231_LOG_I("DS3231 initialized successfully. Current time: %s",
+                 _lastCheck.timestamp(DateTime::TIMESTAMP_FULL).c_str());
+
+    if (interruptPin >= 0 && !attachAlarmInterrupt(interruptPin)) {
+        return false;
+    }
+
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::attachAlarmInterrupt(int8_t pin) {
+    // INTCN=1 routes alarm matches to INT/SQW instead of the square wave, on
+    // the chip the alarms are armed on
+    activeRtc().writeSqwPinMode(DS3231_OFF);
+
+    // The alarm task is the scheduler task: it owns dispatch for both paths
+    if (!startScheduler()) {
+        DS3231_LOG_E("Cannot dispatch alarm interrupts without the scheduler task");
+        return false;
+    }
+
+    // INT/SQW is open-drain and active low; it stays low until the flag is cleared
+    pinMode(pin, INPUT_PULLUP);
+    _interruptPin = pin;
+    attachInterruptArg(digitalPinToInterrupt(pin), alarmIsr, this, FALLING);
+
+    DS3231_LOG_I("Alarm interrupt attached on GPIO %d", pin);
+
+    // An alarm that fired before the ISR was attached left INT low with no
+    // falling edge to come, so service it once now
+    xTaskNotify(_schedulerTask, NOTIFY_ALARM, eSetBits);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void IRAM_ATTR DS3231ControllerT<MaxSchedules, NameSize>::alarmIsr(void* arg) {
+    auto* self = static_cast<DS3231ControllerT*>(arg);
+    TaskHandle_t task = self->_schedulerTask;
+    if (!task) {
+        return;
+    }
+
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(task, NOTIFY_ALARM, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::prepareDeepSleep() {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    if (_interruptPin < 0) {
+        DS3231_LOG_E("Deep sleep wake requires the INT/SQW pin - pass one to begin()");
+        return false;
+    }
+
+    // INT/SQW must carry the alarm again
+    if (_edgePin >= 0) {
+        disableSecondEdgeCapture();
+    }
+
+    // Bring the active set up to date first so the edge that wakes us is
+    // reported as a transition against the state we slept in
+    (void)checkScheduleTransitions();
+
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for prepareDeepSleep()");
+        return false;
+    }
+
+    if (!setAlarmForNextSchedule()) {
+        DS3231_LOG_W("No upcoming schedule edge - deep sleep wake depends on other sources");
+    }
+
+    saveSleepCache();
+
+    gpio_num_t pin = static_cast<gpio_num_t>(_interruptPin);
+    if (!rtc_gpio_is_valid_gpio(pin)) {
+        DS3231_LOG_E("GPIO %d cannot wake from deep sleep (not an RTC GPIO)", _interruptPin);
+        return false;
+    }
+
+    // Module pull-ups are optional; keep INT high while the digital pads are off
+    rtc_gpio_pullup_en(pin);
+    rtc_gpio_pulldown_dis(pin);
+
+#if SOC_PM_SUPPORT_EXT0_WAKEUP
+    esp_err_t err = esp_sleep_enable_ext0_wakeup(pin, 0);
+#elif SOC_PM_SUPPORT_EXT1_WAKEUP
+    esp_err_t err = esp_sleep_enable_ext1_wakeup(1ULL << _interruptPin, ESP_EXT1_WAKEUP_ALL_LOW);
+#else
+    esp_err_t err = ESP_FAIL;
+#endif
+    if (err != ESP_OK) {
+        DS3231_LOG_E("Failed to enable deep sleep wakeup on GPIO %d", _interruptPin);
+        return false;
+    }
+
+    DS3231_LOG_I("Ready for deep sleep, waking on GPIO %d", _interruptPin);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::enterDeepSleep() {
+    if (!prepareDeepSleep()) {
+        return false;
+    }
+
+    stopScheduler();
+    esp_deep_sleep_start();
+    return false;  // Not reached
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::saveSleepCache() {
+    SleepCache& cache = s_sleepCache;
+    memset(&cache, 0, sizeof(cache));
+
+    cache.scheduleCount = static_cast<uint8_t>(_schedules.size());
+    for (uint8_t i = 0; i < cache.scheduleCount; i++) {
+        const Schedule& src = _schedules[i];
+        typename SleepCache::Record& dst = cache.schedules[i];
+        dst.id = src.id;
+        dst.dayMask = src.dayMask;
+        dst.startHour = src.startHour;
+        dst.startMinute = src.startMinute;
+        dst.endHour = src.endHour;
+        dst.endMinute = src.endMinute;
+        dst.enabled = src.enabled ? 1 : 0;
+        dst.recurrence = static_cast<uint8_t>(src.recurrence);
+        dst.interval = src.interval;
+        dst.firstDay = src.firstDay;
+        dst.lastDay = src.lastDay;
+        strncpy(dst.name, src.name.c_str(), sizeof(dst.name) - 1);
+    }
+
+    cache.activeCount = _activeCount;
+    memcpy(cache.activeIds, _activeIds, _activeCount);
+    cache.sleepEpoch = _lastCheck.isValid() ? _lastCheck.unixtime() : 0;
+
+    cache.vacationEnabled = _vacationMode.enabled ? 1 : 0;
+    cache.vacationRunPump = _vacationMode.runPumpExercise ? 1 : 0;
+    cache.vacationStart = _vacationMode.startDate.unixtime();
+    cache.vacationEnd = _vacationMode.endDate.unixtime();
+
+    cache.pumpEnabled = _pumpExercise.enabled ? 1 : 0;
+    cache.pumpDayOfMonth = _pumpExercise.dayOfMonth;
+    cache.pumpHour = _pumpExercise.hour;
+    cache.pumpMinute = _pumpExercise.minute;
+    cache.pumpDuration = _pumpExercise.durationSeconds;
+    cache.pumpLastRun = _pumpExercise.lastRun.isValid() ? _pumpExercise.lastRun.unixtime() : 0;
+    cache.changes = _changes;
+    cache.timeZoneEnabled = _timeZoneEnabled ? 1 : 0;
+    DS3231TimeZone zone = _timeZone.stable();
+    memcpy(cache.timeZone, &zone, sizeof(zone));
+
+    cache.checksum = cache.computeChecksum();
+    cache.magic = SleepCache::MAGIC;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::restoreSleepCache() {
+    SleepCache& cache = s_sleepCache;
+    if (!cache.isValid() || cache.scheduleCount > MAX_SCHEDULES || cache.activeCount > MAX_SCHEDULES) {
+        return false;
+    }
+
+    _schedules.clear();
+    for (uint8_t i = 0; i < cache.scheduleCount; i++) {
+        const typename SleepCache::Record& src = cache.schedules[i];
+        Schedule schedule;
+        schedule.id = src.id;
+        schedule.dayMask = src.dayMask;
+        schedule.startHour = src.startHour;
+        schedule.startMinute = src.startMinute;
+        schedule.endHour = src.endHour;
+        schedule.endMinute = src.endMinute;
+        schedule.enabled = src.enabled != 0;
+        schedule.recurrence = static_cast<Recurrence>(src.recurrence);
+        schedule.interval = src.interval;
+        schedule.firstDay = src.firstDay;
+        schedule.lastDay = src.lastDay;
+        schedule.name = src.name;
+        _schedules.push_back(schedule);
+    }
+
+    _activeCount = cache.activeCount;
+    memcpy(_activeIds, cache.activeIds, _activeCount);
+    _lastCheck = cache.sleepEpoch ? DateTime(cache.sleepEpoch) : kInvalidTime;
+
+    _vacationMode.enabled = cache.vacationEnabled != 0;
+    _vacationMode.runPumpExercise = cache.vacationRunPump != 0;
+    _vacationMode.startDate = DateTime(cache.vacationStart);
+    _vacationMode.endDate = DateTime(cache.vacationEnd);
+
+    _pumpExercise.enabled = cache.pumpEnabled != 0;
+    _pumpExercise.dayOfMonth = cache.pumpDayOfMonth;
+    _pumpExercise.hour = cache.pumpHour;
+    _pumpExercise.minute = cache.pumpMinute;
+    _pumpExercise.durationSeconds = cache.pumpDuration;
+    _pumpExercise.lastRun = cache.pumpLastRun ? DateTime(cache.pumpLastRun) : kInvalidTime;
+    _changes = cache.changes;
+    DS3231TimeZone zone;
+    memcpy(&zone, cache.timeZone, sizeof(zone));
+    _timeZone.update([&zone](DS3231TimeZone& tz) { tz = zone; });
+    _timeZoneEnabled = cache.timeZoneEnabled != 0;
+
+    publishCompiledState();
+
+    // One-shot: a later wake without prepareDeepSleep() must do a full begin()
+    cache.magic = 0;
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::enableLightSleepWakeup() {
+    if (_interruptPin < 0) {
+        DS3231_LOG_E("No alarm interrupt pin configured - pass one to begin()");
+        return false;
+    }
+
+    if (gpio_wakeup_enable(static_cast<gpio_num_t>(_interruptPin), GPIO_INTR_LOW_LEVEL) != ESP_OK ||
+        esp_sleep_enable_gpio_wakeup() != ESP_OK) {
+        DS3231_LOG_E("Failed to enable light sleep wakeup on GPIO %d", _interruptPin);
+        return false;
+    }
+
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::handleAlarmInterrupt() {
+    uint8_t fired = 0;
+
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::Events);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for handleAlarmInterrupt()");
+            return;
+        }
+
+        // One status read tells us which alarms fired; one write clears exactly
+        // those flags and releases INT, leaving OSF/EN32kHz untouched
+        uint8_t status = 0;
+        if (!readRegisters(DS3231_REG_STATUS, &status, 1)) {
+            DS3231_LOG_E("Failed to read DS3231 status register");
+            return;
+        }
+
+        fired = status & (DS3231_STATUS_A1F | DS3231_STATUS_A2F);
+        if (fired && !writeRegister(DS3231_REG_STATUS, status & ~fired)) {
+            DS3231_LOG_E("Failed to clear DS3231 alarm flags");
+        }
+    }
+
+    if (!fired) {
+        return;
+    }
+
+    DateTime at = toWallClock(cachedTime());
+    uint32_t epoch = at.isValid() ? at.unixtime() : 0;
+    if (fired & DS3231_STATUS_A1F) {
+        DS3231_LOG_D("Alarm 1 interrupt");
+        emitEvent(EventType::AlarmFired, epoch, 0, ALARM_1);
+        (void)setAlarmForNextSchedule();
+    }
+
+    if (fired & DS3231_STATUS_A2F) {
+        DS3231_LOG_D("Alarm 2 interrupt");
+        emitEvent(EventType::AlarmFired, epoch, 0, ALARM_2);
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::readSnapshot(RegisterSnapshot& out) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Snapshot);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for readSnapshot()");
+        return false;
+    }
+
+    return readSnapshotLocked(out);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::RegisterSnapshot DS3231ControllerT<MaxSchedules, NameSize>::getLastSnapshot() const {
+    return _snapshot.load();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::readSnapshotLocked(RegisterSnapshot& out) const {
+    uint8_t regs[DS3231_REGISTER_COUNT];
+    int64_t startUs = esp_timer_get_time();
+    if (!readRegisters(0x00, regs, sizeof(regs))) {
+        DS3231_LOG_E("Register burst read failed");
+        return false;
+    }
+    int64_t nowUs = esp_timer_get_time();
+
+    if (!parseRegisters(regs, out)) {
+        DS3231_LOG_W("Register snapshot has out-of-range time");
+        return false;
+    }
+    out.capturedUs = nowUs;
+    _snapshot.update([&out](RegisterSnapshot& snapshot) { snapshot = out; });
+    noteTemperature(out);
+
+    // The burst read includes the time registers: use them as a free re-anchor
+    // (also what nowAsync() extrapolates from when the cached clock is off)
+    (void)anchorClockAt(out.time, secondStartUs(startUs, nowUs));
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::currentSnapshot(RegisterSnapshot& out) const {
+    const RegisterSnapshot& last = _snapshot.stable();  // Caller holds _mutex
+    if (_snapshotMaxAgeUs > 0 && last.valid && esp_timer_get_time() - last.capturedUs <= _snapshotMaxAgeUs) {
+        out = last;
+        return true;
+    }
+    return readSnapshotLocked(out);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::noteTemperature(const RegisterSnapshot& snapshot) const {
+    int16_t quarterC = static_cast<int16_t>(static_cast<int8_t>(snapshot.raw[0x11]) * 4 + (snapshot.raw[0x12] >> 6));
+    bool expired = !_temperature.valid ||
+                   snapshot.capturedUs - _temperature.capturedUs >= TEMPERATURE_CONVERSION_PERIOD_MS * 1000LL;
+
+    // A changed value inside the window means a conversion just ran: restart
+    // the window there, which pulls it into phase with the DS3231's cycle
+    if (!expired && quarterC == _temperature.sample.quarterC) {
+        return;
+    }
+
+    _temperature.sample.epoch = snapshot.time.unixtime();
+    _temperature.sample.quarterC = quarterC;
+    _temperature.capturedUs = snapshot.capturedUs;
+    _temperature.valid = true;
+    _temperatureHistory.push(_temperature.sample);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::readRegisters(uint8_t reg, uint8_t* buffer, size_t length) const {
+    // A failed transfer is retried once on the standby RTC, if any
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        TwoWire* wire = activeWire();
+        if (!wire) {
+            return false;
+        }
+
+        wire->beginTransmission(DS3231_I2C_ADDRESS);
+        wire->write(reg);
+        uint8_t result = wire->endTransmission(false);
+        _stats.noteI2c(result);
+        if (result == 0) {
+            if (wire->requestFrom(DS3231_I2C_ADDRESS, length, true) == length) {
+                for (size_t i = 0; i < length; i++) {
+                    buffer[i] = wire->read();
+                }
+                noteBusResult(true);
+                return true;
+            }
+            _stats.noteShortRead();
+        }
+        noteBusResult(false);
+
+        if (attempt > 0 || !failOver("register read failed")) {
+            return false;
+        }
+    }
+    return false;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::writeRegister(uint8_t reg, uint8_t value) const {
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        TwoWire* wire = activeWire();
+        if (!wire) {
+            return false;
+        }
+
+        wire->beginTransmission(DS3231_I2C_ADDRESS);
+        wire->write(reg);
+        wire->write(value);
+        uint8_t result = wire->endTransmission();
+        _stats.noteI2c(result);
+        noteBusResult(result == 0);
+        if (result == 0) {
+            return true;
+        }
+
+        if (attempt > 0 || !failOver("register write failed")) {
+            return false;
+        }
+    }
+    return false;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isRunning() const {
+    StatsGuard lock(_mutex, _stats, StatOp::Now);
+    if (!lock.hasLock()) {
+        return false;
+    }
+    // Check if oscillator is running; holdover time doesn't count
+    bool holdover;
+    DateTime rtcTime = readRtcClock(&holdover);
+    return rtcTime.isValid() && !holdover;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::begin(DS3231TimeSource& source) {
+    if (_initialized) {
+        DS3231_LOG_D("DS3231 already initialized - skipping");
+        return _timeSource == &source;
+    }
+    if (&source == this) {
+        DS3231_LOG_E("A controller cannot follow itself");
+        return false;
+    }
+
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::Begin);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for begin()");
+            return false;
+        }
+
+        _timeSource = &source;
+        _lastCheck = readRtcClock();
+        if (!_lastCheck.isValid()) {
+            DS3231_LOG_E("Time source returned an invalid time");
+            _timeSource = nullptr;
+            return false;
+        }
+
+        _initialized = true;
+        DS3231_LOG_I("Following a shared time source. Current time: %s",
+                     toWallClock(_lastCheck).timestamp(DateTime::TIMESTAMP_FULL).c_str());
+    }
+
+    // Outside _mutex, as in begin(TwoWire*); a follower arms no alarm
+    if (_storeRestoreOnBegin) {
+        (void)restoreFromStore();
+    }
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::readSourceTime() const {
+    if (!_initialized) {
+        return kInvalidTime;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Now);
+    if (!lock.hasLock()) {
+        return kInvalidTime;
+    }
+    return readRtcTime();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::attachSecondaryRtc(TwoWire* wire) {
+    if (!wire || _timeSource) {
+        DS3231_LOG_E("A secondary RTC needs its own bus and a controller with an RTC");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for attachSecondaryRtc()");
+        return false;
+    }
+
+    if (wire == _wire) {
+        DS3231_LOG_E("Secondary RTC must be on a different bus than the primary");
+        return false;
+    }
+    if (_onSecondary) {
+        DS3231_LOG_E("Running on the secondary RTC - call usePrimaryRtc() first");
+        return false;
+    }
+
+    _secondaryWire = wire;
+    if (!_initialized) {
+        return true;  // begin() probes it
+    }
+
+    _secondaryReady = _secondaryRtc.begin(wire);
+    if (!_secondaryReady) {
+        DS3231_LOG_E("Secondary DS3231 not found");
+        _secondaryWire = nullptr;
+        return false;
+    }
+
+    if (_secondaryRtc.lostPower()) {
+        _stats.noteRtclibRead();
+        DateTime rtcTime = _rtc.now();
+        if (rtcTime.isValid()) {
+            DS3231_LOG_W("Secondary RTC lost power - setting it from the primary");
+            _secondaryRtc.adjust(rtcTime);
+        }
+    }
+
+    DS3231_LOG_I("Secondary DS3231 attached");
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::usePrimaryRtc() {
+    if (!_initialized || _timeSource) {
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for usePrimaryRtc()");
+        return false;
+    }
+
+    if (!_onSecondary) {
+        return true;
+    }
+
+    _stats.noteRtclibRead();
+    DateTime primaryTime = _rtc.now();
+    if (!primaryTime.isValid()) {
+        DS3231_LOG_W("Primary RTC still not readable");
+        return false;
+    }
+
+    // The secondary carried the time (and any setTime()) while the primary was out
+    _stats.noteRtclibRead();
+    DateTime rtcTime = _secondaryRtc.now();
+    int64_t skew = static_cast<int64_t>(primaryTime.unixtime()) - rtcTime.unixtime();
+    if (rtcTime.isValid() && (_rtc.lostPower() || skew > 1 || skew < -1)) {
+        DS3231_LOG_W("Primary RTC off by %lld s - setting it from the secondary", static_cast<long long>(skew));
+        _rtc.adjust(rtcTime);
+    }
+    return failOver("primary restored");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+RTC_DS3231* DS3231ControllerT<MaxSchedules, NameSize>::standbyRtc() const {
+    if (!_secondaryReady) {
+        return nullptr;
+    }
+    return _onSecondary ? &_rtc : &_secondaryRtc;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::readRtcClock(bool* fromHoldover) const {
+    if (fromHoldover) {
+        *fromHoldover = false;
+    }
+    if (_timeSource) {
+        return _timeSource->readSourceTime();
+    }
+
+    int64_t nowUs = esp_timer_get_time();
+    auto holdover = [&]() {
+        DateTime held = holdoverTime(nowUs);
+        _health.update([&held](HealthReport& h) {
+            h.holdoverReads++;
+            h.state = held.isValid() ? ClockHealth::Holdover : ClockHealth::Failed;
+        });
+        if (fromHoldover) {
+            *fromHoldover = true;
+        }
+        return held;
+    };
+
+    // Holdover leaves a failing bus alone until the retry is due
+    if (_holdoverEnabled && nowUs < _health.stable().retryAtUs) {
+        return holdover();
+    }
+
+    // RTClib reports no bus errors; a NACKed read comes back invalid
+    _stats.noteRtclibRead();
+    DateTime rtcTime = activeRtc().now();
+    if (!rtcTime.isValid() && failOver("invalid time read")) {
+        _stats.noteRtclibRead();
+        rtcTime = activeRtc().now();
+    }
+    if (noteTimeRead(rtcTime, nowUs) || !_holdoverEnabled) {
+        return rtcTime;
+    }
+    return holdover();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::noteTimeRead(const DateTime& rtcTime, int64_t nowUs) const {
+    HealthTracker& tracker = _healthTracker;
+    bool accepted = rtcTime.isValid();
+    bool implausible = false;
+
+    // The RTC may not go backwards, nor drift from esp_timer by more than the
+    // read jitter plus 100 ppm since the last accepted read
+    if (accepted && tracker.referenceValid) {
+        int64_t epoch = rtcTime.unixtime();
+        int64_t elapsedUs = nowUs - tracker.referenceUs;
+        int64_t error = epoch - (tracker.referenceEpoch + elapsedUs / 1000000LL);
+        int64_t slack = HEALTH_SLACK_SECONDS + elapsedUs / 10000000000LL;
+        if (epoch < tracker.referenceEpoch || error > slack || error < -slack) {
+            // A clock that really moved (set by another bus master, or a
+            // failover to a chip that is off) keeps agreeing with itself
+            int64_t drift = epoch - (tracker.candidateEpoch + (nowUs - tracker.candidateUs) / 1000000LL);
+            bool agrees = tracker.candidateReads > 0 && drift >= -static_cast<int64_t>(HEALTH_SLACK_SECONDS) &&
+                          drift <= static_cast<int64_t>(HEALTH_SLACK_SECONDS);
+            if (agrees && ++tracker.candidateReads >= HEALTH_CONFIRM_READS) {
+                DS3231_LOG_W("RTC time moved by %ld s - accepted after %u agreeing reads",
+                             static_cast<long>(error), static_cast<unsigned>(HEALTH_CONFIRM_READS));
+            } else {
+                if (!agrees) {
+                    tracker.candidateEpoch = static_cast<uint32_t>(epoch);
+                    tracker.candidateUs = nowUs;
+                    tracker.candidateReads = 1;
+                }
+                accepted = false;
+                implausible = true;
+                DS3231_LOG_W("Implausible RTC time (%ld s off) - rejected", static_cast<long>(error));
+            }
+        }
+    }
+
+    if (accepted) {
+        if (_health.stable().consecutiveFailures > 0) {
+            DS3231_LOG_I("RTC time reads recovered after %u failures",
+                         static_cast<unsigned>(_health.stable().consecutiveFailures));
+        }
+        setHealthReference(rtcTime.unixtime(), nowUs);
+    }
+
+    bool holdoverEnabled = _holdoverEnabled;
+    _health.update([=](HealthReport& h) {
+        if (accepted) {
+            h.score = static_cast<uint8_t>(h.score + (100 - h.score + 7) / 8);
+            h.consecutiveFailures = 0;
+            h.lastGoodUs = nowUs;
+            h.retryAtUs = 0;
+            h.state = h.score >= HEALTH_DEGRADED_SCORE ? ClockHealth::Healthy : ClockHealth::Degraded;
+            return;
+        }
+
+        h.score = static_cast<uint8_t>(h.score - (h.score + 7) / 8);
+        if (h.consecutiveFailures < UINT16_MAX) {
+            h.consecutiveFailures++;
+        }
+        if (implausible) {
+            h.implausibleReads++;
+        } else {
+            h.failedReads++;
+        }
+        uint8_t shift = h.consecutiveFailures - 1 < HOLDOVER_BACKOFF_MAX_SHIFT ? h.consecutiveFailures - 1
+                                                                               : HOLDOVER_BACKOFF_MAX_SHIFT;
+        h.retryAtUs = nowUs + (static_cast<int64_t>(HOLDOVER_BACKOFF_MS) * 1000LL << shift);
+        // Without holdover an implausible time is still returned
+        h.state = implausible && !holdoverEnabled ? ClockHealth::Degraded : ClockHealth::Failed;
+    });
+
+    if (!accepted && !implausible) {
+        DS3231_LOG_W("RTC time read failed (%u in a row)", static_cast<unsigned>(_health.stable().consecutiveFailures));
+    }
+    return accepted;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::noteBusResult(bool ok) const {
+    _health.update([ok](HealthReport& h) {
+        if (ok) {
+            h.score = static_cast<uint8_t>(h.score + (100 - h.score + 7) / 8);
+        } else {
+            h.score = static_cast<uint8_t>(h.score - (h.score + 7) / 8);
+            h.busErrors++;
+        }
+        if (h.state == ClockHealth::Healthy || h.state == ClockHealth::Degraded) {
+            h.state = h.score >= HEALTH_DEGRADED_SCORE ? ClockHealth::Healthy : ClockHealth::Degraded;
+        }
+    });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::setHealthReference(uint32_t epoch, int64_t nowUs) const {
+    _healthTracker.referenceEpoch = epoch;
+    _healthTracker.referenceUs = nowUs;
+    _healthTracker.referenceValid = true;
+    _healthTracker.candidateReads = 0;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::holdoverTime(int64_t nowUs) const {
+    const HealthTracker& tracker = _healthTracker;
+    if (!tracker.referenceValid) {
+        return kInvalidTime;
+    }
+
+    int64_t elapsedUs = nowUs - tracker.referenceUs;
+    if (elapsedUs < 0 || elapsedUs / 1000000LL > _maxHoldoverSeconds) {
+        return kInvalidTime;
+    }
+
+    // esp_timer corrected by the cached clock's drift estimate, if it has one
+    int64_t correctedUs = elapsedUs + static_cast<int64_t>(elapsedUs * (_clock.stable().driftPpm * 1e-6f));
+    return DateTime(tracker.referenceEpoch + static_cast<uint32_t>(correctedUs / 1000000LL));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::enableHoldover(bool enable, uint32_t maxHoldoverSeconds) {
+    if (maxHoldoverSeconds == 0) {
+        maxHoldoverSeconds = DEFAULT_MAX_HOLDOVER_SECONDS;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for enableHoldover()");
+        return;
+    }
+
+    _holdoverEnabled = enable;
+    _maxHoldoverSeconds = maxHoldoverSeconds;
+
+    DS3231_LOG_I("Holdover %s (up to %lu s)", enable ? "enabled" : "disabled",
+                 static_cast<unsigned long>(maxHoldoverSeconds));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::failOver(const char* reason) const {
+    if (!_secondaryReady || _timeSource) {
+        return false;
+    }
+
+    _onSecondary = !_onSecondary;
+    _failovers++;
+    DS3231_LOG_W("RTC switch (%s): now on the %s", reason, _onSecondary ? "secondary" : "primary");
+
+    // Another oscillator: anchors, drift intervals and snapshots no longer apply
+    _clock.update([](ClockState& clock) {
+        clock.anchor.valid = false;
+        clock.driftBaseline.valid = false;
+        clock.driftPpm = 0.0f;
+    });
+    _drift.referenceEpoch = 0;
+    _snapshot.update([](RegisterSnapshot& snapshot) { snapshot.valid = false; });
+
+    // SQW edges come from the primary only
+    _edgeValidFromUs = _onSecondary ? INT64_MAX : esp_timer_get_time();
+
+    // The new chip arms the alarms, so it gets the INT/SQW mode too. A
+    // primary that lost power comes back with INTCN=1 and no square wave
+    applyIntSqwMode();
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::applyIntSqwMode() const {
+    if (_edgePin >= 0) {
+        activeRtc().writeSqwPinMode(DS3231_SquareWave1Hz);
+    } else if (_interruptPin >= 0) {
+        activeRtc().writeSqwPinMode(DS3231_OFF);
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setTime(const DateTime& dt) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    if (!dt.isValid()) {
+        DS3231_LOG_E("Invalid DateTime provided");
+        return false;
+    }
+
+    DateTime rtcTime = toRtcTime(dt);
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::SetTime);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for setTime()");
+            return false;
+        }
+        if (!writeRtcTime(rtcTime)) {
+            return false;
+        }
+    }
+
+    emitEvent(EventType::TimeChanged, toWallClock(rtcTime).unixtime());
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::writeRtcTime(const DateTime& rtcTime) {
+    if (_timeSource) {
+        DS3231_LOG_E("No RTC of its own - set the time on the time source");
+        return false;
+    }
+
+    DS3231_LOG_D("Setting RTC time to: %s", rtcTime.timestamp(DateTime::TIMESTAMP_FULL).c_str());
+    activeRtc().adjust(rtcTime);
+    if (RTC_DS3231* standby = standbyRtc()) {
+        standby->adjust(rtcTime);  // Keep the redundant chip in step
+    }
+
+    // Writing the seconds register restarts the DS3231 countdown chain, so the
+    // new time is an exact anchor. Drift history is meaningless across a step.
+    ClockAnchor anchor = {rtcTime.unixtime(), esp_timer_get_time(), true};
+    _clock.update([&](ClockState& clock) {
+        clock.anchor = anchor;
+        clock.driftBaseline = anchor;
+        clock.driftPpm = 0.0f;
+    });
+
+    // A step not backed by a reference ends the RTC drift interval too
+    _drift.referenceEpoch = 0;
+
+    // The write restarted the countdown chain; earlier SQW edges are off-phase
+    _edgeValidFromUs = anchor.micros;
+
+    // Plausibility checks and holdover continue from the new time
+    setHealthReference(anchor.epoch, anchor.micros);
+
+    // Wall-clock step: pending sleep deadlines are stale
+    notifyScheduler();
+
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::now() const {
+    return toWallClock(rtcNow());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::scheduleNow() const {
+    return toScheduleClock(rtcNow());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::rtcNow() const {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return kInvalidTime;
+    }
+
+    // Cached clock fast path: no mutex, no I2C while the anchor is fresh
+    DateTime cached;
+    if (_cachedClockEnabled && extrapolateTime(cached)) {
+        _stats.noteCall(StatOp::Now);
+        return cached;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Now);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for now()");
+        return kInvalidTime;
+    }
+
+    return readRtcTime();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::enableCachedClock(bool enable, uint32_t reanchorIntervalSeconds) {
+    if (reanchorIntervalSeconds == 0) {
+        reanchorIntervalSeconds = DEFAULT_REANCHOR_INTERVAL_SECONDS;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for enableCachedClock()");
+        return;
+    }
+
+    _clock.update([&](ClockState& clock) {
+        clock.reanchorIntervalUs = static_cast<int64_t>(reanchorIntervalSeconds) * 1000000LL;
+        clock.anchor.valid = false;  // Re-anchor on next read
+        clock.driftBaseline.valid = false;
+        clock.driftPpm = 0.0f;
+    });
+
+    _cachedClockEnabled = enable;
+
+    DS3231_LOG_I("Cached clock %s (re-anchor every %lu s)",
+                 enable ? "enabled" : "disabled", reanchorIntervalSeconds);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::reanchorClock() {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for reanchorClock()");
+        return false;
+    }
+
+    return anchorClock();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+float DS3231ControllerT<MaxSchedules, NameSize>::getClockDriftPpm() const {
+    return _clock.read([](const ClockState& clock) { return clock.driftPpm; });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::readTime() const {
+    return toWallClock(readRtcTime());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::readRtcTime() const {
+    DateTime rtcTime;
+    if (!_cachedClockEnabled || !(extrapolateTime(rtcTime) || (anchorClock() && extrapolateTime(rtcTime)))) {
+        rtcTime = readRtcClock();
+    }
+
+    // Keep the transition cache ahead of the clock, so lock-free readers
+    // rarely fall back to evaluating the rules
+    if (_timeZoneEnabled && rtcTime.isValid() && !_timeZone.stable().isCached(rtcTime.unixtime())) {
+        uint32_t utc = rtcTime.unixtime();
+        _timeZone.update([utc](DS3231TimeZone& tz) { tz.refresh(utc); });
+    }
+    return rtcTime;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::toWallClock(const DateTime& rtcTime) const {
+    if (!_timeZoneEnabled || !rtcTime.isValid()) {
+        return rtcTime;
+    }
+    uint32_t utc = rtcTime.unixtime();
+    return DateTime(_timeZone.read([utc](const DS3231TimeZone& tz) { return tz.toLocal(utc); }));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::toScheduleClock(const DateTime& rtcTime) const {
+    if (!_timeZoneEnabled || !rtcTime.isValid()) {
+        return rtcTime;
+    }
+    uint32_t utc = rtcTime.unixtime();
+    return DateTime(_timeZone.read([utc](const DS3231TimeZone& tz) { return tz.toScheduleTime(utc); }));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::toRtcTime(const DateTime& localTime) const {
+    if (!_timeZoneEnabled || !localTime.isValid()) {
+        return localTime;
+    }
+    uint32_t local = localTime.unixtime();
+    return DateTime(_timeZone.read([local](const DS3231TimeZone& tz) { return tz.toUtc(local); }));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::extrapolateTime(DateTime& out) const {
+    int64_t nowUs = esp_timer_get_time();
+
+    ClockState clock = _clock.load();
+    const ClockAnchor& anchor = clock.anchor;
+    int64_t intervalUs = clock.reanchorIntervalUs;
+    float ppm = clock.driftPpm;
+
+    if (!anchor.valid) {
+        return false;
+    }
+
+    int64_t elapsedUs = nowUs - anchor.micros;
+
+    // Re-anchor on the configured interval, or sooner if the drift estimate
+    // says the extrapolation would otherwise exceed the error budget
+    float absPpm = ppm < 0.0f ? -ppm : ppm;
+    if (absPpm > 0.1f) {
+        int64_t budgetUs = static_cast<int64_t>(CACHED_CLOCK_MAX_ERROR_MS * 1000.0f * 1e6f / absPpm);
+        if (budgetUs < intervalUs) {
+            intervalUs = budgetUs;
+        }
+    }
+
+    if (elapsedUs < 0 || elapsedUs >= intervalUs) {
+        return false;
+    }
+
+    // ppm > 0 means the RTC runs ahead of esp_timer, so stretch elapsed time
+    int64_t correctedUs = elapsedUs + static_cast<int64_t>(elapsedUs * (ppm * 1e-6f));
+    out = DateTime(anchor.epoch + static_cast<uint32_t>(correctedUs / 1000000LL));
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::anchorClock() const {
+    int64_t startUs = esp_timer_get_time();
+    bool holdover;
+    DateTime rtcTime = readRtcClock(&holdover);
+    if (holdover) {
+        return false;  // Only the RTC itself is an anchor
+    }
+    return anchorClockAt(rtcTime, secondStartUs(startUs, esp_timer_get_time()));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::anchorClockAt(const DateTime& rtcTime, int64_t nowUs) const {
+    if (!rtcTime.isValid()) {
+        DS3231_LOG_W("Cached clock: RTC returned invalid time, not anchoring");
+        return false;
+    }
+
+    // Caller holds _mutex, so no writer can be mid-update
+    ClockAnchor baseline = _clock.stable().driftBaseline;
+    float ppm = _clock.stable().driftPpm;
+
+    // Estimate esp_timer drift against the RTC from the first anchor onwards.
+    // The RTC only resolves whole seconds, so the estimate is only trusted once
+    // the baseline is long enough to push the +/-1 s read jitter well below it.
+    if (!baseline.valid) {
+        baseline.epoch = rtcTime.unixtime();
+        baseline.micros = nowUs;
+        baseline.valid = true;
+    } else {
+        int64_t elapsedUs = nowUs - baseline.micros;
+        if (elapsedUs >= static_cast<int64_t>(DRIFT_MIN_BASELINE_SECONDS) * 1000000LL) {
+            float elapsedSec = elapsedUs / 1e6f;
+            float rtcElapsedSec = static_cast<float>(static_cast<int32_t>(rtcTime.unixtime() - baseline.epoch));
+            float estimate = (rtcElapsedSec - elapsedSec) / elapsedSec * 1e6f;
+            if (estimate > -MAX_PLAUSIBLE_DRIFT_PPM && estimate < MAX_PLAUSIBLE_DRIFT_PPM) {
+                ppm = estimate;
+            } else {
+                DS3231_LOG_D("Cached clock: ignoring implausible drift estimate %.1f ppm", estimate);
+            }
+        }
+    }
+
+    _clock.update([&](ClockState& clock) {
+        clock.anchor = {rtcTime.unixtime(), nowUs, true};
+        clock.driftBaseline = baseline;
+        clock.driftPpm = ppm;
+    });
+
+    DS3231_LOG_D("Cached clock anchored at %s (drift %.2f ppm)",
+                 rtcTime.timestamp(DateTime::TIMESTAMP_FULL).c_str(), ppm);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::addSchedule(const Schedule& schedule) {
+    StatsGuard lock(_mutex, _stats, StatOp::Schedules);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for addSchedule()");
+        return false;
+    }
+
+    if (_schedules.size() >= MAX_SCHEDULES) {
+        DS3231_LOG_E("Maximum number of schedules (%d) reached", MAX_SCHEDULES);
+        return false;
+    }
+    
+    Schedule newSchedule = schedule;
+    if (newSchedule.id == 0) {
+        newSchedule.id = getNextFreeScheduleId();
+    }
+    
+    _schedules.push_back(newSchedule);
+    ChangeSet::insert(_changes.dirtyIds, newSchedule.id);
+    markStoreDirty();
+    
+    DS3231_LOG_I("Added schedule %d '%s': %02d:%02d-%02d:%02d, days=%s", 
+                 newSchedule.id, newSchedule.name.c_str(),
+                 newSchedule.startHour, newSchedule.startMinute,
+                 newSchedule.endHour, newSchedule.endMinute,
+                 dayMaskText(newSchedule.dayMask));
+    
+    // Update alarm for next event
+    publishCompiledState();
+    (void)setAlarmForNextSchedule();
+    notifyScheduler();
+    
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::updateSchedule(uint8_t scheduleId, const Schedule& schedule) {
+    StatsGuard lock(_mutex, _stats, StatOp::Schedules);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for updateSchedule()");
+        return false;
+    }
+
+    for (auto& sched : _schedules) {
+        if (sched.id == scheduleId) {
+            sched = schedule;
+            sched.id = scheduleId;  // Preserve ID
+            ChangeSet::insert(_changes.dirtyIds, scheduleId);
+            markStoreDirty();
+            DS3231_LOG_I("Updated schedule %d", scheduleId);
+            publishCompiledState();
+            (void)setAlarmForNextSchedule();
+            notifyScheduler();
+            return true;
+        }
+    }
+    
+    DS3231_LOG_W("Schedule %d not found", scheduleId);
+    return false;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::removeSchedule(uint8_t scheduleId) {
+    StatsGuard lock(_mutex, _stats, StatOp::Schedules);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for removeSchedule()");
+        return false;
+    }
+
+    auto it = std::remove_if(_schedules.begin(), _schedules.end(),
+                            [scheduleId](const Schedule& s) { return s.id == scheduleId; });
+    
+    if (it != _schedules.end()) {
+        _schedules.erase(it, _schedules.end());
+        markStoreDirty();
+        DS3231_LOG_I("Removed schedule %d", scheduleId);
+        publishCompiledState();
+        (void)setAlarmForNextSchedule();
+        notifyScheduler();
+        return true;
+    }
+    
+    DS3231_LOG_W("Schedule %d not found", scheduleId);
+    return false;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+const typename DS3231ControllerT<MaxSchedules, NameSize>::Schedule* DS3231ControllerT<MaxSchedules, NameSize>::getSchedule(uint8_t scheduleId) const {
+    for (const auto& schedule : _schedules) {
+        if (schedule.id == scheduleId) {
+            return &schedule;
+        }
+    }
+    return nullptr;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::clearAllSchedules() {
+    StatsGuard lock(_mutex, _stats, StatOp::Schedules);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for clearAllSchedules()");
+        return;
+    }
+
+    _schedules.clear();
+    markStoreDirty();
+    publishCompiledState();
+    DS3231_LOG_I("All schedules cleared");
+    notifyScheduler();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isWithinAnySchedule() const {
+    if (!_initialized) {
+        return false;
+    }
+
+    return isWithinAnySchedule(scheduleNow());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isWithinSchedule(uint8_t scheduleId) const {
+    if (!_initialized) {
+        return false;
+    }
+
+    return isWithinSchedule(scheduleId, scheduleNow());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::Schedule* DS3231ControllerT<MaxSchedules, NameSize>::getCurrentActiveSchedule() {
+    return const_cast<Schedule*>(static_cast<const DS3231ControllerT*>(this)->getCurrentActiveSchedule());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+const typename DS3231ControllerT<MaxSchedules, NameSize>::Schedule* DS3231ControllerT<MaxSchedules, NameSize>::getCurrentActiveSchedule() const {
+    if (!_initialized) {
+        return nullptr;
+    }
+
+    return evaluateAt(scheduleNow()).active;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::getNextScheduledStart() const {
+    if (!_initialized) {
+        return kInvalidTime;
+    }
+
+    return evaluateLockFree(scheduleNow()).nextStart;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::getNextScheduledEnd() const {
+    if (!_initialized) {
+        return kInvalidTime;
+    }
+
+    return evaluateLockFree(scheduleNow()).nextEnd;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint32_t DS3231ControllerT<MaxSchedules, NameSize>::getSecondsUntilNextEvent() const {
+    if (!_initialized) {
+        return 0xFFFFFFFF;
+    }
+
+    // Count real seconds: across a DST change local differences are off
+    DateTime rtcTime = rtcNow();
+    ScheduleEvaluation eval = evaluateLockFree(toScheduleClock(rtcTime));
+
+    uint32_t secondsToStart = 0xFFFFFFFF;
+    uint32_t secondsToEnd = 0xFFFFFFFF;
+
+    if (eval.nextStart.isValid() && toRtcTime(eval.nextStart) > rtcTime) {
+        secondsToStart = toRtcTime(eval.nextStart).unixtime() - rtcTime.unixtime();
+    }
+
+    if (eval.nextScheduleEnd.isValid() && toRtcTime(eval.nextScheduleEnd) > rtcTime) {
+        secondsToEnd = toRtcTime(eval.nextScheduleEnd).unixtime() - rtcTime.unixtime();
+    }
+
+    // Return the soonest event
+    return (secondsToStart < secondsToEnd) ? secondsToStart : secondsToEnd;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::ScheduleEvaluation DS3231ControllerT<MaxSchedules, NameSize>::evaluateAt(const DateTime& at) const {
+    ScheduleEvaluation eval = evaluateLockFree(at);
+    if (eval.activeId == 0) {
+        return eval;
+    }
+
+    // Only the pointer into schedule storage needs the mutex
+    StatsGuard lock(_mutex, _stats, StatOp::Evaluate);
+    if (!lock.hasLock()) {
+        return eval;
+    }
+
+    for (const auto& schedule : _schedules) {
+        if (schedule.id == eval.activeId) {
+            eval.active = &schedule;
+            break;
+        }
+    }
+
+    return eval;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::ScheduleEvaluation DS3231ControllerT<MaxSchedules, NameSize>::evaluateLockFree(const DateTime& at) const {
+    return _compiled.read([&at](const CompiledState& state) {
+        ScheduleEvaluation eval;
+        evaluateCompiled(state, at, eval);
+        return eval;
+    });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::evaluateCompiled(const CompiledState& state, const DateTime& at, ScheduleEvaluation& eval) {
+    eval.at = at;
+    eval.vacationActive = false;
+    eval.active = nullptr;
+    eval.activeId = 0;
+    eval.nextStart = kInvalidTime;
+    eval.nextEnd = kInvalidTime;
+    eval.nextScheduleEnd = kInvalidTime;
+    eval.pumpExerciseDue = false;
+
+    if (!at.isValid()) {
+        return;
+    }
+
+    // Counts are clamped: a reader may see a torn copy before its retry
+    uint8_t windowCount = state.windowCount <= MAX_SCHEDULES ? state.windowCount : MAX_SCHEDULES;
+
+    eval.vacationActive = isVacationActiveAt(state, at);
+
+    // Schedules, vacation and pump exercise all come from this one pass
+    uint32_t nowMinute = minuteSince2000(at);
+    uint32_t secondsBase = at.unixtime() - at.second() - nowMinute * 60;  // Epoch of minute 0
+    uint32_t earliestEnd = NO_START_MINUTE;
+    for (uint8_t i = 0; i < windowCount; i++) {
+        uint32_t endMinute;
+        if (isWindowActiveAt(state.windows[i], nowMinute, &endMinute)) {
+            if (eval.activeId == 0) {
+                eval.activeId = state.windows[i].id;
+            }
+            if (endMinute < earliestEnd) {
+                earliestEnd = endMinute;
+            }
+        }
+    }
+    if (earliestEnd != NO_START_MINUTE) {
+        eval.nextScheduleEnd = DateTime(secondsBase + earliestEnd * 60);
+        uint32_t mergedEnd = findMergedEnd(state, nowMinute);
+        if (mergedEnd != NO_START_MINUTE) {
+            eval.nextEnd = DateTime(secondsBase + mergedEnd * 60);
+        }
+    }
+
+    uint32_t nextStart = findNextStart(state, nowMinute);
+    if (nextStart != NO_START_MINUTE) {
+        eval.nextStart = DateTime(secondsBase + nextStart * 60);
+    }
+
+    uint16_t month = static_cast<uint16_t>(at.year() * 12 + at.month());
+    eval.pumpExerciseDue = isWindowActiveAt(state.pump, nowMinute) && state.pumpLastRunMonth != month &&
+                           (!eval.vacationActive || state.vacationRunsPump);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isWithinAnySchedule(const DateTime& at) const {
+    if (!at.isValid()) {
+        return false;
+    }
+
+    // One lookup in the merged coverage; the schedule that covers 'at' is not needed
+    uint32_t minute = minuteSince2000(at);
+    bool vacation = false;
+    bool covered = _compiled.read([&at, minute, &vacation](const CompiledState& state) {
+        vacation = isVacationActiveAt(state, at);
+        return !vacation && isCoveredAt(state, minute);
+    });
+    if (vacation) {
+        DS3231_LOG_D("Vacation mode active, schedules disabled");
+    }
+    return covered;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isWithinSchedule(uint8_t scheduleId, const DateTime& at) const {
+    if (!at.isValid()) {
+        return false;
+    }
+
+    uint32_t minute = minuteSince2000(at);
+    return _compiled.read([scheduleId, minute](const CompiledState& state) {
+        uint8_t windowCount = state.windowCount <= MAX_SCHEDULES ? state.windowCount : MAX_SCHEDULES;
+        for (uint8_t i = 0; i < windowCount; i++) {
+            if (state.windows[i].id == scheduleId) {
+                return isWindowActiveAt(state.windows[i], minute);
+            }
+        }
+        return false;
+    });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isScheduleActiveAt(const Schedule& schedule, const DateTime& at) const {
+    if (!at.isValid()) {
+        return false;
+    }
+    return isWindowActiveAt(compileWindow(schedule), minuteSince2000(at));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::CompiledWindow DS3231ControllerT<MaxSchedules, NameSize>::compileWindow(const Schedule& schedule) {
+    DayRule rule = {schedule.recurrence, schedule.dayMask, schedule.interval, schedule.firstDay, schedule.lastDay};
+    uint16_t start = schedule.startHour * 60 + schedule.startMinute;
+    uint16_t end = schedule.endHour * 60 + schedule.endMinute;
+    uint16_t duration = (schedule.enabled && rule.isValid()) ? (end + MINUTES_PER_DAY - start) % MINUTES_PER_DAY : 0;
+    return {schedule.id, rule, start, duration};
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isWindowActiveAt(const CompiledWindow& window, uint32_t minute,
+                                                                 uint32_t* endMinute) {
+    if (window.duration == 0) {
+        return false;
+    }
+
+    // A window belongs to the day it starts on, so a 23:00-01:00 window that
+    // starts Saturday is still active at 00:30 Sunday even if Sunday is off
+    uint16_t day = static_cast<uint16_t>(minute / MINUTES_PER_DAY);
+    uint16_t minuteOfDay = minute % MINUTES_PER_DAY;
+    uint32_t startDay;
+    if (minuteOfDay >= window.startOfDay && minuteOfDay - window.startOfDay < window.duration &&
+        window.rule.matches(day)) {
+        startDay = day;
+    } else if (day > 0 && minuteOfDay + MINUTES_PER_DAY - window.startOfDay < window.duration &&
+               window.rule.matches(day - 1)) {
+        startDay = day - 1;
+    } else {
+        return false;
+    }
+
+    if (endMinute) {
+        *endMinute = startDay * MINUTES_PER_DAY + window.startOfDay + window.duration;
+    }
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isVacationActiveAt(const CompiledState& state, const DateTime& at) {
+    uint32_t epoch = at.unixtime();
+    return state.vacationEnabled && epoch >= state.vacationStart && epoch <= state.vacationEnd;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::publishCompiledState() {
+    _compiled.update([this](CompiledState& state) {
+        state.windowCount = 0;
+        state.edgeCount = 0;
+        state.coverageCount = 0;
+        state.hasRuleWindows = false;
+        uint16_t longestPeriod = 7;
+
+        for (const auto& schedule : _schedules) {
+            uint8_t index = state.windowCount++;
+            CompiledWindow window = compileWindow(schedule);
+            state.windows[index] = window;
+            if (window.duration == 0) continue;
+
+            // Weekly rules start on their dayMask days; the others may start on
+            // any weekday and are filtered by date when the table is walked
+            uint8_t days = window.rule.recurrence == Recurrence::Weekly ? window.rule.dayMask : 0x7F;
+            for (uint8_t day = 0; day < 7; day++) {
+                if (!(days & (1 << day))) continue;
+                uint16_t start = static_cast<uint16_t>(day * MINUTES_PER_DAY + window.startOfDay);
+                state.edges[state.edgeCount++] = {start, index};
+                if (!window.rule.isWeekly()) continue;
+
+                // Saturday windows past midnight continue at the start of the week
+                uint16_t end = static_cast<uint16_t>(start + window.duration);
+                if (end > MINUTES_PER_WEEK) {
+                    state.coverage[state.coverageCount++] = {0, static_cast<uint16_t>(end - MINUTES_PER_WEEK)};
+                    end = MINUTES_PER_WEEK;
+                }
+                state.coverage[state.coverageCount++] = {start, end};
+            }
+            if (!window.rule.isWeekly()) {
+                state.hasRuleWindows = true;
+            }
+            if (window.rule.period() > longestPeriod) {
+                longestPeriod = window.rule.period();
+            }
+        }
+
+        std::sort(state.edges, state.edges + state.edgeCount, [](const ScheduleEdge& a, const ScheduleEdge& b) {
+            return a.minuteOfWeek < b.minuteOfWeek;
+        });
+
+        // Merge overlapping and touching intervals into their union
+        std::sort(state.coverage, state.coverage + state.coverageCount,
+                  [](const CoverageInterval& a, const CoverageInterval& b) { return a.start < b.start; });
+        uint16_t merged = 0;
+        for (uint16_t i = 0; i < state.coverageCount; i++) {
+            const CoverageInterval& next = state.coverage[i];
+            if (merged > 0 && next.start <= state.coverage[merged - 1].end) {
+                if (next.end > state.coverage[merged - 1].end) {
+                    state.coverage[merged - 1].end = next.end;
+                }
+            } else {
+                state.coverage[merged++] = next;
+            }
+        }
+        state.coverageCount = merged;
+        state.lookaheadWeeks = static_cast<uint8_t>((longestPeriod + 6) / 7);
+
+        state.vacationEnabled = _vacationMode.enabled;
+        state.vacationRunsPump = _vacationMode.runPumpExercise;
+        state.vacationStart = _vacationMode.startDate.unixtime();
+        state.vacationEnd = _vacationMode.endDate.unixtime();
+
+        // Pump exercise is a one-minute monthly window
+        const PumpExercise& pump = _pumpExercise;
+        state.pump = {0, {Recurrence::Monthly, 0, pump.dayOfMonth, 0, NO_END_DAY},
+                      static_cast<uint16_t>(pump.hour * 60 + pump.minute), 0};
+        state.pump.duration = (pump.enabled && state.pump.rule.isValid()) ? 1 : 0;
+        state.pumpLastRunMonth = pump.lastRun.isValid() ? pump.lastRun.year() * 12 + pump.lastRun.month() : 0;
+    });
+
+    DS3231_LOG_D("Compiled state published: %d edges, %d coverage intervals", _compiled.stable().edgeCount,
+                 _compiled.stable().coverageCount);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint16_t DS3231ControllerT<MaxSchedules, NameSize>::findNextEdge(const CompiledState& state, uint16_t minute) {
+    // First edge strictly after 'minute', or edgeCount if none is left this week
+    uint16_t edgeCount = state.edgeCount <= MAX_EDGES ? state.edgeCount : MAX_EDGES;
+    uint16_t lo = 0;
+    uint16_t hi = edgeCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (state.edges[mid].minuteOfWeek <= minute) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint32_t DS3231ControllerT<MaxSchedules, NameSize>::findNextStart(const CompiledState& state, uint32_t minute) {
+    uint16_t edgeCount = state.edgeCount <= MAX_EDGES ? state.edgeCount : MAX_EDGES;
+    uint8_t windowCount = state.windowCount <= MAX_SCHEDULES ? state.windowCount : MAX_SCHEDULES;
+    if (edgeCount == 0) {
+        return NO_START_MINUTE;
+    }
+
+    // Walk the table forward (cyclically) from the first edge after 'minute'
+    // until a start falls on a day its rule matches. Weekly rules match on
+    // the first edge they own; a lookahead of the longest rule period is
+    // enough for the others. A rule whose first day lies beyond the
+    // lookahead resumes the walk there.
+    uint8_t weeks = state.lookaheadWeeks ? state.lookaheadWeeks : 1;
+    for (uint8_t restarts = 0; restarts <= windowCount; restarts++) {
+        uint16_t weekday = (minute / MINUTES_PER_DAY + 6) % 7;  // 2000-01-01 was a Saturday
+        uint16_t nowOfWeek = weekday * MINUTES_PER_DAY + minute % MINUTES_PER_DAY;
+        int64_t weekBase = static_cast<int64_t>(minute) - nowOfWeek;
+        uint16_t first = findNextEdge(state, nowOfWeek);
+
+        uint32_t steps = static_cast<uint32_t>(edgeCount) * weeks;
+        for (uint32_t k = 0; k < steps; k++) {
+            uint32_t position = first + k;
+            const ScheduleEdge& edge = state.edges[position % edgeCount];
+            if (edge.window >= windowCount) continue;
+            int64_t at = weekBase + static_cast<int64_t>(position / edgeCount) * MINUTES_PER_WEEK + edge.minuteOfWeek;
+            if (state.windows[edge.window].rule.matches(static_cast<uint16_t>(at / MINUTES_PER_DAY))) {
+                return static_cast<uint32_t>(at);
+            }
+        }
+
+        // Nothing within the lookahead: skip to the nearest later first day
+        uint32_t covered = minute + static_cast<uint32_t>(weeks) * MINUTES_PER_WEEK;
+        uint32_t resume = NO_START_MINUTE;
+        for (uint8_t i = 0; i < windowCount; i++) {
+            const CompiledWindow& window = state.windows[i];
+            uint32_t firstStart = static_cast<uint32_t>(window.rule.firstDay) * MINUTES_PER_DAY + window.startOfDay;
+            if (window.duration != 0 && firstStart > covered && firstStart < resume) {
+                resume = firstStart;
+            }
+        }
+        if (resume == NO_START_MINUTE) {
+            return NO_START_MINUTE;
+        }
+        minute = resume - 1;
+    }
+    return NO_START_MINUTE;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isCoveredAt(const CompiledState& state, uint32_t minute,
+                                                            uint32_t* endMinute) {
+    uint16_t coverageCount = state.coverageCount <= MAX_COVERAGE ? state.coverageCount : MAX_COVERAGE;
+    uint16_t weekday = (minute / MINUTES_PER_DAY + 6) % 7;  // 2000-01-01 was a Saturday
+    uint16_t ofWeek = weekday * MINUTES_PER_DAY + minute % MINUTES_PER_DAY;
+
+    // Last interval starting at or before 'ofWeek'
+    uint16_t lo = 0;
+    uint16_t hi = coverageCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (state.coverage[mid].start <= ofWeek) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    bool covered = false;
+    uint32_t end = 0;
+    if (lo > 0 && ofWeek < state.coverage[lo - 1].end) {
+        covered = true;
+        end = minute + (state.coverage[lo - 1].end - ofWeek);
+    }
+
+    if (state.hasRuleWindows) {
+        uint8_t windowCount = state.windowCount <= MAX_SCHEDULES ? state.windowCount : MAX_SCHEDULES;
+        for (uint8_t i = 0; i < windowCount; i++) {
+            uint32_t windowEnd;
+            if (!state.windows[i].rule.isWeekly() && isWindowActiveAt(state.windows[i], minute, &windowEnd)) {
+                covered = true;
+                if (windowEnd > end) {
+                    end = windowEnd;
+                }
+            }
+        }
+    }
+
+    if (covered && endMinute) {
+        *endMinute = end;
+    }
+    return covered;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint32_t DS3231ControllerT<MaxSchedules, NameSize>::findMergedEnd(const CompiledState& state, uint32_t minute) {
+    uint32_t end;
+    if (!isCoveredAt(state, minute, &end)) {
+        return NO_START_MINUTE;
+    }
+
+    // Weekly coverage is merged already; follow it across the week end and
+    // through rule windows until the first uncovered minute
+    while (end - minute < MINUTES_PER_WEEK) {
+        uint32_t further;
+        if (!isCoveredAt(state, end, &further)) {
+            return end;
+        }
+        end = further;
+    }
+    return NO_START_MINUTE;  // On for a week or more without a gap
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::SimulationResult DS3231ControllerT<MaxSchedules, NameSize>::simulate(
+    const DateTime& from, const DateTime& to, const SimulationSink& sink) const {
+    SimulationResult result = {};
+    if (!from.isValid() || !to.isValid() || to.unixtime() <= from.unixtime()) {
+        return result;
+    }
+
+    // A private copy: the walk may be long, and the sink may change schedules
+    CompiledState state = _compiled.load();
+    simulateCompiled(state, minuteSince2000(from), minuteSince2000(to), sink, result);
+    return result;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::simulateCompiled(const CompiledState& state, uint32_t fromMinute,
+                                                                 uint32_t toMinute, const SimulationSink& sink,
+                                                                 SimulationResult& result) {
+    uint16_t edgeCount = state.edgeCount <= MAX_EDGES ? state.edgeCount : MAX_EDGES;
+    uint8_t windowCount = state.windowCount <= MAX_SCHEDULES ? state.windowCount : MAX_SCHEDULES;
+
+    auto emit = [&](SimulationEventType type, uint8_t id, uint32_t minute) {
+        result.events++;
+        if (sink) {
+            sink({type, id, static_cast<uint32_t>(SECONDS_FROM_1970_TO_2000 + minute * 60)});
+        }
+    };
+
+    // Window starts in time order from the weekly table, beginning a day
+    // early for windows that are still running at 'from'
+    uint32_t walkFrom = fromMinute > MINUTES_PER_DAY ? fromMinute - MINUTES_PER_DAY : 0;
+    int64_t weekBase = static_cast<int64_t>(walkFrom) - ((walkFrom / MINUTES_PER_DAY + 6) % 7) * MINUTES_PER_DAY -
+                       walkFrom % MINUTES_PER_DAY;  // 2000-01-01 was a Saturday
+    uint32_t position = 0;
+    auto nextStart = [&](uint8_t& window) -> uint32_t {
+        while (edgeCount > 0) {
+            const ScheduleEdge& edge = state.edges[position % edgeCount];
+            int64_t at = weekBase + static_cast<int64_t>(position / edgeCount) * MINUTES_PER_WEEK + edge.minuteOfWeek;
+            if (at >= toMinute) {
+                break;
+            }
+            position++;
+            if (at < walkFrom || edge.window >= windowCount) continue;
+            if (state.windows[edge.window].rule.matches(static_cast<uint16_t>(at / MINUTES_PER_DAY))) {
+                window = edge.window;
+                return static_cast<uint32_t>(at);
+            }
+        }
+        return NO_START_MINUTE;
+    };
+
+    // Pump exercise days; monthly matches are at least 28 days apart
+    uint32_t pumpDay = fromMinute / MINUTES_PER_DAY;
+    auto nextPump = [&]() -> uint32_t {
+        if (state.pump.duration == 0) {
+            return NO_START_MINUTE;
+        }
+        for (;; pumpDay++) {
+            uint32_t at = pumpDay * MINUTES_PER_DAY + state.pump.startOfDay;
+            if (at >= toMinute) {
+                return NO_START_MINUTE;
+            }
+            if (at >= fromMinute && state.pump.rule.matches(static_cast<uint16_t>(pumpDay))) {
+                pumpDay += 28;
+                return at;
+            }
+        }
+    };
+
+    // Vacation as minutes [vacationFrom, vacationUntil); the end date is inclusive
+    uint32_t vacationFrom = NO_START_MINUTE;
+    uint32_t vacationUntil = NO_START_MINUTE;
+    if (state.vacationEnabled && state.vacationEnd >= state.vacationStart &&
+        state.vacationEnd >= SECONDS_FROM_1970_TO_2000) {
+        vacationFrom = state.vacationStart > SECONDS_FROM_1970_TO_2000
+                           ? (state.vacationStart - SECONDS_FROM_1970_TO_2000 + 59) / 60 : 0;
+        vacationUntil = (state.vacationEnd - SECONDS_FROM_1970_TO_2000) / 60 + 1;
+    }
+
+    uint32_t endAt[MAX_SCHEDULES];  // End minute per running window, NO_START_MINUTE if idle
+    bool wasOn[MAX_SCHEDULES] = {};
+    for (uint8_t i = 0; i < windowCount; i++) {
+        endAt[i] = NO_START_MINUTE;
+    }
+    bool vacation = false;
+    bool heating = false;
+    uint8_t startWindow = 0;
+    uint32_t startMinute = nextStart(startWindow);
+    uint32_t pumpMinute = nextPump();
+    uint32_t lastMinute = fromMinute;
+
+    // One pass per minute that changes something, not per minute of the range
+    for (uint32_t minute = fromMinute; minute < toMinute;) {
+        if (heating) {
+            result.onMinutes += minute - lastMinute;
+        }
+        lastMinute = minute;
+
+        for (uint8_t i = 0; i < windowCount; i++) {
+            if (endAt[i] <= minute) {
+                endAt[i] = NO_START_MINUTE;
+            }
+        }
+        while (startMinute <= minute) {
+            uint32_t end = startMinute + state.windows[startWindow].duration;
+            if (end > minute) {
+                endAt[startWindow] = end;
+            }
+            startMinute = nextStart(startWindow);
+        }
+        bool nowVacation = minute >= vacationFrom && minute < vacationUntil;
+
+        // Ends, then the vacation edge, then starts, like the scheduler's pass
+        bool nowHeating = false;
+        for (uint8_t i = 0; i < windowCount; i++) {
+            bool on = endAt[i] != NO_START_MINUTE && !nowVacation;
+            nowHeating |= on;
+            if (wasOn[i] && !on) {
+                emit(SimulationEventType::ScheduleEnd, state.windows[i].id, minute);
+            }
+        }
+        if (heating && !nowHeating) {
+            emit(SimulationEventType::HeatingOff, 0, minute);
+        }
+        if (nowVacation != vacation) {
+            emit(nowVacation ? SimulationEventType::VacationStart : SimulationEventType::VacationEnd, 0, minute);
+        }
+        for (uint8_t i = 0; i < windowCount; i++) {
+            bool on = endAt[i] != NO_START_MINUTE && !nowVacation;
+            if (on && !wasOn[i]) {
+                emit(SimulationEventType::ScheduleStart, state.windows[i].id, minute);
+                result.scheduleStarts++;
+            }
+            wasOn[i] = on;
+        }
+        if (nowHeating && !heating) {
+            emit(SimulationEventType::HeatingOn, 0, minute);
+            result.heatingPeriods++;
+        }
+        heating = nowHeating;
+        vacation = nowVacation;
+
+        if (pumpMinute == minute) {
+            DateTime day = dateOfDay(static_cast<uint16_t>(minute / MINUTES_PER_DAY));
+            uint16_t month = static_cast<uint16_t>(day.year() * 12 + day.month());
+            if (month != state.pumpLastRunMonth && (!vacation || state.vacationRunsPump)) {
+                emit(SimulationEventType::PumpExercise, 0, minute);
+                result.pumpRuns++;
+            }
+            pumpMinute = nextPump();
+        }
+
+        // Skip to the next minute anything changes
+        uint32_t next = startMinute < pumpMinute ? startMinute : pumpMinute;
+        for (uint8_t i = 0; i < windowCount; i++) {
+            if (endAt[i] < next) {
+                next = endAt[i];
+            }
+        }
+        if (minute < vacationFrom) {
+            next = vacationFrom < next ? vacationFrom : next;
+        } else if (minute < vacationUntil) {
+            next = vacationUntil < next ? vacationUntil : next;
+        }
+        minute = next;
+    }
+
+    if (heating) {
+        result.onMinutes += toMinute - lastMinute;
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::setVacationMode(bool enabled, const DateTime& start, const DateTime& end) {
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setVacationMode()");
+        return;
+    }
+
+    _vacationMode.enabled = enabled;
+    _vacationMode.startDate = start;
+    _vacationMode.endDate = end;
+    _changes.dirtySections |= SCHEDULE_FLAG_VACATION;
+    markStoreDirty();
+    
+    DS3231_LOG_I("Vacation mode %s", enabled ? "enabled" : "disabled");
+    if (enabled) {
+        DS3231_LOG_I("Vacation period: %s to %s", 
+                     start.timestamp(DateTime::TIMESTAMP_DATE).c_str(),
+                     end.timestamp(DateTime::TIMESTAMP_DATE).c_str());
+    }
+
+    publishCompiledState();
+    notifyScheduler();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isVacationMode() const {
+    if (!_initialized) return false;
+
+    // Skip the time read entirely while vacation mode is off
+    if (!_compiled.read([](const CompiledState& state) { return state.vacationEnabled; })) {
+        return false;
+    }
+
+    DateTime current = now();
+    return _compiled.read([&current](const CompiledState& state) { return isVacationActiveAt(state, current); });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::setPumpExercise(bool enabled, uint8_t dayOfMonth, uint8_t hour,
+                                       uint8_t minute, uint16_t durationSeconds) {
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setPumpExercise()");
+        return;
+    }
+
+    _pumpExercise.enabled = enabled;
+    _pumpExercise.dayOfMonth = dayOfMonth;
+    _pumpExercise.hour = hour;
+    _pumpExercise.minute = minute;
+    _pumpExercise.durationSeconds = durationSeconds;
+    _changes.dirtySections |= SCHEDULE_FLAG_PUMP;
+    markStoreDirty();
+    publishCompiledState();
+
+    DS3231_LOG_I("Pump exercise %s: day %d at %02d:%02d for %d seconds",
+                 enabled ? "enabled" : "disabled", dayOfMonth, hour, minute, durationSeconds);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isPumpExerciseTime() const {
+    if (!_pumpExercise.enabled) return false;
+    if (!_initialized) return false;
+
+    // Same compiled pass as the schedules: one clock read, no mutex
+    return evaluateLockFree(scheduleNow()).pumpExerciseDue;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::markPumpExerciseComplete() {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for markPumpExerciseComplete()");
+        return;
+    }
+
+    _pumpExercise.lastRun = readTime();
+    _changes.dirtySections |= SCHEDULE_FLAG_PUMP;
+    markStoreDirty();
+    publishCompiledState();
+    DS3231_LOG_I("Pump exercise completed at %s",
+                 _pumpExercise.lastRun.timestamp(DateTime::TIMESTAMP_FULL).c_str());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::TemperatureData DS3231ControllerT<MaxSchedules, NameSize>::getTemperature() {
+    TemperatureData data;
+    data.celsius = 0.0f;
+    data.fahrenheit = 32.0f;
+
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return data;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Temperature);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for getTemperature()");
+        return data;
+    }
+
+    TemperatureSample sample;
+    if (!readTemperatureLocked(sample)) {
+        return data;
+    }
+
+    data.celsius = sample.celsius();
+    data.fahrenheit = data.celsius * 9.0 / 5.0 + 32.0;
+    data.timestamp = toWallClock(DateTime(sample.epoch));  // When the reading was taken
+
+    DS3231_LOG_D("Temperature: %.2f°C / %.2f°F", data.celsius, data.fahrenheit);
+
+    return data;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+float DS3231ControllerT<MaxSchedules, NameSize>::getTemperatureCelsius() {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return 0.0f;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Temperature);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for getTemperatureCelsius()");
+        return 0.0f;
+    }
+
+    TemperatureSample sample;
+    return readTemperatureLocked(sample) ? sample.celsius() : 0.0f;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::readTemperatureLocked(TemperatureSample& out) {
+    // The registers only change at the next conversion
+    if (!_temperature.valid ||
+        esp_timer_get_time() - _temperature.capturedUs >= TEMPERATURE_CONVERSION_PERIOD_MS * 1000LL) {
+        // Temperature and time come from the same burst read
+        RegisterSnapshot snapshot;
+        if (!currentSnapshot(snapshot)) {
+            return false;
+        }
+        noteTemperature(snapshot);  // No-op unless served from the snapshot cache
+    }
+
+    out = _temperature.sample;
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::forceTemperatureConversion(uint32_t timeoutMs) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    int64_t deadlineUs = esp_timer_get_time() + static_cast<int64_t>(timeoutMs) * 1000;
+    bool started = false;
+
+    // The bus is released between polls; a conversion takes up to 200 ms
+    for (;;) {
+        {
+            StatsGuard lock(_mutex, _stats, StatOp::Temperature);
+            if (!lock.hasLock()) {
+                DS3231_LOG_E("Failed to acquire mutex for forceTemperatureConversion()");
+                return false;
+            }
+
+            uint8_t regs[2];  // Control, status
+            if (!readRegisters(DS3231_REG_CONTROL, regs, sizeof(regs))) {
+                DS3231_LOG_E("Failed to read control/status");
+                return false;
+            }
+            bool busy = (regs[0] & DS3231_CONTROL_CONV) || (regs[1] & DS3231_STATUS_BSY);
+
+            if (started && !busy) {
+                _temperature.valid = false;  // Record the new value even if unchanged
+                RegisterSnapshot snapshot;
+                return readSnapshotLocked(snapshot);
+            }
+            // Setting CONV while BSY is set would queue a second conversion;
+            // a running one serves as ours
+            if (!busy && !writeRegister(DS3231_REG_CONTROL, regs[0] | DS3231_CONTROL_CONV)) {
+                DS3231_LOG_E("Failed to start temperature conversion");
+                return false;
+            }
+            started = true;
+        }
+
+        if (esp_timer_get_time() >= deadlineUs) {
+            DS3231_LOG_W("Temperature conversion timed out");
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(TEMPERATURE_POLL_MS));
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::clearTemperatureHistory() {
+    StatsGuard lock(_mutex, _stats, StatOp::Temperature);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for clearTemperatureHistory()");
+        return;
+    }
+    _temperatureHistory.clear();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setAlarmForNextSchedule() {
+    if (!_initialized || _timeSource) {
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Alarm);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setAlarmForNextSchedule()");
+        return false;
+    }
+
+    // Wake on whichever edge comes first, so an INT-driven board also
+    // wakes to switch off at the end of a window
+    DateTime scheduleNow = toScheduleClock(readRtcTime());
+    ScheduleEvaluation eval = evaluateAt(scheduleNow);
+    DateTime next = eval.nextStart;
+    if (eval.nextScheduleEnd.isValid() && (!next.isValid() || eval.nextScheduleEnd < next)) {
+        next = eval.nextScheduleEnd;
+    }
+
+    if (!next.isValid()) {
+        DS3231_LOG_W("No upcoming schedules to set alarm for");
+        return false;
+    }
+
+    // Alarm 1 matches day-of-month and time only, so an edge a month or more
+    // away would fire early on the first matching day. Arm a waypoint inside
+    // the horizon instead; the alarm handler re-arms from there
+    DateTime horizon = scheduleNow + TimeSpan(static_cast<int32_t>(ALARM1_HORIZON_SECONDS));
+    if (next > horizon) {
+        next = horizon;
+    }
+    return setAlarm1(next, true);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setAlarm1(const DateTime& dt, bool matchSeconds) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    if (_timeSource) {
+        DS3231_LOG_E("No RTC of its own - controller follows a time source");
+        return false;
+    }
+
+    if (!dt.isValid()) {
+        DS3231_LOG_E("Invalid DateTime for Alarm 1");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Alarm);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setAlarm1()");
+        return false;
+    }
+
+    char timestamp[TIMESTAMP_SIZE];
+    formatTimestamp(dt, timestamp, sizeof(timestamp));
+    DS3231_LOG_I("Setting Alarm 1 for %s", timestamp);
+
+    // RTClib refuses to arm the alarm while INT/SQW is in square-wave mode
+    DateTime rtcTime = toRtcTime(dt);
+    bool armed = matchSeconds ? activeRtc().setAlarm1(rtcTime, DS3231_A1_Date)
+                              : activeRtc().setAlarm1(rtcTime, DS3231_A1_Hour);
+    if (!armed) {
+        DS3231_LOG_E("Alarm 1 not armed - INT/SQW pin is in square-wave mode");
+    }
+
+    return armed;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::clearAlarm(uint8_t alarmNumber) {
+    if (!_initialized || _timeSource) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Alarm);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for clearAlarm()");
+        return;
+    }
+
+    activeRtc().clearAlarm(alarmNumber);
+    DS3231_LOG_D("Cleared alarm %d", alarmNumber);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isAlarmFired(uint8_t alarmNumber) {
+    if (!_initialized || _timeSource) {
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Alarm);
+    if (!lock.hasLock()) {
+        return false;
+    }
+
+    return activeRtc().alarmFired(alarmNumber);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::acknowledgeAlarm(uint8_t alarmNumber) {
+    if (!_initialized || _timeSource) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return;
+    }
+
+    DateTime at;
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::Alarm);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for acknowledgeAlarm()");
+            return;
+        }
+
+        activeRtc().clearAlarm(alarmNumber);
+        at = toWallClock(cachedTime());
+    }
+
+    DS3231_LOG_D("Acknowledged alarm %d", alarmNumber);
+    emitEvent(EventType::AlarmFired, at.isValid() ? at.unixtime() : 0, 0, alarmNumber);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::getFormattedTime(char* buffer, size_t size) const {
+    int n;
+    if (!_initialized) {
+        n = snprintf(buffer, size, "--:--:--");
+    } else {
+        DateTime now = this->now();
+        n = snprintf(buffer, size, "%02d:%02d:%02d", now.hour(), now.minute(), now.second());
+    }
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+String DS3231ControllerT<MaxSchedules, NameSize>::getFormattedTime() const {
+    char buffer[FORMATTED_TIME_SIZE];
+    getFormattedTime(buffer, sizeof(buffer));
+    return String(buffer);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::getFormattedDate(char* buffer, size_t size) const {
+    int n;
+    if (!_initialized) {
+        n = snprintf(buffer, size, "----/--/--");
+    } else {
+        DateTime now = this->now();
+        n = snprintf(buffer, size, "%04d-%02d-%02d", now.year(), now.month(), now.day());
+    }
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+String DS3231ControllerT<MaxSchedules, NameSize>::getFormattedDate() const {
+    char buffer[FORMATTED_DATE_SIZE];
+    getFormattedDate(buffer, sizeof(buffer));
+    return String(buffer);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::getScheduleStatus(char* buffer, size_t size) const {
+    static const char* const kNoSchedules = "No Active Schedules";
+    int n;
+    if (!_initialized) {
+        n = snprintf(buffer, size, "%s", kNoSchedules);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        n = snprintf(buffer, size, "%s", kNoSchedules);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    ScheduleEvaluation eval = evaluateAt(toScheduleClock(readRtcTime()));
+
+    if (eval.vacationActive) {
+        n = snprintf(buffer, size, "Vacation Mode Active");
+    } else if (eval.active) {
+        n = snprintf(buffer, size, "Active: %s", eval.active->name.c_str());
+    } else if (eval.nextStart.isValid()) {
+        n = snprintf(buffer, size, "Next: %02d:%02d:%02d",
+                     eval.nextStart.hour(), eval.nextStart.minute(), eval.nextStart.second());
+    } else {
+        n = snprintf(buffer, size, "%s", kNoSchedules);
+    }
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+String DS3231ControllerT<MaxSchedules, NameSize>::getScheduleStatus() const {
+    char buffer[SCHEDULE_STATUS_SIZE];
+    size_t length = getScheduleStatus(buffer, sizeof(buffer));
+    if (length < sizeof(buffer)) {
+        return String(buffer);
+    }
+
+    // Heap-stored names can outgrow the slot size
+    std::vector<char> longer(length + 1);
+    getScheduleStatus(longer.data(), longer.size());
+    return String(longer.data());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::printDiagnostics() {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for printDiagnostics()");
+        return;
+    }
+
+    RegisterSnapshot snapshot;
+    if (!currentSnapshot(snapshot)) {
+        DS3231_LOG_E("Failed to read DS3231 registers");
+        return;
+    }
+
+    DS3231_LOG_I("=== DS3231 Diagnostics ===");
+    char timestamp[TIMESTAMP_SIZE];
+    formatTimestamp(snapshot.time, timestamp, sizeof(timestamp));
+    DS3231_LOG_I("Current Time: %s", timestamp);
+    DS3231_LOG_I("Temperature: %.2f°C", snapshot.temperatureC);
+    DS3231_LOG_I("Control: 0x%02X, Status: 0x%02X, Aging: %d", snapshot.control, snapshot.status,
+                 snapshot.agingOffset);
+    DS3231_LOG_I("Oscillator Stopped: %s", snapshot.oscillatorStopped() ? "YES" : "no");
+    DS3231_LOG_I("Total Schedules: %d", _schedules.size());
+
+    for (const auto& schedule : _schedules) {
+        DS3231_LOG_I("  Schedule %d '%s': %s, %02d:%02d-%02d:%02d, days=%s",
+                     schedule.id, schedule.name.c_str(),
+                     schedule.enabled ? "ON" : "OFF",
+                     schedule.startHour, schedule.startMinute,
+                     schedule.endHour, schedule.endMinute,
+                     dayMaskText(schedule.dayMask));
+    }
+
+    DS3231_LOG_I("Vacation Mode: %s", _vacationMode.enabled ? "ON" : "OFF");
+    DS3231_LOG_I("Pump Exercise: %s", _pumpExercise.enabled ? "ON" : "OFF");
+    char status[SCHEDULE_STATUS_SIZE];
+    getScheduleStatus(status, sizeof(status));
+    DS3231_LOG_I("Current Status: %s", status);
+#ifdef DS3231_STATS
+    const Stats& stats = _stats.stats();
+    for (uint8_t i = 0; i < Stats::OP_COUNT; i++) {
+        const Stats::OpStats& op = stats.ops[i];
+        if (op.calls == 0) {
+            continue;
+        }
+        DS3231_LOG_I("  %s: %lu calls, %lu lock failures, max wait %lu us, last error %s",
+                     Stats::opName(static_cast<StatOp>(i)), static_cast<unsigned long>(op.calls),
+                     static_cast<unsigned long>(op.lockFailures), static_cast<unsigned long>(op.maxWaitUs),
+                     Stats::errorName(static_cast<StatError>(op.lastError)));
+    }
+    DS3231_LOG_I("I2C: %lu transfers, %lu/%lu NACK (addr/data), %lu timeouts, %lu other, %lu short reads; "
+                 "%lu RTClib reads",
+                 static_cast<unsigned long>(stats.i2cTransactions), static_cast<unsigned long>(stats.i2cAddressNacks),
+                 static_cast<unsigned long>(stats.i2cDataNacks), static_cast<unsigned long>(stats.i2cTimeouts),
+                 static_cast<unsigned long>(stats.i2cOtherErrors), static_cast<unsigned long>(stats.i2cShortReads),
+                 static_cast<unsigned long>(stats.rtclibReads));
+#endif
+    DS3231_LOG_I("==========================");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint8_t DS3231ControllerT<MaxSchedules, NameSize>::getNextFreeScheduleId() const {
+    uint8_t id = 1;
+    bool found;
+    
+    do {
+        found = false;
+        for (const auto& schedule : _schedules) {
+            if (schedule.id == id) {
+                found = true;
+                id++;
+                break;
+            }
+        }
+    } while (found && id < 255);
+    
+    return id;
+}
+
+// Asynchronous bus worker
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::startBusWorker(uint8_t queueDepth, UBaseType_t priority, BaseType_t core, uint32_t stackSize) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    RecursiveMutexGuard gate(_busGate);
+    if (!gate.hasLock()) {
+        DS3231_LOG_E("Failed to acquire bus gate for startBusWorker()");
+        return false;
+    }
+
+    if (_busTask) {
+        DS3231_LOG_D("Bus worker already running");
+        return true;
+    }
+    if (_busPendingQueue) {
+        DS3231_LOG_W("Bus worker still stopping");
+        return false;
+    }
+
+    if (queueDepth == 0 || queueDepth > MAX_BUS_QUEUE_DEPTH) {
+        queueDepth = MAX_BUS_QUEUE_DEPTH;
+    }
+
+    _busFreeQueue = xQueueCreate(queueDepth, sizeof(uint8_t));
+    _busPendingQueue = xQueueCreate(queueDepth + 1, sizeof(uint8_t));  // +1 for the stop request
+    _busExited = xSemaphoreCreateBinary();
+    if (!_busFreeQueue || !_busPendingQueue || !_busExited) {
+        DS3231_LOG_E("Failed to create bus queues");
+        releaseBusQueues();
+        return false;
+    }
+    for (uint8_t slot = 0; slot < queueDepth; slot++) {
+        xQueueSend(_busFreeQueue, &slot, 0);
+    }
+
+    TaskHandle_t task = nullptr;
+    BaseType_t result = xTaskCreatePinnedToCore(busTaskEntry, "ds3231_bus", stackSize,
+                                                this, priority, &task, core);
+    if (result != pdPASS) {
+        DS3231_LOG_E("Failed to create bus worker task");
+        releaseBusQueues();
+        return false;
+    }
+    _busTask = task;
+
+    DS3231_LOG_I("Bus worker started (%u slots)", static_cast<unsigned>(queueDepth));
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::stopBusWorker() {
+    TaskHandle_t task;
+    {
+        RecursiveMutexGuard gate(_busGate);
+        if (!gate.hasLock()) {
+            DS3231_LOG_E("Failed to acquire bus gate for stopBusWorker()");
+            return;
+        }
+
+        task = _busTask;
+        if (!task) {
+            return;
+        }
+        if (task == xTaskGetCurrentTaskHandle()) {
+            DS3231_LOG_E("stopBusWorker() called from the bus worker");
+            return;
+        }
+
+        // queueBusRequest() refuses new work from here on. The stop request
+        // queues behind pending requests, so those still complete, and always
+        // fits: the pending queue has one more entry than there are slots
+        _busTask = nullptr;
+        uint8_t stop = BUS_STOP_REQUEST;
+        xQueueSend(_busPendingQueue, &stop, portMAX_DELAY);
+    }
+
+    // Wait outside the gate, so requests queued from running work fail fast
+    // instead of deadlocking. The task touches no queue once it has given this
+    xSemaphoreTake(_busExited, portMAX_DELAY);
+
+    RecursiveMutexGuard gate(_busGate);
+    releaseBusQueues();
+    DS3231_LOG_I("Bus worker stopped");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::releaseBusQueues() {
+    if (_busPendingQueue) {
+        vQueueDelete(_busPendingQueue);
+        _busPendingQueue = nullptr;
+    }
+    if (_busFreeQueue) {
+        vQueueDelete(_busFreeQueue);
+        _busFreeQueue = nullptr;
+    }
+    if (_busExited) {
+        vSemaphoreDelete(_busExited);
+        _busExited = nullptr;
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::nowAsync(AsyncTimeCallback onDone, AsyncHandle* handle) {
+    AsyncHandle queued = queueBusRequest([this, onDone]() {
+        RegisterSnapshot snapshot;
+        bool ok = readSnapshot(snapshot);
+        if (onDone) {
+            onDone(ok, ok ? toWallClock(snapshot.time) : kInvalidTime);
+        }
+        return ok;
+    });
+    if (handle) {
+        *handle = queued;
+    }
+    return toWallClock(cachedTime());
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::RegisterSnapshot DS3231ControllerT<MaxSchedules, NameSize>::readSnapshotAsync(AsyncSnapshotCallback onDone, AsyncHandle* handle) {
+    AsyncHandle queued = queueBusRequest([this, onDone]() {
+        RegisterSnapshot snapshot = {};
+        bool ok = readSnapshot(snapshot);
+        if (onDone) {
+            onDone(ok, snapshot);
+        }
+        return ok;
+    });
+    if (handle) {
+        *handle = queued;
+    }
+    return _snapshot.load();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::AsyncHandle DS3231ControllerT<MaxSchedules, NameSize>::setAlarm1Async(const DateTime& dt, bool matchSeconds,
+                                                           AsyncResultCallback onDone) {
+    return queueBusRequest([this, dt, matchSeconds, onDone]() {
+        bool ok = setAlarm1(dt, matchSeconds);
+        if (onDone) {
+            onDone(ok);
+        }
+        return ok;
+    });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::AsyncHandle DS3231ControllerT<MaxSchedules, NameSize>::submitBusJob(BusJob job, AsyncResultCallback onDone) {
+    if (!job) {
+        return AsyncHandle();
+    }
+
+    return queueBusRequest([this, job, onDone]() {
+        bool ok = false;
+        {
+            StatsGuard lock(_mutex, _stats, StatOp::BusJob);
+            if (lock.hasLock() && _wire) {
+                ok = job(*_wire);
+            } else {
+                DS3231_LOG_E("Failed to acquire bus for queued job");
+            }
+        }
+        if (onDone) {
+            onDone(ok);
+        }
+        return ok;
+    });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::AsyncStatus DS3231ControllerT<MaxSchedules, NameSize>::getAsyncStatus(const AsyncHandle& handle) const {
+    if (!handle.isValid() || handle.slot >= MAX_BUS_QUEUE_DEPTH) {
+        return AsyncStatus::Invalid;
+    }
+
+    const BusRequest& request = _busRequests[handle.slot];
+    uint32_t result = request.result.load(std::memory_order_acquire);
+    if ((result >> 1) == handle.ticket) {
+        return (result & 1) ? AsyncStatus::Succeeded : AsyncStatus::Failed;
+    }
+    return request.ticket.load(std::memory_order_acquire) == handle.ticket ? AsyncStatus::Pending
+                                                                           : AsyncStatus::Expired;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::AsyncStatus DS3231ControllerT<MaxSchedules, NameSize>::waitAsync(const AsyncHandle& handle, uint32_t timeoutMs) const {
+    TickType_t start = xTaskGetTickCount();
+    AsyncStatus status = getAsyncStatus(handle);
+    while (status == AsyncStatus::Pending && (xTaskGetTickCount() - start) < pdMS_TO_TICKS(timeoutMs)) {
+        vTaskDelay(1);
+        status = getAsyncStatus(handle);
+    }
+    return status;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DateTime DS3231ControllerT<MaxSchedules, NameSize>::cachedTime() const {
+    ClockState clock = _clock.load();
+    if (!clock.anchor.valid) {
+        return kInvalidTime;
+    }
+
+    int64_t elapsedUs = esp_timer_get_time() - clock.anchor.micros;
+    int64_t correctedUs = elapsedUs + static_cast<int64_t>(elapsedUs * (clock.driftPpm * 1e-6f));
+    return DateTime(clock.anchor.epoch + static_cast<uint32_t>(correctedUs / 1000000LL));
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::AsyncHandle DS3231ControllerT<MaxSchedules, NameSize>::queueBusRequest(std::function<bool()> work) {
+    AsyncHandle handle;
+    RecursiveMutexGuard gate(_busGate);
+    if (!gate.hasLock()) {
+        DS3231_LOG_E("Failed to acquire bus gate for queueBusRequest()");
+        return handle;
+    }
+    if (!_busTask) {
+        DS3231_LOG_W("Bus worker not running - call startBusWorker() first");
+        return handle;
+    }
+
+    uint8_t slot;
+    if (xQueueReceive(_busFreeQueue, &slot, 0) != pdTRUE) {
+        DS3231_LOG_W("Bus queue full, request dropped");
+        return handle;
+    }
+
+    // 31-bit tickets (the result word keeps one bit for ok); never 0
+    uint32_t ticket;
+    do {
+        ticket = _busNextTicket.fetch_add(1) & 0x7FFFFFFFu;
+    } while (ticket == 0);
+
+    BusRequest& request = _busRequests[slot];
+    request.work = std::move(work);
+    request.ticket.store(ticket, std::memory_order_release);
+    xQueueSend(_busPendingQueue, &slot, 0);  // Never full while we hold a free slot
+
+    handle.ticket = ticket;
+    handle.slot = slot;
+    return handle;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::runBusRequest(uint8_t slot) {
+    BusRequest& request = _busRequests[slot];
+    uint32_t ticket = request.ticket.load(std::memory_order_acquire);
+
+    bool ok = request.work && request.work();
+    request.work = nullptr;  // Release captures before the slot is reused
+
+    request.result.store((ticket << 1) | (ok ? 1u : 0u), std::memory_order_release);
+    xQueueSend(_busFreeQueue, &slot, 0);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::busTaskEntry(void* arg) {
+    static_cast<DS3231ControllerT*>(arg)->busWorkerLoop();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::busWorkerLoop() {
+    DS3231_LOG_D("Bus worker running");
+
+    uint8_t slot;
+    while (xQueueReceive(_busPendingQueue, &slot, portMAX_DELAY) == pdTRUE) {
+        if (slot == BUS_STOP_REQUEST) {
+            break;
+        }
+        if (slot < MAX_BUS_QUEUE_DEPTH) {
+            runBusRequest(slot);
+        }
+    }
+
+    // stopBusWorker() cleared _busTask and deletes the queues once this is given
+    xSemaphoreGive(_busExited);
+    vTaskDelete(nullptr);
+}
+
+// Event-driven scheduler
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::startScheduler(UBaseType_t priority, BaseType_t core, uint32_t stackSize) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    if (_schedulerTask) {
+        DS3231_LOG_D("Scheduler already running");
+        return true;
+    }
+
+    _schedulerStopping = false;
+    _schedulerExited = xSemaphoreCreateBinary();
+    TaskHandle_t task = nullptr;
+    BaseType_t result = pdFAIL;
+    if (_schedulerExited) {
+        result = xTaskCreatePinnedToCore(schedulerTaskEntry, "ds3231_sched", stackSize,
+                                         this, priority, &task, core);
+    }
+    if (result != pdPASS) {
+        DS3231_LOG_E("Failed to create scheduler task");
+        if (_schedulerExited) {
+            vSemaphoreDelete(_schedulerExited);
+            _schedulerExited = nullptr;
+        }
+        return false;
+    }
+    _schedulerTask = task;
+
+    DS3231_LOG_I("Scheduler started (priority %u)", static_cast<unsigned>(priority));
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::stopScheduler() {
+    TaskHandle_t task = _schedulerTask;
+    if (!task) {
+        return;
+    }
+
+    if (task == xTaskGetCurrentTaskHandle()) {
+        DS3231_LOG_E("stopScheduler() called from the scheduler task");
+        return;
+    }
+
+    _schedulerStopping = true;
+    _schedulerTask = nullptr;  // The alarm ISR stops notifying it
+    xTaskNotify(task, NOTIFY_STOP, eSetBits);
+
+    // Callbacks may run on the task, so wait however long the current one takes
+    xSemaphoreTake(_schedulerExited, portMAX_DELAY);
+    vSemaphoreDelete(_schedulerExited);
+    _schedulerExited = nullptr;
+
+    DS3231_LOG_I("Scheduler stopped");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::notifyScheduler() {
+    TaskHandle_t task = _schedulerTask;
+    if (task && task != xTaskGetCurrentTaskHandle()) {
+        xTaskNotify(task, NOTIFY_RESCHEDULE, eSetBits);
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::schedulerTaskEntry(void* arg) {
+    static_cast<DS3231ControllerT*>(arg)->schedulerLoop();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::schedulerLoop() {
+    while (!_schedulerStopping) {
+        uint32_t waitSeconds = checkScheduleTransitions();
+
+        // Alarm flags can only be polled when INT does not reach the GPIO (no
+        // pin, the pin carries the square wave, or the secondary is active),
+        // so keep the poll interval short only when someone is listening
+        if (_alarmCallback && (_interruptPin < 0 || _edgePin == _interruptPin || _onSecondary)) {
+            checkAlarms();
+            if (waitSeconds > SCHEDULE_CHECK_INTERVAL_SECONDS) {
+                waitSeconds = SCHEDULE_CHECK_INTERVAL_SECONDS;
+            }
+        }
+
+        if (waitSeconds > SCHEDULER_MAX_SLEEP_SECONDS) {
+            waitSeconds = SCHEDULER_MAX_SLEEP_SECONDS;
+        }
+
+        // Wake slightly after the edge so the RTC already reports the new minute
+        TickType_t waitTicks = pdMS_TO_TICKS(waitSeconds * 1000UL + SCHEDULER_EDGE_MARGIN_MS);
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, 0xFFFFFFFF, &bits, waitTicks);
+
+        if (bits & NOTIFY_STOP) {
+            break;
+        }
+
+        if (bits & NOTIFY_ALARM) {
+            handleAlarmInterrupt();
+        }
+    }
+
+    // stopScheduler() cleared _schedulerTask and returns once this is given
+    xSemaphoreGive(_schedulerExited);
+    vTaskDelete(nullptr);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint32_t DS3231ControllerT<MaxSchedules, NameSize>::checkScheduleTransitions() {
+    Schedule pending[MAX_SCHEDULES];
+    bool pendingStart[MAX_SCHEDULES];
+    uint8_t pendingCount = 0;
+    uint32_t secondsToNext = SCHEDULER_MAX_SLEEP_SECONDS;
+    uint32_t edgeTime = 0;
+    bool offsetChanged = false;
+    int32_t utcOffset = 0;
+
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::Events);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for checkScheduleTransitions()");
+            return SCHEDULE_CHECK_INTERVAL_SECONDS;
+        }
+
+        DateTime rtcTime = readRtcTime();
+        if (!rtcTime.isValid()) {
+            return SCHEDULE_CHECK_INTERVAL_SECONDS;
+        }
+
+        DateTime now = toScheduleClock(rtcTime);
+        ScheduleEvaluation eval = evaluateAt(now);
+
+        uint8_t nowActive[MAX_SCHEDULES];
+        uint8_t nowActiveCount = 0;
+
+        for (const auto& schedule : _schedules) {
+            bool active = !eval.vacationActive && isScheduleActiveAt(schedule, now);
+            bool wasActive = false;
+            for (uint8_t i = 0; i < _activeCount; i++) {
+                if (_activeIds[i] == schedule.id) {
+                    wasActive = true;
+                    break;
+                }
+            }
+
+            if (active) {
+                nowActive[nowActiveCount++] = schedule.id;
+            }
+
+            if (active != wasActive) {
+                pending[pendingCount] = schedule;
+                pendingStart[pendingCount] = active;
+                pendingCount++;
+            }
+        }
+
+        // Schedules removed while active end without a callback: their data is gone
+        memcpy(_activeIds, nowActive, nowActiveCount);
+        _activeCount = nowActiveCount;
+        _lastCheck = now;
+        edgeTime = toWallClock(rtcTime).unixtime();
+
+        // DST changes are events too; sleep no further than the next one
+        if (_timeZoneEnabled) {
+            uint32_t utc = rtcTime.unixtime();
+            utcOffset = _timeZone.read([utc](const DS3231TimeZone& tz) { return tz.offsetAt(utc); });
+            offsetChanged = _utcOffsetKnown && utcOffset != _lastUtcOffset;
+            _lastUtcOffset = utcOffset;
+            _utcOffsetKnown = true;
+
+            uint32_t transition = _timeZone.read([utc](const DS3231TimeZone& tz) { return tz.nextTransitionAfter(utc); });
+            if (transition > utc && transition - utc < secondsToNext) {
+                secondsToNext = transition - utc;
+            }
+        }
+
+        // Sleep in real seconds; the edges are local times
+        auto consider = [&](const DateTime& localAt) {
+            DateTime at = toRtcTime(localAt);
+            if (at.isValid() && at > rtcTime) {
+                uint32_t delta = at.unixtime() - rtcTime.unixtime();
+                if (delta < secondsToNext) {
+                    secondsToNext = delta;
+                }
+            }
+        };
+        consider(eval.nextStart);
+        consider(eval.nextScheduleEnd);  // Every schedule's own end has a callback
+        if (_vacationMode.enabled) {
+            consider(_vacationMode.startDate);
+            consider(_vacationMode.endDate + TimeSpan(1));  // End date is inclusive
+        }
+    }
+
+    // Dispatch outside the lock so slow callbacks don't stall other users
+    if (offsetChanged) {
+        DS3231_LOG_I("UTC offset now %ld s", static_cast<long>(utcOffset));
+        emitEvent(EventType::DstTransition, edgeTime, 0, 0, utcOffset);
+    }
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        DS3231_LOG_D("Schedule %d '%s' %s", pending[i].id, pending[i].name.c_str(),
+                     pendingStart[i] ? "started" : "ended");
+        Event event = {};
+        event.type = pendingStart[i] ? EventType::ScheduleStart : EventType::ScheduleEnd;
+        event.scheduleId = pending[i].id;
+        event.time = edgeTime;
+        emitEvent(event, &pending[i]);
+    }
+
+    return secondsToNext;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::enableEventQueue(uint8_t queueDepth) {
+    if (_eventQueue) {
+        return true;
+    }
+
+    if (queueDepth == 0 || queueDepth > MAX_EVENT_QUEUE_DEPTH) {
+        queueDepth = MAX_EVENT_QUEUE_DEPTH;
+    }
+
+    QueueHandle_t queue = xQueueCreate(queueDepth + 1, sizeof(Event));  // +1 for the stop request
+    if (!queue) {
+        DS3231_LOG_E("Failed to create event queue");
+        return false;
+    }
+    _eventQueue = queue;
+
+    DS3231_LOG_I("Event queue enabled (%u slots)", static_cast<unsigned>(queueDepth));
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::startEventDispatcher(uint8_t queueDepth, UBaseType_t priority,
+                                                                     BaseType_t core, uint32_t stackSize) {
+    if (_eventTask) {
+        DS3231_LOG_D("Event dispatcher already running");
+        return true;
+    }
+
+    bool created = !_eventQueue;
+    if (!enableEventQueue(queueDepth)) {
+        return false;
+    }
+
+    _eventExited = xSemaphoreCreateBinary();
+    TaskHandle_t task = nullptr;
+    BaseType_t result = pdFAIL;
+    if (_eventExited) {
+        result = xTaskCreatePinnedToCore(eventTaskEntry, "ds3231_events", stackSize,
+                                         this, priority, &task, core);
+    }
+    if (result != pdPASS) {
+        DS3231_LOG_E("Failed to create event dispatcher task");
+        if (_eventExited) {
+            vSemaphoreDelete(_eventExited);
+            _eventExited = nullptr;
+        }
+        if (created) {
+            stopEventDispatcher();
+        }
+        return false;
+    }
+    _eventTask = task;
+
+    DS3231_LOG_I("Event dispatcher started");
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::stopEventDispatcher() {
+    QueueHandle_t queue = _eventQueue;
+    if (!queue) {
+        return;
+    }
+
+    TaskHandle_t task = _eventTask;
+    if (task) {
+        if (task == xTaskGetCurrentTaskHandle()) {
+            DS3231_LOG_E("stopEventDispatcher() called from an event callback");
+            return;
+        }
+
+        // Queued behind pending events, so those still dispatch
+        _eventTask = nullptr;
+        Event stop = {};
+        stop.type = EVENT_STOP;
+        xQueueSend(queue, &stop, portMAX_DELAY);
+
+        // The task touches no queue once it has given this
+        xSemaphoreTake(_eventExited, portMAX_DELAY);
+        vSemaphoreDelete(_eventExited);
+        _eventExited = nullptr;
+        DS3231_LOG_I("Event dispatcher stopped");
+    } else {
+        (void)dispatchEvents();
+    }
+
+    // Later events dispatch in place again
+    _eventQueue = nullptr;
+    vQueueDelete(queue);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint8_t DS3231ControllerT<MaxSchedules, NameSize>::dispatchEvents(uint32_t timeoutMs) {
+    QueueHandle_t queue = _eventQueue;
+    if (!queue) {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    Event event;
+    TickType_t wait = pdMS_TO_TICKS(timeoutMs);
+    while (count < MAX_EVENT_QUEUE_DEPTH && xQueueReceive(queue, &event, wait) == pdTRUE) {
+        if (event.type == EVENT_STOP) {
+            continue;  // Meant for a dispatcher task that is gone
+        }
+        dispatchEvent(event);
+        count++;
+        wait = 0;
+    }
+    return count;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::eventTaskEntry(void* arg) {
+    static_cast<DS3231ControllerT*>(arg)->eventLoop();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::eventLoop() {
+    Event event;
+    while (xQueueReceive(_eventQueue, &event, portMAX_DELAY) == pdTRUE) {
+        if (event.type == EVENT_STOP) {
+            break;
+        }
+        dispatchEvent(event);
+    }
+
+    // stopEventDispatcher() cleared _eventTask and deletes the queue once this is given
+    xSemaphoreGive(_eventExited);
+    vTaskDelete(nullptr);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::emitEvent(EventType type, uint32_t time, uint8_t scheduleId,
+                                                          uint8_t alarmNumber, int32_t utcOffset) {
+    Event event = {};
+    event.type = type;
+    event.scheduleId = scheduleId;
+    event.alarmNumber = alarmNumber;
+    event.utcOffset = utcOffset;
+    event.time = time;
+    emitEvent(event);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::emitEvent(const Event& event, const Schedule* schedule) {
+    QueueHandle_t queue = _eventQueue;
+    if (!queue) {
+        dispatchEvent(event, schedule);
+        return;
+    }
+
+    // Never wait: the control path must not block on a slow dispatcher
+    if (xQueueSend(queue, &event, 0) != pdTRUE) {
+        _droppedEvents++;
+        DS3231_LOG_W("Event queue full - event %u dropped", static_cast<unsigned>(event.type));
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::dispatchEvent(const Event& event, const Schedule* schedule) {
+    switch (event.type) {
+        case EventType::ScheduleStart:
+        case EventType::ScheduleEnd: {
+            if (!_scheduleCallback) {
+                break;
+            }
+            if (schedule) {
+                _scheduleCallback(*schedule, event.type == EventType::ScheduleStart);
+                break;
+            }
+
+            // Queued by id: copy the schedule, then call without the lock
+            Schedule current;
+            bool found = false;
+            {
+                StatsGuard lock(_mutex, _stats, StatOp::Events);
+                if (!lock.hasLock()) {
+                    DS3231_LOG_E("Failed to acquire mutex for event dispatch");
+                    break;
+                }
+                for (const auto& candidate : _schedules) {
+                    if (candidate.id == event.scheduleId) {
+                        current = candidate;
+                        found = true;
+                        break;
+                    }
+                }
+            }
+            if (found) {
+                _scheduleCallback(current, event.type == EventType::ScheduleStart);
+            }
+            break;
+        }
+        case EventType::AlarmFired:
+            if (_alarmCallback) {
+                _alarmCallback(event.alarmNumber);
+            }
+            break;
+        case EventType::TimeChanged:
+            if (_timeChangeCallback) {
+                _timeChangeCallback(DateTime(event.time));
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (_eventCallback) {
+        _eventCallback(event);
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::checkAlarms() {
+    for (uint8_t alarm = ALARM_1; alarm <= ALARM_2; alarm++) {
+        if (isAlarmFired(alarm)) {
+            acknowledgeAlarm(alarm);
+            if (alarm == ALARM_1) {
+                // Alarm 1 tracks schedule starts; arm it for the following one
+                (void)setAlarmForNextSchedule();
+            }
+        }
+    }
+}
+
+// Persistence methods
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::getScheduleDataSize() const {
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (!lock.hasLock()) {
+        return MAX_SCHEDULE_DATA_SIZE;
+    }
+    return encodeSchedules(nullptr, false);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::encodeSchedules(uint8_t* buffer, bool delta) const {
+    // Sizing and writing share one pass so they can never disagree
+    size_t offset = 0;
+    auto put = [buffer, &offset](uint8_t value) {
+        if (buffer) buffer[offset] = value;
+        offset++;
+    };
+    auto put16 = [&put](uint16_t value) { put(value); put(value >> 8); };
+    auto put32 = [&put16](uint32_t value) { put16(value); put16(value >> 16); };
+    auto epochOf = [](const DateTime& dt) -> uint32_t { return dt.isValid() ? dt.unixtime() : 0; };
+
+    uint32_t currentIds[8] = {};
+    uint8_t recordCount = 0;
+    bool anyRule = false;
+    for (const auto& schedule : _schedules) {
+        ChangeSet::insert(currentIds, schedule.id);
+        if (!delta || ChangeSet::contains(_changes.dirtyIds, schedule.id)) {
+            recordCount++;
+            anyRule |= schedule.hasRule();
+        }
+    }
+
+    uint8_t flags = delta ? (SCHEDULE_FLAG_DELTA | _changes.dirtySections)
+                          : (SCHEDULE_FLAG_VACATION | SCHEDULE_FLAG_PUMP);
+    put(SCHEDULE_FORMAT_MAGIC_0);
+    put(SCHEDULE_FORMAT_MAGIC_1);
+    put(anyRule ? SCHEDULE_FORMAT_V3 : SCHEDULE_FORMAT_V2);
+    put(flags);
+    put(recordCount);
+
+    if (delta) {
+        size_t countOffset = offset;
+        uint8_t removedCount = 0;
+        put(0);
+        for (uint16_t id = 0; id < 256; id++) {
+            if (ChangeSet::contains(_changes.persistedIds, id) && !ChangeSet::contains(currentIds, id)) {
+                put(id);
+                removedCount++;
+            }
+        }
+        if (buffer) buffer[countOffset] = removedCount;
+    }
+
+    for (const auto& schedule : _schedules) {
+        if (delta && !ChangeSet::contains(_changes.dirtyIds, schedule.id)) {
+            continue;
+        }
+        uint32_t startOfDay = schedule.startHour * 60 + schedule.startMinute;
+        uint32_t endOfDay = schedule.endHour * 60 + schedule.endMinute;
+        uint32_t packed = (startOfDay & 0x7FF) | ((endOfDay & 0x7FF) << 11) |
+                          (schedule.hasRule() ? SCHEDULE_RECORD_RULE_BIT : 0);
+        put(schedule.id);
+        put((schedule.dayMask & 0x7F) | (schedule.enabled ? 0x80 : 0));
+        put(packed);
+        put(packed >> 8);
+        put(packed >> 16);
+
+        size_t nameLen = schedule.name.length();
+        if (nameLen > SCHEDULE_NAME_SIZE - 1) nameLen = SCHEDULE_NAME_SIZE - 1;
+        put(nameLen);
+        const char* name = schedule.name.c_str();
+        for (size_t i = 0; i < nameLen; i++) {
+            put(name[i]);
+        }
+
+        if (schedule.hasRule()) {
+            put(static_cast<uint8_t>(schedule.recurrence));
+            put(schedule.interval);
+            put16(schedule.firstDay);
+            put16(schedule.lastDay);
+        }
+    }
+
+    if (flags & SCHEDULE_FLAG_VACATION) {
+        put((_vacationMode.enabled ? 0x01 : 0) | (_vacationMode.runPumpExercise ? 0x02 : 0));
+        put32(epochOf(_vacationMode.startDate));
+        put32(epochOf(_vacationMode.endDate));
+    }
+
+    if (flags & SCHEDULE_FLAG_PUMP) {
+        put(_pumpExercise.enabled ? 1 : 0);
+        put(_pumpExercise.dayOfMonth);
+        put(_pumpExercise.hour);
+        put(_pumpExercise.minute);
+        put16(_pumpExercise.durationSeconds);
+        put32(epochOf(_pumpExercise.lastRun));
+    }
+
+    if (buffer) {
+        putU16(&buffer[offset], crc16(buffer, offset));
+    }
+    return offset + SCHEDULE_V2_CRC_SIZE;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::markSchedulesPersisted() {
+    memset(&_changes, 0, sizeof(_changes));
+    for (const auto& schedule : _schedules) {
+        ChangeSet::insert(_changes.persistedIds, schedule.id);
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::serializeSchedules(uint8_t* buffer, size_t bufferSize) {
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for serializeSchedules()");
+        return false;
+    }
+
+    if (!buffer || bufferSize < encodeSchedules(nullptr, false)) {
+        DS3231_LOG_E("Invalid buffer or insufficient size");
+        return false;
+    }
+
+    size_t size = encodeSchedules(buffer, false);
+    markSchedulesPersisted();
+
+    DS3231_LOG_I("Serialized %d schedules to buffer (%d bytes)", _schedules.size(), size);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::hasScheduleChanges() const {
+    // An empty delta is just the header, the removed count and the CRC
+    return getScheduleChangesSize() > SCHEDULE_V2_HEADER_SIZE + 1 + SCHEDULE_V2_CRC_SIZE;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::getScheduleChangesSize() const {
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (!lock.hasLock()) {
+        return MAX_SCHEDULE_DELTA_SIZE;
+    }
+    return encodeSchedules(nullptr, true);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::serializeScheduleChanges(uint8_t* buffer, size_t bufferSize,
+                                                                         size_t& written) {
+    written = 0;
+
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for serializeScheduleChanges()");
+        return false;
+    }
+
+    if (!buffer || bufferSize < encodeSchedules(nullptr, true)) {
+        DS3231_LOG_E("Invalid buffer or insufficient size");
+        return false;
+    }
+
+    written = encodeSchedules(buffer, true);
+    markSchedulesPersisted();
+
+    DS3231_LOG_I("Serialized schedule changes to buffer (%d bytes)", written);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::deserializeSchedules(const uint8_t* buffer, size_t dataSize) {
+    if (!buffer || dataSize < 4) {
+        DS3231_LOG_E("Invalid buffer or size");
+        return false;
+    }
+
+    // Verify header
+    if (buffer[0] != SCHEDULE_FORMAT_MAGIC_0 || buffer[1] != SCHEDULE_FORMAT_MAGIC_1) {
+        DS3231_LOG_E("Invalid magic number");
+        return false;
+    }
+
+    uint8_t version = buffer[2];
+    if (version != SCHEDULE_FORMAT_V1 && version != SCHEDULE_FORMAT_V2 && version != SCHEDULE_FORMAT_V3) {
+        DS3231_LOG_E("Unsupported version: %d", version);
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for deserializeSchedules()");
+        return false;
+    }
+
+    // v3 only adds rule records, which the v2 decoder reads
+    bool ok = (version == SCHEDULE_FORMAT_V1) ? decodeSchedulesV1(buffer, dataSize)
+                                              : decodeSchedulesV2(buffer, dataSize);
+    if (!ok) {
+        return false;
+    }
+
+    markSchedulesPersisted();
+    if (version == SCHEDULE_FORMAT_V1) {
+        markStoreDirty();  // Rewrite as v2 on the next commit
+    }
+    publishCompiledState();
+    DS3231_LOG_I("Deserialized %d schedules from buffer (v%d)", _schedules.size(), version);
+    notifyScheduler();
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::decodeSchedulesV1(const uint8_t* buffer, size_t dataSize) {
+    // v1: fixed 32-byte name slots, whatever NameSize this controller has,
+    // then raw VacationMode/PumpExercise structs
+    static constexpr size_t V1_NAME_SLOT = 32;
+    static constexpr size_t V1_RECORD_SIZE = 7 + V1_NAME_SLOT;
+    static constexpr size_t V1_NAME_COPY = std::min(SCHEDULE_NAME_SIZE, V1_NAME_SLOT) - 1;
+
+    size_t offset = 3;
+    uint8_t scheduleCount = buffer[offset++];
+    if (scheduleCount > MAX_SCHEDULES) {
+        DS3231_LOG_E("Too many schedules: %d", scheduleCount);
+        return false;
+    }
+    if (dataSize < offset + scheduleCount * V1_RECORD_SIZE) {
+        DS3231_LOG_E("Truncated schedule data");
+        return false;
+    }
+
+    _schedules.clear();
+    for (uint8_t i = 0; i < scheduleCount; i++) {
+        Schedule schedule;
+        schedule.id = buffer[offset++];
+        schedule.dayMask = buffer[offset++];
+        schedule.startHour = buffer[offset++];
+        schedule.startMinute = buffer[offset++];
+        schedule.endHour = buffer[offset++];
+        schedule.endMinute = buffer[offset++];
+        schedule.enabled = buffer[offset++] != 0;
+
+        char name[V1_NAME_COPY + 1];
+        memcpy(name, &buffer[offset], V1_NAME_COPY);
+        name[V1_NAME_COPY] = 0; // Ensure null termination
+        schedule.name = name;
+        offset += V1_NAME_SLOT;
+
+        _schedules.push_back(schedule);
+    }
+
+    if (offset + sizeof(VacationMode) <= dataSize) {
+        memcpy(&_vacationMode, &buffer[offset], sizeof(VacationMode));
+        offset += sizeof(VacationMode);
+    }
+
+    if (offset + sizeof(PumpExercise) <= dataSize) {
+        memcpy(&_pumpExercise, &buffer[offset], sizeof(PumpExercise));
+    }
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::decodeSchedulesV2(const uint8_t* buffer, size_t dataSize) {
+    auto dateOf = [](uint32_t epoch) { return epoch ? DateTime(epoch) : kInvalidTime; };
+
+    // Validate and stage everything before touching live state
+    if (dataSize < SCHEDULE_V2_HEADER_SIZE) {
+        DS3231_LOG_E("Truncated schedule data");
+        return false;
+    }
+    size_t offset = 3;
+    uint8_t flags = buffer[offset++];
+    uint8_t recordCount = buffer[offset++];
+    bool delta = (flags & SCHEDULE_FLAG_DELTA) != 0;
+    if (recordCount > MAX_SCHEDULES) {
+        DS3231_LOG_E("Too many schedules: %d", recordCount);
+        return false;
+    }
+
+    const uint8_t* removed = nullptr;
+    uint8_t removedCount = 0;
+    if (delta) {
+        if (offset + 1 > dataSize || offset + 1 + buffer[offset] > dataSize) {
+            DS3231_LOG_E("Truncated schedule data");
+            return false;
+        }
+        removedCount = buffer[offset++];
+        removed = &buffer[offset];
+        offset += removedCount;
+    }
+
+    ScheduleList staged;
+    for (uint8_t i = 0; i < recordCount; i++) {
+        if (offset + SCHEDULE_V2_RECORD_FIXED_SIZE > dataSize) {
+            DS3231_LOG_E("Truncated schedule data");
+            return false;
+        }
+        Schedule schedule;
+        schedule.id = buffer[offset];
+        schedule.dayMask = buffer[offset + 1] & 0x7F;
+        schedule.enabled = (buffer[offset + 1] & 0x80) != 0;
+        uint32_t packed = buffer[offset + 2] | (buffer[offset + 3] << 8) |
+                          (static_cast<uint32_t>(buffer[offset + 4]) << 16);
+        uint16_t startOfDay = packed & 0x7FF;
+        uint16_t endOfDay = (packed >> 11) & 0x7FF;
+        bool hasRule = (packed & SCHEDULE_RECORD_RULE_BIT) != 0;
+        schedule.startHour = startOfDay / 60;
+        schedule.startMinute = startOfDay % 60;
+        schedule.endHour = endOfDay / 60;
+        schedule.endMinute = endOfDay % 60;
+        uint8_t nameLen = buffer[offset + 5];
+        offset += SCHEDULE_V2_RECORD_FIXED_SIZE;
+        if (offset + nameLen > dataSize) {
+            DS3231_LOG_E("Truncated schedule data");
+            return false;
+        }
+
+        // Names from a controller with larger slots are truncated to ours
+        char name[SCHEDULE_NAME_SIZE];
+        size_t keep = nameLen < SCHEDULE_NAME_SIZE - 1 ? nameLen : SCHEDULE_NAME_SIZE - 1;
+        memcpy(name, &buffer[offset], keep);
+        name[keep] = 0;
+        schedule.name = name;
+        offset += nameLen;
+
+        if (hasRule) {
+            if (offset + SCHEDULE_V3_RULE_SIZE > dataSize) {
+                DS3231_LOG_E("Truncated schedule data");
+                return false;
+            }
+            schedule.recurrence = static_cast<Recurrence>(buffer[offset]);
+            schedule.interval = buffer[offset + 1];
+            schedule.firstDay = getU16(&buffer[offset + 2]);
+            schedule.lastDay = getU16(&buffer[offset + 4]);
+            offset += SCHEDULE_V3_RULE_SIZE;
+        }
+
+        staged.push_back(schedule);
+    }
+
+    size_t vacationOffset = offset;
+    if (flags & SCHEDULE_FLAG_VACATION) offset += SCHEDULE_V2_VACATION_SIZE;
+    size_t pumpOffset = offset;
+    if (flags & SCHEDULE_FLAG_PUMP) offset += SCHEDULE_V2_PUMP_SIZE;
+
+    if (offset + SCHEDULE_V2_CRC_SIZE > dataSize) {
+        DS3231_LOG_E("Truncated schedule data");
+        return false;
+    }
+    if (crc16(buffer, offset) != getU16(&buffer[offset])) {
+        DS3231_LOG_E("Schedule data CRC mismatch");
+        return false;
+    }
+
+    if (delta) {
+        // Count the result first so a delta that would overflow changes nothing
+        auto isRemoved = [removed, removedCount](uint8_t id) {
+            return std::find(removed, removed + removedCount, id) != removed + removedCount;
+        };
+        auto findLive = [this](uint8_t id) {
+            return std::find_if(_schedules.begin(), _schedules.end(),
+                                [id](const Schedule& s) { return s.id == id; });
+        };
+        size_t resulting = 0;
+        for (const auto& schedule : _schedules) {
+            if (!isRemoved(schedule.id)) resulting++;
+        }
+        for (const auto& schedule : staged) {
+            if (findLive(schedule.id) == _schedules.end() || isRemoved(schedule.id)) resulting++;
+        }
+        if (resulting > MAX_SCHEDULES) {
+            DS3231_LOG_E("Delta exceeds maximum number of schedules (%d)", MAX_SCHEDULES);
+            return false;
+        }
+
+        _schedules.erase(std::remove_if(_schedules.begin(), _schedules.end(),
+                                        [&isRemoved](const Schedule& s) { return isRemoved(s.id); }),
+                         _schedules.end());
+        for (const auto& schedule : staged) {
+            auto it = findLive(schedule.id);
+            if (it != _schedules.end()) {
+                *it = schedule;
+            } else {
+                _schedules.push_back(schedule);
+            }
+        }
+    } else {
+        _schedules = staged;
+    }
+
+    if (flags & SCHEDULE_FLAG_VACATION) {
+        const uint8_t* p = &buffer[vacationOffset];
+        _vacationMode.enabled = (p[0] & 0x01) != 0;
+        _vacationMode.runPumpExercise = (p[0] & 0x02) != 0;
+        _vacationMode.startDate = dateOf(getU32(p + 1));
+        _vacationMode.endDate = dateOf(getU32(p + 5));
+    }
+
+    if (flags & SCHEDULE_FLAG_PUMP) {
+        const uint8_t* p = &buffer[pumpOffset];
+        _pumpExercise.enabled = p[0] != 0;
+        _pumpExercise.dayOfMonth = p[1];
+        _pumpExercise.hour = p[2];
+        _pumpExercise.minute = p[3];
+        _pumpExercise.durationSeconds = getU16(p + 4);
+        _pumpExercise.lastRun = dateOf(getU32(p + 6));
+    }
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::attachStore(DS3231ScheduleStore& store, uint32_t debounceMs,
+                                                            bool restoreOnBegin) {
+    RecursiveMutexGuard storeLock(_storeMutex);
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (!storeLock.hasLock() || !lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for attachStore()");
+        return false;
+    }
+
+    if (!_storeTimer) {
+        esp_timer_create_args_t args = {};
+        args.callback = &storeTimerEntry;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "ds3231_store";
+        if (esp_timer_create(&args, &_storeTimer) != ESP_OK) {
+            DS3231_LOG_E("Failed to create store commit timer");
+            _storeTimer = nullptr;
+            return false;
+        }
+    }
+
+    _store = &store;
+    _storeDebounceMs = debounceMs;
+    _storeRestoreOnBegin = restoreOnBegin;
+    _storeDirty = false;
+    _storeHasCrc = false;
+    DS3231_LOG_I("Persistence store attached (debounce %lu ms)", (unsigned long)debounceMs);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::detachStore() {
+    RecursiveMutexGuard storeLock(_storeMutex);
+    if (!storeLock.hasLock() || !_store) {
+        return;
+    }
+
+    (void)flushStore();
+
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (_storeTimer) {
+        esp_timer_stop(_storeTimer);
+    }
+    _store = nullptr;
+    _storeDirty = false;
+    _storeRestoreOnBegin = false;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::restoreFromStore() {
+    RecursiveMutexGuard storeLock(_storeMutex);
+    if (!storeLock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for restoreFromStore()");
+        return false;
+    }
+    if (!_store) {
+        DS3231_LOG_E("No persistence store attached");
+        return false;
+    }
+
+    uint8_t buffer[MAX_SCHEDULE_DATA_SIZE];
+    size_t length = 0;
+    if (!_store->load(buffer, sizeof(buffer), length)) {
+        DS3231_LOG_W("No stored schedules");
+        return false;
+    }
+    if (!deserializeSchedules(buffer, length)) {
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    if (buffer[2] != SCHEDULE_FORMAT_V1) {
+        _storeCrc = getU16(&buffer[length - SCHEDULE_V2_CRC_SIZE]);
+        _storeHasCrc = true;
+    }
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::flushStore() {
+    RecursiveMutexGuard storeLock(_storeMutex);
+    if (!storeLock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for flushStore()");
+        return false;
+    }
+
+    // Encode under _mutex, then write without it so mutators never wait on flash
+    uint8_t buffer[MAX_SCHEDULE_DATA_SIZE];
+    size_t size;
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for flushStore()");
+            return false;
+        }
+        if (!_store) {
+            return false;
+        }
+        if (!_storeDirty) {
+            return true;
+        }
+        if (_storeTimer) {
+            esp_timer_stop(_storeTimer);
+        }
+        size = encodeSchedules(buffer, false);
+        _storeDirty = false;
+    }
+
+    // Edits that ended where they started don't need a write
+    uint16_t crc = getU16(&buffer[size - SCHEDULE_V2_CRC_SIZE]);
+    if (_storeHasCrc && crc == _storeCrc) {
+        DS3231_LOG_D("Stored schedules unchanged, skipping commit");
+        return true;
+    }
+
+    if (!_store->save(buffer, size)) {
+        DS3231_LOG_E("Failed to commit schedules to store");
+        StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+        markStoreDirty();  // Retry after another debounce window
+        return false;
+    }
+
+    _storeCrc = crc;
+    _storeHasCrc = true;
+    DS3231_LOG_I("Committed %d bytes of schedule data to store", size);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::hasUnsavedChanges() const {
+    StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+    return lock.hasLock() && _storeDirty;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::markStoreDirty() {
+    if (!_store) {
+        return;
+    }
+
+    int64_t nowUs = esp_timer_get_time();
+    if (!_storeDirty) {
+        _storeDirty = true;
+        _storeDirtySinceUs = nowUs;
+    }
+
+    // Each edit restarts the debounce window, until the oldest unsaved edit
+    // has waited STORE_MAX_DEFER_WINDOWS windows; then the armed timer stands
+    int64_t windowUs = static_cast<int64_t>(_storeDebounceMs) * 1000;
+    if (_storeTimer && nowUs - _storeDirtySinceUs < windowUs * STORE_MAX_DEFER_WINDOWS) {
+        esp_timer_stop(_storeTimer);
+        esp_timer_start_once(_storeTimer, windowUs);
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::storeTimerEntry(void* arg) {
+    (void)static_cast<DS3231ControllerT*>(arg)->flushStore();
+}
+
+// State document export and import
+
+template <uint8_t MaxSchedules, size_t NameSize>
+size_t DS3231ControllerT<MaxSchedules, NameSize>::exportState(Print& out, StateFormat format) {
+    struct Record {
+        uint8_t id, dayMask, startHour, startMinute, endHour, endMinute, interval;
+        bool enabled, hasRule;
+        Recurrence recurrence;
+        uint16_t firstDay, lastDay;
+        char name[SCHEDULE_NAME_SIZE];
+    };
+
+    VacationMode vacation;
+    PumpExercise pump;
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for exportState()");
+            return 0;
+        }
+        vacation = _vacationMode;
+        pump = _pumpExercise;
+    }
+
+    DS3231StateWriter writer(out, format);
+    writer.beginMap(6);
+    writer.key("version");
+    writer.value(static_cast<uint32_t>(STATE_DOCUMENT_VERSION));
+    writer.key("time");
+    if (_initialized) {
+        writer.dateTime(now());
+    } else {
+        writer.null();
+    }
+
+    // Indefinite length: the list may change between records
+    writer.key("schedules");
+    writer.beginArray();
+    for (size_t i = 0; ; i++) {
+        Record record;
+        {
+            StatsGuard lock(_mutex, _stats, StatOp::Persistence);
+            if (!lock.hasLock()) {
+                DS3231_LOG_W("Failed to acquire mutex for exportState(), schedule list cut short");
+                break;
+            }
+            if (i >= _schedules.size()) {
+                break;
+            }
+            const Schedule& schedule = _schedules[i];
+            record.id = schedule.id;
+            record.dayMask = schedule.dayMask;
+            record.startHour = schedule.startHour;
+            record.startMinute = schedule.startMinute;
+            record.endHour = schedule.endHour;
+            record.endMinute = schedule.endMinute;
+            record.enabled = schedule.enabled;
+            record.hasRule = schedule.hasRule();
+            record.recurrence = schedule.recurrence;
+            record.interval = schedule.interval;
+            record.firstDay = schedule.firstDay;
+            record.lastDay = schedule.lastDay;
+            size_t nameLen = schedule.name.length();
+            if (nameLen > SCHEDULE_NAME_SIZE - 1) nameLen = SCHEDULE_NAME_SIZE - 1;
+            memcpy(record.name, schedule.name.c_str(), nameLen);
+            record.name[nameLen] = '\0';
+        }
+
+        writer.beginMap(record.hasRule ? 10 : 6);
+        writer.key("id");
+        writer.value(static_cast<uint32_t>(record.id));
+        writer.key("name");
+        writer.value(record.name);
+        writer.key("enabled");
+        writer.value(record.enabled);
+        writer.key("days");
+        writer.value(static_cast<uint32_t>(record.dayMask));
+        writer.key("start");
+        writer.timeOfDay(record.startHour, record.startMinute);
+        writer.key("end");
+        writer.timeOfDay(record.endHour, record.endMinute);
+        if (record.hasRule) {
+            writer.key("repeat");
+            writer.value(recurrenceName(record.recurrence));
+            writer.key("interval");
+            writer.value(static_cast<uint32_t>(record.interval));
+            writer.key("from");
+            writer.dateTime(record.firstDay ? dateOfDay(record.firstDay) : kInvalidTime);
+            writer.key("until");
+            writer.dateTime(record.lastDay != NO_END_DAY ? dateOfDay(record.lastDay) : kInvalidTime);
+        }
+        writer.end();
+    }
+    writer.end();
+
+    writer.key("vacation");
+    writer.beginMap(4);
+    writer.key("enabled");
+    writer.value(vacation.enabled);
+    writer.key("start");
+    writer.dateTime(vacation.startDate);
+    writer.key("end");
+    writer.dateTime(vacation.endDate);
+    writer.key("runPumpExercise");
+    writer.value(vacation.runPumpExercise);
+    writer.end();
+
+    writer.key("pumpExercise");
+    writer.beginMap(6);
+    writer.key("enabled");
+    writer.value(pump.enabled);
+    writer.key("dayOfMonth");
+    writer.value(static_cast<uint32_t>(pump.dayOfMonth));
+    writer.key("hour");
+    writer.value(static_cast<uint32_t>(pump.hour));
+    writer.key("minute");
+    writer.value(static_cast<uint32_t>(pump.minute));
+    writer.key("durationSeconds");
+    writer.value(static_cast<uint32_t>(pump.durationSeconds));
+    writer.key("lastRun");
+    writer.dateTime(pump.lastRun);
+    writer.end();
+
+    writer.key("temperature");
+    if (_initialized) {
+        writer.value(getTemperature().celsius);
+    } else {
+        writer.null();
+    }
+    writer.end();
+
+    if (writer.failed()) {
+        DS3231_LOG_W("State export truncated after %u bytes", static_cast<unsigned>(writer.bytesWritten()));
+    }
+    return writer.bytesWritten();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::StateImportResult
+DS3231ControllerT<MaxSchedules, NameSize>::importState(Stream& in, StateFormat format, bool replaceSchedules) {
+    StateImporter importer(*this, format, replaceSchedules);
+    // One byte at a time, so nothing after the document is consumed
+    uint8_t byte;
+    while (!importer.done() && in.readBytes(&byte, 1) == 1) {
+        if (!importer.feed(&byte, 1)) {
+            break;
+        }
+    }
+    return importer.finish();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::StateImporter(DS3231ControllerT& controller,
+                                                                        StateFormat format, bool replaceSchedules)
+    : _controller(controller), _reader(*this, format), _replace(replaceSchedules) {}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::feed(const uint8_t* data, size_t length) {
+    if (_result.error != StateImportError::None) {
+        return false;
+    }
+    return _reader.feed(data, length) && _result.error == StateImportError::None;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::StateImportResult
+DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::finish() {
+    if (_result.error == StateImportError::None) {
+        switch (_reader.finish()) {
+            case DS3231StateReader::Error::None: break;
+            case DS3231StateReader::Error::Syntax: _result.error = StateImportError::Syntax; break;
+            case DS3231StateReader::Error::TooDeep: _result.error = StateImportError::TooDeep; break;
+            case DS3231StateReader::Error::Incomplete: _result.error = StateImportError::Incomplete; break;
+        }
+    }
+    _result.bytes = _reader.position();
+
+    // Only a complete document may remove schedules
+    if (_result.error == StateImportError::None && _replace) {
+        DS3231ControllerT& c = _controller;
+        StatsGuard lock(c._mutex, c._stats, StatOp::Schedules);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for StateImporter::finish()");
+            _result.error = StateImportError::Locked;
+            return _result;
+        }
+        uint8_t stale[MAX_SCHEDULES];
+        uint8_t staleCount = 0;
+        for (const auto& schedule : c._schedules) {
+            if (!ChangeSet::contains(_seenIds, schedule.id)) {
+                stale[staleCount++] = schedule.id;
+            }
+        }
+        for (uint8_t i = 0; i < staleCount; i++) {
+            if (c.removeSchedule(stale[i])) {
+                _result.removed++;
+            }
+        }
+    }
+
+    DS3231_LOG_I("State import: %u added, %u updated, %u removed, %u rejected, error %u",
+                 _result.added, _result.updated, _result.removed, _result.rejected,
+                 static_cast<unsigned>(_result.error));
+    return _result;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::beginContainer(bool isMap) {
+    _depth++;
+    _field = Field::None;  // A container is never a field value
+    if (_recordDepth != 0) {
+        return;
+    }
+    if (_depth == 2 && _section == Section::Schedules && !isMap) {
+        _inScheduleList = true;
+    } else if (isMap && ((_depth == 2 && (_section == Section::Vacation || _section == Section::Pump)) ||
+                         (_depth == 3 && _inScheduleList))) {
+        _recordDepth = _depth;
+        _present = 0;
+        _invalid = false;
+        _schedule = Schedule{};
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::endContainer() {
+    if (_depth == _recordDepth) {
+        _recordDepth = 0;
+        switch (_section) {
+            case Section::Schedules: applySchedule(); break;
+            case Section::Vacation: applyVacation(); break;
+            case Section::Pump: applyPump(); break;
+            default: break;
+        }
+    }
+    if (_depth == 2) {
+        _inScheduleList = false;
+    }
+    _depth--;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::key(const char* name) {
+    _field = Field::None;
+    if (_depth == 1) {
+        _section = strcmp(name, "schedules") == 0      ? Section::Schedules
+                   : strcmp(name, "vacation") == 0     ? Section::Vacation
+                   : strcmp(name, "pumpExercise") == 0 ? Section::Pump
+                                                       : Section::None;
+        return;
+    }
+    if (_recordDepth == 0 || _depth != _recordDepth) {
+        return;
+    }
+
+    // Unknown keys stay Field::None and their values are skipped
+    if (strcmp(name, "enabled") == 0) {
+        _field = Field::Enabled;
+    } else if (_section == Section::Schedules) {
+        if (strcmp(name, "id") == 0) _field = Field::Id;
+        else if (strcmp(name, "name") == 0) _field = Field::Name;
+        else if (strcmp(name, "days") == 0) _field = Field::Days;
+        else if (strcmp(name, "start") == 0) _field = Field::Start;
+        else if (strcmp(name, "end") == 0) _field = Field::End;
+        else if (strcmp(name, "repeat") == 0) _field = Field::Repeat;
+        else if (strcmp(name, "interval") == 0) _field = Field::Interval;
+        else if (strcmp(name, "from") == 0) _field = Field::From;
+        else if (strcmp(name, "until") == 0) _field = Field::Until;
+    } else if (_section == Section::Vacation) {
+        if (strcmp(name, "start") == 0) _field = Field::Start;
+        else if (strcmp(name, "end") == 0) _field = Field::End;
+        else if (strcmp(name, "runPumpExercise") == 0) _field = Field::RunPump;
+    } else if (_section == Section::Pump) {
+        if (strcmp(name, "dayOfMonth") == 0) _field = Field::DayOfMonth;
+        else if (strcmp(name, "hour") == 0) _field = Field::Hour;
+        else if (strcmp(name, "minute") == 0) _field = Field::Minute;
+        else if (strcmp(name, "durationSeconds") == 0) _field = Field::Duration;
+        else if (strcmp(name, "lastRun") == 0) _field = Field::LastRun;
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::value(const DS3231StateReader::Value& value) {
+    using Type = DS3231StateReader::Value::Type;
+
+    Field field = _field;
+    _field = Field::None;
+    if (field == Field::None || _recordDepth == 0 || _depth != _recordDepth) {
+        return;
+    }
+
+    int64_t number = 0;
+    auto integer = [&value, &number](int64_t lo, int64_t hi) {
+        number = value.integer;
+        return value.type == Type::Integer && value.integer >= lo && value.integer <= hi;
+    };
+    bool ok = true;
+    switch (field) {
+        case Field::Id:
+            if ((ok = integer(0, 255))) _schedule.id = static_cast<uint8_t>(number);
+            break;
+        case Field::Name:
+            ok = value.type == Type::Text || value.type == Type::Null;
+            if (ok) _schedule.name = value.type == Type::Text ? value.text : "";
+            break;
+        case Field::Enabled:
+            ok = value.type == Type::Boolean;
+            _schedule.enabled = _vacation.enabled = _pump.enabled = value.boolean;
+            break;
+        case Field::Days:
+            if ((ok = integer(0, 0x7F))) _schedule.dayMask = static_cast<uint8_t>(number);
+            break;
+        case Field::Start:
+            ok = _section == Section::Schedules
+                     ? ds3231ParseTimeOfDay(value, _schedule.startHour, _schedule.startMinute)
+                     : ds3231ParseDateTime(value, _vacation.startDate);
+            break;
+        case Field::End:
+            ok = _section == Section::Schedules
+                     ? ds3231ParseTimeOfDay(value, _schedule.endHour, _schedule.endMinute)
+                     : ds3231ParseDateTime(value, _vacation.endDate);
+            break;
+        case Field::Repeat:
+            ok = value.type == Type::Text && parseRecurrence(value.text, _schedule.recurrence);
+            break;
+        case Field::Interval:
+            if ((ok = integer(0, 255))) _schedule.interval = static_cast<uint8_t>(number);
+            break;
+        case Field::From:
+        case Field::Until: {
+            DateTime date;
+            ok = ds3231ParseDateTime(value, date);
+            uint16_t unset = field == Field::From ? 0 : NO_END_DAY;
+            (field == Field::From ? _schedule.firstDay : _schedule.lastDay) = date.isValid() ? dayNumber(date) : unset;
+            break;
+        }
+        case Field::RunPump:
+            ok = value.type == Type::Boolean;
+            _vacation.runPumpExercise = value.boolean;
+            break;
+        case Field::DayOfMonth:
+            if ((ok = integer(0, 31))) _pump.dayOfMonth = static_cast<uint8_t>(number);
+            break;
+        case Field::Hour:
+            if ((ok = integer(0, 23))) _pump.hour = static_cast<uint8_t>(number);
+            break;
+        case Field::Minute:
+            if ((ok = integer(0, 59))) _pump.minute = static_cast<uint8_t>(number);
+            break;
+        case Field::Duration:
+            if ((ok = integer(0, 0xFFFF))) _pump.durationSeconds = static_cast<uint16_t>(number);
+            break;
+        case Field::LastRun:
+            ok = ds3231ParseDateTime(value, _pump.lastRun);
+            break;
+        default:
+            break;
+    }
+
+    if (ok) {
+        _present |= 1u << static_cast<uint8_t>(field);
+    } else {
+        _invalid = true;
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::applySchedule() {
+    if (_result.error != StateImportError::None) {
+        return;
+    }
+    if (_invalid) {
+        DS3231_LOG_W("Schedule record rejected: field out of range");
+        _result.rejected++;
+        return;
+    }
+
+    DS3231ControllerT& c = _controller;
+    StatsGuard lock(c._mutex, c._stats, StatOp::Schedules);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for state import");
+        _result.error = StateImportError::Locked;
+        return;
+    }
+
+    auto has = [this](Field field) { return (_present >> static_cast<uint8_t>(field)) & 1; };
+    uint8_t id = has(Field::Id) ? _schedule.id : 0;
+    const Schedule* existing = id ? c.getSchedule(id) : nullptr;
+    bool update = existing != nullptr;
+
+    Schedule merged = {};
+    if (update) {
+        merged = *existing;
+    } else if (!has(Field::Start) || !has(Field::End)) {
+        DS3231_LOG_W("Schedule record rejected: a new schedule needs start and end");
+        _result.rejected++;
+        return;
+    } else {
+        merged.id = id ? id : c.getNextFreeScheduleId();
+        merged.dayMask = 0x7F;
+        merged.enabled = true;
+    }
+
+    if (has(Field::Name)) merged.name = _schedule.name;
+    if (has(Field::Enabled)) merged.enabled = _schedule.enabled;
+    if (has(Field::Days)) merged.dayMask = _schedule.dayMask;
+    if (has(Field::Start)) {
+        merged.startHour = _schedule.startHour;
+        merged.startMinute = _schedule.startMinute;
+    }
+    if (has(Field::End)) {
+        merged.endHour = _schedule.endHour;
+        merged.endMinute = _schedule.endMinute;
+    }
+    if (has(Field::Repeat)) merged.recurrence = _schedule.recurrence;
+    if (has(Field::Interval)) merged.interval = _schedule.interval;
+    if (has(Field::From)) merged.firstDay = _schedule.firstDay;
+    if (has(Field::Until)) merged.lastDay = _schedule.lastDay;
+
+    if (!(update ? c.updateSchedule(id, merged) : c.addSchedule(merged))) {
+        _result.rejected++;
+        return;
+    }
+    if (update) {
+        _result.updated++;
+    } else {
+        _result.added++;
+    }
+    ChangeSet::insert(_seenIds, merged.id);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::applyVacation() {
+    if (_result.error != StateImportError::None) {
+        return;
+    }
+    if (_invalid) {
+        DS3231_LOG_W("Vacation record rejected: field out of range");
+        _result.rejected++;
+        return;
+    }
+
+    DS3231ControllerT& c = _controller;
+    StatsGuard lock(c._mutex, c._stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for state import");
+        _result.error = StateImportError::Locked;
+        return;
+    }
+
+    auto has = [this](Field field) { return (_present >> static_cast<uint8_t>(field)) & 1; };
+    VacationMode merged = c._vacationMode;
+    if (has(Field::Enabled)) merged.enabled = _vacation.enabled;
+    if (has(Field::Start)) merged.startDate = _vacation.startDate;
+    if (has(Field::End)) merged.endDate = _vacation.endDate;
+    if (has(Field::RunPump)) merged.runPumpExercise = _vacation.runPumpExercise;
+
+    // No setter for runPumpExercise: set it first, so setVacationMode() publishes it
+    c._vacationMode.runPumpExercise = merged.runPumpExercise;
+    c.setVacationMode(merged.enabled, merged.startDate, merged.endDate);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::StateImporter::applyPump() {
+    if (_result.error != StateImportError::None) {
+        return;
+    }
+    if (_invalid) {
+        DS3231_LOG_W("Pump exercise record rejected: field out of range");
+        _result.rejected++;
+        return;
+    }
+
+    DS3231ControllerT& c = _controller;
+    StatsGuard lock(c._mutex, c._stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for state import");
+        _result.error = StateImportError::Locked;
+        return;
+    }
+
+    auto has = [this](Field field) { return (_present >> static_cast<uint8_t>(field)) & 1; };
+    PumpExercise merged = c._pumpExercise;
+    if (has(Field::Enabled)) merged.enabled = _pump.enabled;
+    if (has(Field::DayOfMonth)) merged.dayOfMonth = _pump.dayOfMonth;
+    if (has(Field::Hour)) merged.hour = _pump.hour;
+    if (has(Field::Minute)) merged.minute = _pump.minute;
+    if (has(Field::Duration)) merged.durationSeconds = _pump.durationSeconds;
+
+    // lastRun has no setter either; setPumpExercise() publishes it with the rest
+    if (has(Field::LastRun)) {
+        c._pumpExercise.lastRun = _pump.lastRun;
+    }
+    c.setPumpExercise(merged.enabled, merged.dayOfMonth, merged.hour, merged.minute, merged.durationSeconds);
+}
+
+// Additional missing implementations
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::adjustDrift(int32_t secondsPerMonth) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for adjustDrift()");
+        return false;
+    }
+
+    RegisterSnapshot snapshot;
+    if (!readSnapshotLocked(snapshot)) {
+        return false;
+    }
+
+    // A 30-day month; a gaining RTC needs a larger (slowing) offset
+    float ppm = secondsPerMonth * 1e6f / (30 * 24 * 3600UL);
+    int32_t target = snapshot.agingOffset + lroundf(ppm / AGING_PPM_PER_LSB);
+    target = target < -128 ? -128 : (target > 127 ? 127 : target);
+    return writeAgingOffset(static_cast<int8_t>(target), snapshot);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::getAgingOffset(int8_t& offset) const {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for getAgingOffset()");
+        return false;
+    }
+
+    uint8_t raw;
+    if (!readRegisters(DS3231_REG_AGING, &raw, 1)) {
+        return false;
+    }
+    offset = static_cast<int8_t>(raw);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setAgingOffset(int8_t offset) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setAgingOffset()");
+        return false;
+    }
+
+    RegisterSnapshot snapshot;
+    if (!readSnapshotLocked(snapshot)) {
+        return false;
+    }
+    return writeAgingOffset(offset, snapshot);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::writeAgingOffset(int8_t offset, const RegisterSnapshot& snapshot) {
+    if (!writeRegister(DS3231_REG_AGING, static_cast<uint8_t>(offset))) {
+        DS3231_LOG_E("Failed to write aging offset");
+        return false;
+    }
+
+    // The new offset applies from the next temperature conversion; start one
+    // unless a conversion is already running
+    if (!(snapshot.status & DS3231_STATUS_BSY)) {
+        (void)writeRegister(DS3231_REG_CONTROL, snapshot.control | DS3231_CONTROL_CONV);
+    }
+
+    // Drift measured under the old offset no longer applies
+    memset(_drift.bins, 0, sizeof(_drift.bins));
+
+    DS3231_LOG_I("Aging offset %d -> %d", snapshot.agingOffset, offset);
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::enableDriftTracking(bool enable, bool autoTrim) {
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for enableDriftTracking()");
+        return;
+    }
+
+    if (enable && !_drift.enabled) {
+        _drift.referenceEpoch = 0;  // The first reference only starts an interval
+    }
+    _drift.enabled = enable;
+    _drift.autoTrim = autoTrim;
+    DS3231_LOG_I("Drift tracking %s%s", enable ? "enabled" : "disabled",
+                 enable && autoTrim ? " with automatic aging trim" : "");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+typename DS3231ControllerT<MaxSchedules, NameSize>::DriftEstimate
+DS3231ControllerT<MaxSchedules, NameSize>::getDriftEstimate() const {
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        return DriftEstimate{0.0f, 0, 0, false, false};
+    }
+    return estimateDrift(_drift.bins);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::resetDriftTracking() {
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for resetDriftTracking()");
+        return;
+    }
+    memset(_drift.bins, 0, sizeof(_drift.bins));
+    _drift.referenceEpoch = 0;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::recordDriftSample(uint32_t referenceEpoch) {
+    RegisterSnapshot snapshot;
+    if (!readSnapshotLocked(snapshot)) {
+        return false;
+    }
+
+    int32_t errorSeconds = static_cast<int32_t>(snapshot.time.unixtime() - referenceEpoch);
+    bool running = _drift.referenceEpoch != 0 && referenceEpoch > _drift.referenceEpoch;
+
+    if (errorSeconds == 0) {
+        // Agrees to the second: let the interval run on instead of stepping
+        if (!running) {
+            _drift.referenceEpoch = referenceEpoch;
+            _drift.referenceTempC = snapshot.temperatureC;
+        }
+        return true;
+    }
+
+    if (running) {
+        uint32_t elapsed = referenceEpoch - _drift.referenceEpoch;
+        float ppm = errorSeconds * 1e6f / elapsed;
+        if (elapsed >= DRIFT_MIN_SAMPLE_SECONDS && ppm > -MAX_PLAUSIBLE_DRIFT_PPM && ppm < MAX_PLAUSIBLE_DRIFT_PPM) {
+            DriftBin& bin = _drift.bins[driftBinFor((snapshot.temperatureC + _drift.referenceTempC) / 2)];
+            bin.errorSeconds += errorSeconds;
+            bin.elapsedSeconds += elapsed;
+            bin.samples++;
+            DS3231_LOG_I("RTC drift sample: %ld s over %lu s (%.2f ppm)",
+                         (long)errorSeconds, (unsigned long)elapsed, ppm);
+
+            DriftEstimate estimate = estimateDrift(_drift.bins);
+            if (_drift.autoTrim && estimate.valid && estimate.elapsedSeconds >= DRIFT_TRIM_MIN_SECONDS &&
+                fabsf(estimate.ppm) >= AGING_PPM_PER_LSB) {
+                int32_t target = snapshot.agingOffset + lroundf(estimate.ppm / AGING_PPM_PER_LSB);
+                target = target < -128 ? -128 : (target > 127 ? 127 : target);
+                (void)writeAgingOffset(static_cast<int8_t>(target), snapshot);
+            }
+        } else {
+            DS3231_LOG_D("Drift interval discarded: %ld s over %lu s", (long)errorSeconds, (unsigned long)elapsed);
+        }
+    }
+
+    _drift.referenceTempC = snapshot.temperatureC;
+    return false;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isTemperatureCompensationEnabled() const {
+    // DS3231 has built-in temperature compensation that's always enabled
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setAlarm2(const DateTime& dt) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    if (_timeSource) {
+        DS3231_LOG_E("No RTC of its own - controller follows a time source");
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Alarm);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setAlarm2()");
+        return false;
+    }
+
+    // Set alarm 2 (minute precision)
+    activeRtc().setAlarm2(toRtcTime(dt), DS3231_A2_Minute);
+    DS3231_LOG_I("Alarm 2 set for %02d:%02d", dt.hour(), dt.minute());
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::enableBatteryBackup(bool enable) {
+    // DS3231 battery backup is hardware-based and always enabled when battery is present
+    DS3231_LOG_W("Battery backup is hardware-controlled on DS3231");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::isBatteryBackupEnabled() const {
+    if (!_initialized) {
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Config);
+    if (!lock.hasLock()) {
+        return false;
+    }
+
+    // Check if oscillator stop flag is set (indicates power loss)
+    RegisterSnapshot snapshot;
+    return currentSnapshot(snapshot) && !snapshot.oscillatorStopped();
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+float DS3231ControllerT<MaxSchedules, NameSize>::getBatteryVoltage() const {
+    // DS3231 doesn't provide battery voltage monitoring
+    DS3231_LOG_W("Battery voltage monitoring not available on DS3231");
+    return -1.0f;
+}
+
+// Timezone-aware time management
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setTimeFromUTC(uint32_t utcEpoch, int32_t offsetSeconds) {
+    // Validate input
+    if (utcEpoch < 946684800UL) { // Before year 2000
+        DS3231_LOG_E("Invalid UTC epoch: %lu (before year 2000)", utcEpoch);
+        return false;
+    }
+    
+    // With a time zone the RTC keeps UTC; otherwise it keeps local time
+    uint32_t rtcEpoch = _timeZoneEnabled ? utcEpoch : utcEpoch + offsetSeconds;
+    DateTime rtcTime(rtcEpoch);
+    
+    DS3231_LOG_D("Setting RTC from UTC: UTC epoch=%lu, offset=%ld, RTC epoch=%lu%s",
+                 utcEpoch, offsetSeconds, rtcEpoch, _timeZoneEnabled ? " (time zone, offset ignored)" : "");
+    DS3231_LOG_D("RTC time will be: %s", rtcTime.timestamp(DateTime::TIMESTAMP_FULL).c_str());
+    
+    // Debug: Let's see what DateTime thinks the components are
+    DS3231_LOG_D("DateTime components: %04d-%02d-%02d %02d:%02d:%02d",
+                 rtcTime.year(), rtcTime.month(), rtcTime.day(),
+                 rtcTime.hour(), rtcTime.minute(), rtcTime.second());
+    
+    // Extra validation
+    if (rtcTime.year() < 2000 || rtcTime.year() > 2100) {
+        DS3231_LOG_E("Invalid year %d after conversion - rejecting time update", rtcTime.year());
+        return false;
+    }
+
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+
+    {
+        StatsGuard lock(_mutex, _stats, StatOp::SetTime);
+        if (!lock.hasLock()) {
+            DS3231_LOG_E("Failed to acquire mutex for setTimeFromUTC()");
+            return false;
+        }
+        if (_drift.enabled && recordDriftSample(rtcEpoch)) {
+            return true;  // Already correct to the second
+        }
+        if (!writeRtcTime(rtcTime)) {
+            return false;
+        }
+        if (_drift.enabled) {
+            _drift.referenceEpoch = rtcEpoch;  // The stepped RTC starts a new interval
+        }
+    }
+
+    emitEvent(EventType::TimeChanged, toWallClock(rtcTime).unixtime());
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+uint32_t DS3231ControllerT<MaxSchedules, NameSize>::nowUTC(int32_t offsetSeconds) const {
+    if (_timeZoneEnabled) {
+        return rtcNow().unixtime();  // The RTC already keeps UTC
+    }
+
+    DateTime localTime = now();
+    uint32_t localEpoch = localTime.unixtime();
+    uint32_t utcEpoch = localEpoch - offsetSeconds;
+
+    DS3231_LOG_D("Converting RTC to UTC: local epoch=%lu, offset=%ld, UTC epoch=%lu",
+                 localEpoch, offsetSeconds, utcEpoch);
+
+    return utcEpoch;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::setTimeZone(const char* posixTz) {
+    DS3231TimeZone zone;
+    if (posixTz && !zone.parse(posixTz)) {
+        DS3231_LOG_E("Invalid POSIX TZ string '%s'", posixTz);
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for setTimeZone()");
+        return false;
+    }
+
+    _timeZone.update([&zone](DS3231TimeZone& tz) { tz = zone; });
+    _timeZoneEnabled = posixTz != nullptr;
+    _utcOffsetKnown = false;  // A new zone is not a DST transition
+    DS3231_LOG_I("Time zone %s", posixTz ? posixTz : "cleared, RTC keeps local time");
+
+    // Schedule edges moved in real time
+    notifyScheduler();
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+int32_t DS3231ControllerT<MaxSchedules, NameSize>::getUtcOffset() const {
+    if (!_timeZoneEnabled) {
+        return 0;
+    }
+    DateTime rtcTime = rtcNow();
+    if (!rtcTime.isValid()) {
+        return 0;
+    }
+    uint32_t utc = rtcTime.unixtime();
+    return _timeZone.read([utc](const DS3231TimeZone& tz) { return tz.offsetAt(utc); });
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::enableSecondEdgeCapture(int8_t pin) {
+    if (!_initialized) {
+        DS3231_LOG_E("RTC not initialized - call begin() first");
+        return false;
+    }
+    if (pin < 0 || _timeSource) {
+        return false;
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for enableSecondEdgeCapture()");
+        return false;
+    }
+
+    if (_edgePin == pin) {
+        return true;
+    }
+    if (_edgePin >= 0) {
+        detachInterrupt(digitalPinToInterrupt(_edgePin));
+    }
+
+    // INT/SQW is one pin: the square wave replaces the alarm interrupt, and
+    // the scheduler polls the alarm flags until capture is disabled
+    if (pin == _interruptPin) {
+        detachInterrupt(digitalPinToInterrupt(pin));
+        DS3231_LOG_W("Alarm interrupts on GPIO %d fall back to polling during edge capture", pin);
+    }
+
+    activeRtc().writeSqwPinMode(DS3231_SquareWave1Hz);
+    pinMode(pin, INPUT_PULLUP);  // Open-drain output
+    _edgePin = pin;
+    attachInterruptArg(digitalPinToInterrupt(pin), edgeIsr, this, FALLING);
+
+    DS3231_LOG_I("1 Hz edge capture enabled on GPIO %d", pin);
+    notifyScheduler();
+    return true;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void DS3231ControllerT<MaxSchedules, NameSize>::disableSecondEdgeCapture() {
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for disableSecondEdgeCapture()");
+        return;
+    }
+    if (_edgePin < 0) {
+        return;
+    }
+
+    detachInterrupt(digitalPinToInterrupt(_edgePin));
+    int8_t pin = _edgePin;
+    _edgePin = -1;
+
+    // INTCN=1: back to alarm interrupts, re-armed if they used this pin
+    activeRtc().writeSqwPinMode(DS3231_OFF);
+    if (pin == _interruptPin) {
+        attachInterruptArg(digitalPinToInterrupt(pin), alarmIsr, this, FALLING);
+        if (_schedulerTask) {
+            xTaskNotify(_schedulerTask, NOTIFY_ALARM, eSetBits);  // In case one fired meanwhile
+        }
+    }
+    DS3231_LOG_I("1 Hz edge capture disabled");
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+void IRAM_ATTR DS3231ControllerT<MaxSchedules, NameSize>::edgeIsr(void* arg) {
+    auto* self = static_cast<DS3231ControllerT*>(arg);
+    int64_t nowUs = esp_timer_get_time();
+    self->_edgeSeq.fetch_add(1, std::memory_order_seq_cst);
+    self->_edgeUs = nowUs;
+    self->_edgeSeq.fetch_add(1, std::memory_order_seq_cst);
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::lastSecondEdge(int64_t& edgeUs) const {
+    if (_edgePin < 0) {
+        return false;
+    }
+    for (;;) {
+        uint32_t seq = _edgeSeq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;  // ISR mid-update on the other core
+        }
+        int64_t us = _edgeUs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_edgeSeq.load(std::memory_order_relaxed) == seq) {
+            edgeUs = us;
+            return seq != 0 && us >= _edgeValidFromUs;
+        }
+    }
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+int64_t DS3231ControllerT<MaxSchedules, NameSize>::secondStartUs(int64_t readStartUs, int64_t readEndUs) const {
+    // The DS3231 latches the time registers at the start of a read. If the
+    // latest edge precedes that by under a second, it is where the second
+    // we read began. An edge during the read leaves the phase unknown.
+    int64_t edgeUs;
+    if (lastSecondEdge(edgeUs) && edgeUs <= readStartUs && readStartUs - edgeUs < 1000000LL) {
+        return edgeUs;
+    }
+    return readEndUs;
+}
+
+template <uint8_t MaxSchedules, size_t NameSize>
+bool DS3231ControllerT<MaxSchedules, NameSize>::syncSystemTime() const {
+    if (!_initialized) {
+        DS3231_LOG_E("Cannot sync system time - RTC not initialized");
+        return false;
+    }
+
+    // With edge capture, wait (without the mutex) for an edge if none is
+    // recent. Bounded by iterations so a dead SQW line cannot hang the caller.
+    int64_t edgeUs;
+    if (_edgePin >= 0) {
+        for (uint32_t waited = 0; waited < SECOND_EDGE_WAIT_MS; waited++) {
+            if (lastSecondEdge(edgeUs) && esp_timer_get_time() - edgeUs < 1000000LL) {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+    }
+
+    StatsGuard lock(_mutex, _stats, StatOp::Clock);
+    if (!lock.hasLock()) {
+        DS3231_LOG_E("Failed to acquire mutex for syncSystemTime()");
+        return false;
+    }
+
+    int64_t startUs = esp_timer_get_time();
+    bool holdover;
+    DateTime rtcTime = readRtcClock(&holdover);
+    if (!rtcTime.isValid() || holdover) {
+        DS3231_LOG_E("%s - cannot sync system time", holdover ? "RTC in holdover" : "Invalid RTC time");
+        return false;
+    }
+
+    // Sub-second phase from the edge that began the second we read, if any
+    int64_t secondStart = secondStartUs(startUs, -1);
+    bool aligned = secondStart >= 0;
+
+    struct timeval tv;
+    if (aligned) {
+        int64_t sinceEdgeUs = esp_timer_get_time() - secondStart;
+        tv.tv_sec = static_cast<time_t>(rtcTime.unixtime() + sinceEdgeUs / 1000000LL);
+        tv.tv_usec = static_cast<suseconds_t>(sinceEdgeUs % 1000000LL);
+    } else {
+        tv.tv_sec = static_cast<time_t>(rtcTime.unixtime());
+        tv.tv_usec = 0;  // No edge: whole-second resolution only
+    }
+
+    if (settimeofday(&tv, nullptr) != 0) {
+        DS3231_LOG_E("settimeofday() failed");
+        return false;
+    }
+
+    char timestamp[TIMESTAMP_SIZE];
+    formatTimestamp(rtcTime, timestamp, sizeof(timestamp));
+    if (aligned) {
+        DS3231_LOG_I("System time synced from RTC: %s, aligned to the SQW edge", timestamp);
+    } else {
+        DS3231_LOG_I("System time synced from RTC: %s (note: sub-second precision is 0)", timestamp);
+    }
+    return true;
+}
+
+#endif // DS3231_CONTROLLER_IMPL_H
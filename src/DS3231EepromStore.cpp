@@ -0,0 +1,230 @@
+/*
+ * DS3231EepromStore.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231EepromStore.h"
+#include "DS3231Controller.h"
+
+DS3231EepromStore::DS3231EepromStore(uint16_t regionStart, uint16_t regionSize, uint16_t slotSize, uint8_t address)
+    : _regionStart(regionStart), _slotSize(slotSize), _slotCount(0), _address(address) {
+    // Slots must start on page boundaries so no page write straddles two slots
+    if (regionStart % PAGE_SIZE == 0 && slotSize % PAGE_SIZE == 0 && slotSize > SLOT_HEADER_SIZE) {
+        _slotCount = regionSize / slotSize;
+    }
+}
+
+bool DS3231EepromStore::begin(TwoWire* wire, SemaphoreHandle_t busMutex) {
+    if (_slotCount == 0) {
+        DS3231_LOG_E("EEPROM region and slot size must be multiples of %d bytes", PAGE_SIZE);
+        return false;
+    }
+
+    _wire = wire;
+    _busMutex = busMutex;
+
+    {
+        RecursiveMutexGuard lock(_busMutex);
+        if (_busMutex && !lock.hasLock()) {
+            return false;
+        }
+        _wire->beginTransmission(_address);
+        if (_wire->endTransmission() != 0) {
+            DS3231_LOG_E("No EEPROM at 0x%02X", _address);
+            _wire = nullptr;
+            return false;
+        }
+    }
+
+    // Newest slot by sequence; its data is checked on load
+    _newestSlot = NO_SLOT;
+    _newestSequence = 0;
+    for (uint16_t slot = 0; slot < _slotCount; slot++) {
+        SlotHeader header;
+        if (readHeader(slot, header) && (_newestSlot == NO_SLOT || header.sequence > _newestSequence)) {
+            _newestSlot = slot;
+            _newestSequence = header.sequence;
+        }
+    }
+
+    DS3231_LOG_I("EEPROM store: %d slots of %d bytes, newest %d", _slotCount, _slotSize,
+                 _newestSlot == NO_SLOT ? -1 : _newestSlot);
+    return true;
+}
+
+bool DS3231EepromStore::load(uint8_t* buffer, size_t capacity, size_t& length) {
+    length = 0;
+    if (!_wire || !buffer || _newestSlot == NO_SLOT) {
+        return false;
+    }
+
+    // Normally one header read and one sequential data read of the slot
+    // begin() found; older slots are only scanned if its CRC fails
+    uint16_t slot = _newestSlot;
+    SlotHeader header;
+    if (!readHeader(slot, header)) {
+        return false;
+    }
+    for (uint16_t attempt = 0; attempt < _slotCount; attempt++) {
+        if (header.length <= capacity &&
+            readBytes(slotAddress(slot) + SLOT_HEADER_SIZE, buffer, header.length) &&
+            DS3231ControllerBase::crc16(buffer, header.length) == header.crc) {
+            length = header.length;
+            return true;
+        }
+        DS3231_LOG_W("EEPROM slot %d unreadable (%d bytes), trying an older one", slot, header.length);
+
+        uint32_t below = header.sequence;
+        bool found = false;
+        for (uint16_t candidate = 0; candidate < _slotCount; candidate++) {
+            SlotHeader older;
+            if (readHeader(candidate, older) && older.sequence < below &&
+                (!found || older.sequence > header.sequence)) {
+                slot = candidate;
+                header = older;
+                found = true;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+    return false;
+}
+
+bool DS3231EepromStore::save(const uint8_t* data, size_t length) {
+    if (!_wire || !data || length == 0 || length > getMaxBlobSize()) {
+        DS3231_LOG_E("Cannot store %d bytes in EEPROM slots of %d", length, _slotSize);
+        return false;
+    }
+
+    uint16_t slot = (_newestSlot == NO_SLOT) ? 0 : (_newestSlot + 1) % _slotCount;
+    uint32_t sequence = _newestSequence + 1;
+    uint16_t crc = DS3231ControllerBase::crc16(data, length);
+
+    uint8_t header[SLOT_HEADER_SIZE] = {
+        SLOT_MAGIC_0, SLOT_MAGIC_1,
+        static_cast<uint8_t>(sequence), static_cast<uint8_t>(sequence >> 8),
+        static_cast<uint8_t>(sequence >> 16), static_cast<uint8_t>(sequence >> 24),
+        static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+        static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8),
+    };
+
+    // Header and data go out as one image, a page at a time
+    size_t imageSize = SLOT_HEADER_SIZE + length;
+    uint8_t page[PAGE_SIZE];
+    for (size_t offset = 0; offset < imageSize; offset += PAGE_SIZE) {
+        size_t chunk = imageSize - offset < PAGE_SIZE ? imageSize - offset : PAGE_SIZE;
+        for (size_t i = 0; i < chunk; i++) {
+            size_t pos = offset + i;
+            page[i] = pos < SLOT_HEADER_SIZE ? header[pos] : data[pos - SLOT_HEADER_SIZE];
+        }
+        if (!writePage(slotAddress(slot) + offset, page, chunk)) {
+            DS3231_LOG_E("EEPROM write failed at slot %d offset %d", slot, offset);
+            return false;
+        }
+    }
+
+    _newestSlot = slot;
+    _newestSequence = sequence;
+    DS3231_LOG_D("Stored %d bytes in EEPROM slot %d (seq %lu)", length, slot, (unsigned long)sequence);
+    return true;
+}
+
+bool DS3231EepromStore::readHeader(uint16_t slot, SlotHeader& header) {
+    uint8_t raw[SLOT_HEADER_SIZE];
+    if (!readBytes(slotAddress(slot), raw, sizeof(raw))) {
+        return false;
+    }
+    if (raw[0] != SLOT_MAGIC_0 || raw[1] != SLOT_MAGIC_1) {
+        return false;  // Erased (0xFF) or foreign data
+    }
+
+    header.sequence = raw[2] | (raw[3] << 8) | (raw[4] << 16) | (static_cast<uint32_t>(raw[5]) << 24);
+    header.length = raw[6] | (raw[7] << 8);
+    header.crc = raw[8] | (raw[9] << 8);
+    return header.length > 0 && header.length <= getMaxBlobSize();
+}
+
+bool DS3231EepromStore::readBytes(uint16_t address, uint8_t* buffer, size_t length) {
+    // Sequential read, chunked to stay within the Wire buffer
+    while (length > 0) {
+        size_t chunk = length < PAGE_SIZE ? length : PAGE_SIZE;
+
+        RecursiveMutexGuard lock(_busMutex);
+        if (_busMutex && !lock.hasLock()) {
+            return false;
+        }
+        _wire->beginTransmission(_address);
+        _wire->write(static_cast<uint8_t>(address >> 8));
+        _wire->write(static_cast<uint8_t>(address));
+        if (_wire->endTransmission(false) != 0) {
+            return false;
+        }
+        if (_wire->requestFrom(_address, chunk, true) != chunk) {
+            return false;
+        }
+        for (size_t i = 0; i < chunk; i++) {
+            buffer[i] = _wire->read();
+        }
+
+        address += chunk;
+        buffer += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+bool DS3231EepromStore::writePage(uint16_t address, const uint8_t* data, size_t length) {
+    {
+        RecursiveMutexGuard lock(_busMutex);
+        if (_busMutex && !lock.hasLock()) {
+            return false;
+        }
+        _wire->beginTransmission(_address);
+        _wire->write(static_cast<uint8_t>(address >> 8));
+        _wire->write(static_cast<uint8_t>(address));
+        _wire->write(data, length);
+        if (_wire->endTransmission() != 0) {
+            return false;
+        }
+    }
+    return waitWriteCycle();
+}
+
+bool DS3231EepromStore::waitWriteCycle() {
+    // The EEPROM NAKs its address until the internal write completes. The bus
+    // is released between polls so the RTC stays reachable meanwhile.
+    uint32_t start = millis();
+    do {
+        {
+            RecursiveMutexGuard lock(_busMutex);
+            if (!_busMutex || lock.hasLock()) {
+                _wire->beginTransmission(_address);
+                if (_wire->endTransmission() == 0) {
+                    return true;
+                }
+            }
+        }
+        delay(1);
+    } while (millis() - start < WRITE_CYCLE_TIMEOUT_MS);
+
+    DS3231_LOG_E("EEPROM write cycle timed out");
+    return false;
+}
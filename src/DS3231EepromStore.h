@@ -0,0 +1,87 @@
+/*
+ * DS3231EepromStore.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_EEPROM_STORE_H
+#define DS3231_EEPROM_STORE_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "DS3231ScheduleStore.h"
+
+// Schedule store in the AT24C32 EEPROM found on most DS3231 modules (0x57).
+//
+// The region is split into equal page-aligned slots. Each save goes to the
+// slot after the newest one with a higher sequence number, so writes rotate
+// over the whole region and a torn write leaves the previous slot intact.
+// A slot is a 10-byte header (magic, sequence, length, CRC-16 of the data)
+// followed by the data, written in page-sized chunks.
+//
+// Pass the controller's getBusMutex() to begin() when the EEPROM shares the
+// bus with the DS3231; it is taken per page, not for a whole save.
+class DS3231EepromStore : public DS3231ScheduleStore {
+public:
+    static constexpr uint8_t DEFAULT_ADDRESS = 0x57;
+    static constexpr uint16_t PAGE_SIZE = 32;
+    static constexpr uint16_t AT24C32_SIZE = 4096;
+    static constexpr uint16_t DEFAULT_SLOT_SIZE = 512;  // Fits DS3231Controller::MAX_SCHEDULE_DATA_SIZE
+    static constexpr uint16_t SLOT_HEADER_SIZE = 10;
+
+    explicit DS3231EepromStore(uint16_t regionStart = 0, uint16_t regionSize = AT24C32_SIZE,
+                               uint16_t slotSize = DEFAULT_SLOT_SIZE, uint8_t address = DEFAULT_ADDRESS);
+
+    // Probes the EEPROM and locates the newest slot
+    [[nodiscard]] bool begin(TwoWire* wire = &Wire, SemaphoreHandle_t busMutex = nullptr);
+
+    bool load(uint8_t* buffer, size_t capacity, size_t& length) override;
+    bool save(const uint8_t* data, size_t length) override;
+
+    [[nodiscard]] uint16_t getSlotCount() const { return _slotCount; }
+    [[nodiscard]] size_t getMaxBlobSize() const { return _slotSize - SLOT_HEADER_SIZE; }
+
+private:
+    static constexpr uint8_t SLOT_MAGIC_0 = 0x57;
+    static constexpr uint8_t SLOT_MAGIC_1 = 0xD3;
+    static constexpr uint32_t WRITE_CYCLE_TIMEOUT_MS = 20;  // tWR is 10 ms max
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+    struct SlotHeader {
+        uint32_t sequence;
+        uint16_t length;
+        uint16_t crc;
+    };
+
+    bool readHeader(uint16_t slot, SlotHeader& header);
+    bool readBytes(uint16_t address, uint8_t* buffer, size_t length);
+    bool writePage(uint16_t address, const uint8_t* data, size_t length);
+    bool waitWriteCycle();
+    uint16_t slotAddress(uint16_t slot) const { return _regionStart + slot * _slotSize; }
+
+    TwoWire* _wire = nullptr;
+    SemaphoreHandle_t _busMutex = nullptr;
+    uint16_t _regionStart;
+    uint16_t _slotSize;
+    uint16_t _slotCount;
+    uint8_t _address;
+    uint16_t _newestSlot = NO_SLOT;
+    uint32_t _newestSequence = 0;
+};
+
+#endif // DS3231_EEPROM_STORE_H
@@ -0,0 +1,123 @@
+/*
+ * DS3231FixedStorage.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_FIXED_STORAGE_H
+#define DS3231_FIXED_STORAGE_H
+
+#include <Arduino.h>
+#include <string.h>
+
+// Inline, heap-free replacements for String and std::vector used when the
+// library is built with -DDS3231_STATIC_STORAGE. They implement only the
+// subset of the std/Arduino API the controller and its users rely on.
+
+// Fixed-capacity, always NUL-terminated string. Assignments longer than
+// Capacity - 1 characters are truncated.
+template <size_t Capacity>
+class DS3231FixedString {
+public:
+    static_assert(Capacity > 0, "DS3231FixedString needs room for the terminator");
+
+    DS3231FixedString() { _buf[0] = '\0'; }
+    DS3231FixedString(const char* str) { assign(str); }
+    DS3231FixedString(const String& str) { assign(str.c_str()); }
+
+    DS3231FixedString& operator=(const char* str) { assign(str); return *this; }
+    DS3231FixedString& operator=(const String& str) { assign(str.c_str()); return *this; }
+
+    const char* c_str() const { return _buf; }
+    size_t length() const { return strlen(_buf); }
+    bool isEmpty() const { return _buf[0] == '\0'; }
+    static constexpr size_t capacity() { return Capacity - 1; }
+
+    bool operator==(const char* str) const { return str && strcmp(_buf, str) == 0; }
+    bool operator!=(const char* str) const { return !(*this == str); }
+
+    // Lets existing code keep passing names to String-taking APIs
+    operator String() const { return String(_buf); }
+
+private:
+    void assign(const char* str) {
+        // Copy up to NUL or capacity; strnlen() with a bound past a short
+        // literal trips -Wstringop-overread once inlined
+        size_t len = 0;
+        if (str) {
+            while (len < Capacity - 1 && str[len] != '\0') {
+                _buf[len] = str[len];
+                len++;
+            }
+        }
+        _buf[len] = '\0';
+    }
+
+    char _buf[Capacity];
+};
+
+// Fixed-capacity sequence stored inline. push_back() on a full container
+// returns false and leaves it unchanged.
+template <typename T, size_t Capacity>
+class DS3231FixedVector {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    DS3231FixedVector() : _size(0) {}
+
+    iterator begin() { return _items; }
+    iterator end() { return _items + _size; }
+    const_iterator begin() const { return _items; }
+    const_iterator end() const { return _items + _size; }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    T& operator[](size_t index) { return _items[index]; }
+    const T& operator[](size_t index) const { return _items[index]; }
+
+    bool push_back(const T& item) {
+        if (_size >= Capacity) {
+            return false;
+        }
+        _items[_size++] = item;
+        return true;
+    }
+
+    iterator erase(iterator first, iterator last) {
+        iterator tail = first;
+        for (iterator it = last; it != end(); ++it) {
+            *tail++ = *it;
+        }
+        _size -= static_cast<size_t>(last - first);
+        return first;
+    }
+
+    iterator erase(iterator pos) { return erase(pos, pos + 1); }
+
+    void clear() { _size = 0; }
+
+private:
+    T _items[Capacity];
+    size_t _size;
+};
+
+#endif // DS3231_FIXED_STORAGE_H
@@ -0,0 +1,76 @@
+/*
+ * DS3231NvsStore.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231NvsStore.h"
+#include "DS3231ControllerLogging.h"
+
+DS3231NvsStore::DS3231NvsStore(const char* nvsNamespace, const char* key)
+    : _namespace(nvsNamespace), _key(key) {}
+
+DS3231NvsStore::~DS3231NvsStore() {
+    end();
+}
+
+bool DS3231NvsStore::begin() {
+    if (_open) {
+        return true;
+    }
+    if (!_prefs.begin(_namespace, false)) {
+        DS3231_LOG_E("Failed to open NVS namespace '%s'", _namespace);
+        return false;
+    }
+    _open = true;
+    return true;
+}
+
+void DS3231NvsStore::end() {
+    if (_open) {
+        _prefs.end();
+        _open = false;
+    }
+}
+
+bool DS3231NvsStore::load(uint8_t* buffer, size_t capacity, size_t& length) {
+    length = 0;
+    if (!_open || !buffer) {
+        return false;
+    }
+
+    // Preferences checks the blob size itself and returns 0 if it is missing or too large
+    length = _prefs.getBytes(_key, buffer, capacity);
+    return length > 0;
+}
+
+bool DS3231NvsStore::save(const uint8_t* data, size_t length) {
+    if (!_open || !data) {
+        return false;
+    }
+    if (_prefs.putBytes(_key, data, length) != length) {
+        DS3231_LOG_E("Failed to write %d bytes to NVS key '%s'", length, _key);
+        return false;
+    }
+    DS3231_LOG_D("Committed %d bytes to NVS key '%s'", length, _key);
+    return true;
+}
+
+bool DS3231NvsStore::erase() {
+    return _open && _prefs.remove(_key);
+}
@@ -0,0 +1,50 @@
+/*
+ * DS3231NvsStore.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NVS_STORE_H
+#define DS3231_NVS_STORE_H
+
+#include <Preferences.h>
+#include "DS3231ScheduleStore.h"
+
+// Schedule store backed by one NVS blob through Arduino Preferences.
+// The namespace stays open between begin() and end().
+class DS3231NvsStore : public DS3231ScheduleStore {
+public:
+    explicit DS3231NvsStore(const char* nvsNamespace = "ds3231", const char* key = "schedules");
+    ~DS3231NvsStore() override;
+
+    [[nodiscard]] bool begin();
+    void end();
+    [[nodiscard]] bool isOpen() const { return _open; }
+
+    bool load(uint8_t* buffer, size_t capacity, size_t& length) override;
+    bool save(const uint8_t* data, size_t length) override;
+    [[nodiscard]] bool erase();
+
+private:
+    Preferences _prefs;
+    const char* _namespace;
+    const char* _key;
+    bool _open = false;
+};
+
+#endif // DS3231_NVS_STORE_H
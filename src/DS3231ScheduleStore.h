@@ -0,0 +1,43 @@
+/*
+ * DS3231ScheduleStore.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_SCHEDULE_STORE_H
+#define DS3231_SCHEDULE_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Storage backend for the serialized schedule blob (see attachStore()). The
+// controller hands over complete v2 blobs; a backend only has to keep the
+// latest one. Calls are serialized by the controller.
+class DS3231ScheduleStore {
+public:
+    virtual ~DS3231ScheduleStore() = default;
+
+    // Copy the stored blob into buffer; false if nothing is stored or it does
+    // not fit. length receives the blob size.
+    virtual bool load(uint8_t* buffer, size_t capacity, size_t& length) = 0;
+
+    // Replace the stored blob
+    virtual bool save(const uint8_t* data, size_t length) = 0;
+};
+
+#endif // DS3231_SCHEDULE_STORE_H
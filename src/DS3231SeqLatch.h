@@ -0,0 +1,82 @@
+/*
+ * DS3231SeqLatch.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_SEQ_LATCH_H
+#define DS3231_SEQ_LATCH_H
+
+#include <atomic>
+#include <type_traits>
+
+// Sequence-counted pair of copies for read-mostly state shared across cores.
+//
+// A writer bumps the sequence (readers move to copy 1), updates copy 0, bumps
+// it again (readers move back to copy 0) and refreshes copy 1. A reader picks
+// the copy selected by the sequence parity and retries only if a writer made
+// progress meanwhile, so it never spins on a writer that was preempted
+// mid-update, even on the same core.
+//
+// Writers must be serialized by the caller. Readers may observe a torn copy
+// before the retry check, so read() callbacks must be side-effect free and
+// must bound-check any counts they index with.
+template <typename T>
+class DS3231SeqLatch {
+    static_assert(std::is_trivially_copyable<T>::value, "DS3231SeqLatch needs a trivially copyable type");
+
+public:
+    DS3231SeqLatch() : _seq(0), _copies{} {}
+    explicit DS3231SeqLatch(const T& initial) : _seq(0), _copies{initial, initial} {}
+
+    // Apply fn(T&) to the state. Caller serializes writers.
+    template <typename Fn>
+    void update(Fn&& fn) {
+        _seq.fetch_add(1, std::memory_order_seq_cst);
+        fn(_copies[0]);
+        _seq.fetch_add(1, std::memory_order_seq_cst);
+        _copies[1] = _copies[0];
+    }
+
+    // Evaluate fn(const T&) against a consistent copy and return its result
+    template <typename Fn>
+    auto read(Fn&& fn) const -> decltype(fn(std::declval<const T&>())) {
+        for (;;) {
+            uint32_t seq = _seq.load(std::memory_order_acquire);
+            auto result = fn(_copies[seq & 1]);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == seq) {
+                return result;
+            }
+        }
+    }
+
+    // Consistent snapshot by value
+    T load() const {
+        return read([](const T& value) { return value; });
+    }
+
+    // Direct access for code that already excludes writers
+    const T& stable() const { return _copies[0]; }
+
+private:
+    std::atomic<uint32_t> _seq;
+    T _copies[2];
+};
+
+#endif // DS3231_SEQ_LATCH_H
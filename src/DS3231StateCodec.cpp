@@ -0,0 +1,825 @@
+/*
+ * DS3231StateCodec.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231StateCodec.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+// CBOR major types (RFC 8949 section 3.1)
+constexpr uint8_t CBOR_UNSIGNED = 0;
+constexpr uint8_t CBOR_NEGATIVE = 1;
+constexpr uint8_t CBOR_BYTES = 2;
+constexpr uint8_t CBOR_TEXT = 3;
+constexpr uint8_t CBOR_ARRAY = 4;
+constexpr uint8_t CBOR_MAP = 5;
+constexpr uint8_t CBOR_TAG = 6;
+constexpr uint8_t CBOR_SIMPLE = 7;
+
+constexpr uint8_t CBOR_INDEFINITE = 31;
+constexpr uint8_t CBOR_FALSE = 0xF4;
+constexpr uint8_t CBOR_TRUE = 0xF5;
+constexpr uint8_t CBOR_NULL = 0xF6;
+constexpr uint8_t CBOR_FLOAT32 = 0xFA;
+constexpr uint8_t CBOR_BREAK = 0xFF;
+constexpr uint8_t CBOR_TAG_EPOCH = 0xC1;  // Tag 1: seconds since 1970
+
+constexpr uint32_t READER_INDEFINITE = 0xFFFFFFFF;
+
+bool isJsonSpace(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+int hexDigit(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+double halfToDouble(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+// Fixed-width decimal field; false on a non-digit
+bool parseDigits(const char*& p, uint8_t count, int& out) {
+    out = 0;
+    for (uint8_t i = 0; i < count; i++, p++) {
+        if (*p < '0' || *p > '9') return false;
+        out = out * 10 + (*p - '0');
+    }
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Writer
+
+void DS3231StateWriter::write(const uint8_t* data, size_t length) {
+    size_t n = _out.write(data, length);
+    _written += n;
+    if (n != length) {
+        _failed = true;
+    }
+}
+
+void DS3231StateWriter::separator() {
+    if (_format != DS3231StateFormat::Json) return;
+    if (_afterKey) {
+        _afterKey = false;
+        return;
+    }
+    if (_depth == 0) return;
+    uint8_t bit = 1u << (_depth - 1);
+    if (_hasItems & bit) {
+        write(',');
+    }
+    _hasItems |= bit;
+}
+
+void DS3231StateWriter::cborHeader(uint8_t major, uint64_t argument) {
+    uint8_t buf[9];
+    uint8_t length;
+    uint8_t type = major << 5;
+    if (argument < 24) {
+        buf[0] = type | static_cast<uint8_t>(argument);
+        length = 1;
+    } else if (argument <= 0xFF) {
+        buf[0] = type | 24;
+        length = 2;
+    } else if (argument <= 0xFFFF) {
+        buf[0] = type | 25;
+        length = 3;
+    } else if (argument <= 0xFFFFFFFFULL) {
+        buf[0] = type | 26;
+        length = 5;
+    } else {
+        buf[0] = type | 27;
+        length = 9;
+    }
+    for (uint8_t i = length - 1; i > 0; i--) {  // Big-endian
+        buf[i] = static_cast<uint8_t>(argument);
+        argument >>= 8;
+    }
+    write(buf, length);
+}
+
+void DS3231StateWriter::jsonString(const char* text) {
+    write('"');
+    const char* run = text;
+    for (const char* p = text; ; p++) {
+        uint8_t c = static_cast<uint8_t>(*p);
+        if (c != 0 && c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        if (p > run) {
+            write(reinterpret_cast<const uint8_t*>(run), p - run);
+        }
+        if (c == 0) break;
+        char escape[7];
+        switch (c) {
+            case '"': write("\\\""); break;
+            case '\\': write("\\\\"); break;
+            case '\n': write("\\n"); break;
+            case '\r': write("\\r"); break;
+            case '\t': write("\\t"); break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                write(escape);
+                break;
+        }
+        run = p + 1;
+    }
+    write('"');
+}
+
+void DS3231StateWriter::beginContainer(bool isMap, uint32_t count) {
+    if (_depth >= MAX_DEPTH) {
+        _failed = true;
+        return;
+    }
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        write(static_cast<uint8_t>(isMap ? '{' : '['));
+    } else if (count == INDEFINITE) {
+        write(static_cast<uint8_t>(((isMap ? CBOR_MAP : CBOR_ARRAY) << 5) | CBOR_INDEFINITE));
+    } else {
+        cborHeader(isMap ? CBOR_MAP : CBOR_ARRAY, count);
+    }
+
+    uint8_t bit = 1u << _depth;
+    _maps = isMap ? (_maps | bit) : (_maps & ~bit);
+    _indefinite = count == INDEFINITE ? (_indefinite | bit) : (_indefinite & ~bit);
+    _hasItems &= ~bit;
+    _depth++;
+}
+
+void DS3231StateWriter::end() {
+    if (_depth == 0) return;
+    _depth--;
+    uint8_t bit = 1u << _depth;
+    if (_format == DS3231StateFormat::Json) {
+        write(static_cast<uint8_t>((_maps & bit) ? '}' : ']'));
+    } else if (_indefinite & bit) {
+        write(CBOR_BREAK);
+    }
+}
+
+void DS3231StateWriter::key(const char* name) {
+    if (_format == DS3231StateFormat::Json) {
+        separator();
+        jsonString(name);
+        write(':');
+        _afterKey = true;
+    } else {
+        value(name);
+    }
+}
+
+void DS3231StateWriter::value(const char* text) {
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        jsonString(text);
+    } else {
+        size_t length = strlen(text);
+        cborHeader(CBOR_TEXT, length);
+        write(reinterpret_cast<const uint8_t*>(text), length);
+    }
+}
+
+void DS3231StateWriter::value(bool flag) {
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        write(flag ? "true" : "false");
+    } else {
+        write(flag ? CBOR_TRUE : CBOR_FALSE);
+    }
+}
+
+void DS3231StateWriter::value(int32_t number) {
+    if (number >= 0) {
+        value(static_cast<uint32_t>(number));
+        return;
+    }
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        char text[12];
+        snprintf(text, sizeof(text), "%ld", static_cast<long>(number));
+        write(text);
+    } else {
+        cborHeader(CBOR_NEGATIVE, static_cast<uint64_t>(-(static_cast<int64_t>(number) + 1)));
+    }
+}
+
+void DS3231StateWriter::value(uint32_t number) {
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        char text[11];
+        snprintf(text, sizeof(text), "%lu", static_cast<unsigned long>(number));
+        write(text);
+    } else {
+        cborHeader(CBOR_UNSIGNED, number);
+    }
+}
+
+void DS3231StateWriter::value(float number, uint8_t decimals) {
+    if (_format == DS3231StateFormat::Json) {
+        if (!isfinite(number)) {
+            null();  // JSON has no NaN or infinity
+            return;
+        }
+        separator();
+        char text[24];
+        snprintf(text, sizeof(text), "%.*f", decimals, static_cast<double>(number));
+        write(text);
+    } else {
+        separator();
+        uint32_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        uint8_t buf[5] = {CBOR_FLOAT32, static_cast<uint8_t>(bits >> 24), static_cast<uint8_t>(bits >> 16),
+                          static_cast<uint8_t>(bits >> 8), static_cast<uint8_t>(bits)};
+        write(buf, sizeof(buf));
+    }
+}
+
+void DS3231StateWriter::null() {
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        write("null");
+    } else {
+        write(CBOR_NULL);
+    }
+}
+
+void DS3231StateWriter::timeOfDay(uint8_t hour, uint8_t minute) {
+    if (_format == DS3231StateFormat::Json) {
+        separator();
+        char text[12];
+        snprintf(text, sizeof(text), "\"%02u:%02u\"", hour, minute);
+        write(text);
+    } else {
+        value(static_cast<uint32_t>(hour * 60 + minute));
+    }
+}
+
+void DS3231StateWriter::dateTime(const DateTime& dt) {
+    if (!dt.isValid()) {
+        null();
+        return;
+    }
+    separator();
+    if (_format == DS3231StateFormat::Json) {
+        char text[32];
+        snprintf(text, sizeof(text), "\"%04u-%02u-%02uT%02u:%02u:%02u\"", dt.year(), dt.month(), dt.day(),
+                 dt.hour(), dt.minute(), dt.second());
+        write(text);
+    } else {
+        write(CBOR_TAG_EPOCH);
+        cborHeader(CBOR_UNSIGNED, dt.unixtime());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+
+bool DS3231StateReader::feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length && _state != State::Failed; i++) {
+        _position++;
+        if (_format == DS3231StateFormat::Json) {
+            feedJson(data[i]);
+        } else {
+            feedCbor(data[i]);
+        }
+    }
+    return _state != State::Failed;
+}
+
+DS3231StateReader::Error DS3231StateReader::finish() {
+    // A bare top-level number has no terminator
+    if (_format == DS3231StateFormat::Json && _state == State::Number && _depth == 0) {
+        finishNumber();
+    }
+    if (_state != State::Done && _state != State::Failed) {
+        fail(Error::Incomplete);
+    }
+    return _error;
+}
+
+void DS3231StateReader::fail(Error error) {
+    _state = State::Failed;
+    _error = error;
+}
+
+bool DS3231StateReader::push(bool isMap, uint32_t remaining) {
+    if (_depth >= MAX_DEPTH) {
+        fail(Error::TooDeep);
+        return false;
+    }
+    uint8_t bit = 1u << _depth;
+    _maps = isMap ? (_maps | bit) : (_maps & ~bit);
+    _keyNext = isMap ? (_keyNext | bit) : (_keyNext & ~bit);
+    _remaining[_depth] = remaining;
+    _depth++;
+    _handler.beginContainer(isMap);
+    return true;
+}
+
+void DS3231StateReader::pop() {
+    _depth--;
+    _handler.endContainer();
+}
+
+void DS3231StateReader::completed() {
+    if (_depth == 0) {
+        _state = State::Done;
+        return;
+    }
+    if (_format == DS3231StateFormat::Json) {
+        _state = State::AfterValue;
+        return;
+    }
+
+    uint8_t top = _depth - 1;
+    uint8_t bit = 1u << top;
+    if (_maps & bit) {
+        _keyNext ^= bit;
+    }
+    _state = State::Header;
+    if (_remaining[top] != READER_INDEFINITE && --_remaining[top] == 0) {
+        pop();
+        completed();
+    }
+}
+
+void DS3231StateReader::appendText(uint8_t c) {
+    if (_textLength < TEXT_CAPACITY - 1) {
+        _text[_textLength++] = static_cast<char>(c);
+    } else {
+        _textTruncated = true;
+    }
+}
+
+void DS3231StateReader::appendUtf8(uint32_t codepoint) {
+    if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+        codepoint = 0xFFFD;  // Surrogate halves are not combined
+    }
+    if (codepoint < 0x80) {
+        appendText(codepoint);
+    } else if (codepoint < 0x800) {
+        appendText(0xC0 | (codepoint >> 6));
+        appendText(0x80 | (codepoint & 0x3F));
+    } else {
+        appendText(0xE0 | (codepoint >> 12));
+        appendText(0x80 | ((codepoint >> 6) & 0x3F));
+        appendText(0x80 | (codepoint & 0x3F));
+    }
+}
+
+void DS3231StateReader::emitScalar(const Value& value) {
+    bool isKey;
+    if (_format == DS3231StateFormat::Json) {
+        isKey = _textIsKey;
+        _textIsKey = false;
+    } else {
+        isKey = _depth > 0 && (_keyNext & (1u << (_depth - 1)));
+    }
+
+    if (isKey) {
+        if (value.type != Value::Type::Text) {
+            fail(Error::Syntax);  // Only text keys
+            return;
+        }
+        _handler.key(value.text);
+        if (_format == DS3231StateFormat::Json) {
+            _state = State::Colon;
+            return;
+        }
+    } else {
+        _handler.value(value);
+    }
+    completed();
+}
+
+void DS3231StateReader::emitText() {
+    _text[_textLength] = '\0';
+    Value value = {};
+    value.type = Value::Type::Text;
+    value.text = _text;
+    value.truncated = _textTruncated;
+    emitScalar(value);
+}
+
+void DS3231StateReader::finishNumber() {
+    _text[_textLength] = '\0';
+    Value value = {};
+    char* end = nullptr;
+    bool real = strpbrk(_text, ".eE") != nullptr;
+    if (!real) {
+        errno = 0;
+        long long integer = strtoll(_text, &end, 10);
+        if (errno == ERANGE) {
+            real = true;
+        } else {
+            value.type = Value::Type::Integer;
+            value.integer = integer;
+            value.real = static_cast<double>(integer);
+        }
+    }
+    if (real) {
+        value.type = Value::Type::Real;
+        value.real = strtod(_text, &end);
+    }
+    if (_textLength == 0 || end != _text + _textLength) {
+        fail(Error::Syntax);
+        return;
+    }
+    emitScalar(value);
+}
+
+void DS3231StateReader::feedJson(uint8_t c) {
+    switch (_state) {
+        case State::Value:
+            if (isJsonSpace(c)) return;
+            _textLength = 0;
+            _textTruncated = false;
+            if (c == '{' || c == '[') {
+                if (push(c == '{', READER_INDEFINITE)) {
+                    _state = c == '{' ? State::Key : State::Value;
+                    _canClose = true;
+                }
+                return;
+            }
+            if (c == ']' && _canClose && _depth > 0 && !(_maps & (1u << (_depth - 1)))) {
+                pop();
+                completed();
+            } else if (c == '"') {
+                _state = State::String;
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                appendText(c);
+                _state = State::Number;
+            } else if (c == 't' || c == 'f' || c == 'n') {
+                _literal = c == 't' ? "true" : (c == 'f' ? "false" : "null");
+                _literalIndex = 1;
+                _state = State::Literal;
+            } else {
+                fail(Error::Syntax);
+            }
+            _canClose = false;
+            return;
+
+        case State::Key:
+            if (isJsonSpace(c)) return;
+            if (c == '"') {
+                _textLength = 0;
+                _textTruncated = false;
+                _textIsKey = true;
+                _state = State::String;
+            } else if (c == '}' && _canClose) {
+                pop();
+                completed();
+            } else {
+                fail(Error::Syntax);
+            }
+            return;
+
+        case State::Colon:
+            if (isJsonSpace(c)) return;
+            if (c == ':') {
+                _state = State::Value;
+            } else {
+                fail(Error::Syntax);
+            }
+            return;
+
+        case State::AfterValue: {
+            if (isJsonSpace(c)) return;
+            bool inMap = (_maps & (1u << (_depth - 1))) != 0;
+            if (c == ',') {
+                _state = inMap ? State::Key : State::Value;
+                _canClose = false;  // No trailing commas
+            } else if (c == (inMap ? '}' : ']')) {
+                pop();
+                completed();
+            } else {
+                fail(Error::Syntax);
+            }
+            return;
+        }
+
+        case State::String:
+            if (c == '"') {
+                emitText();
+            } else if (c == '\\') {
+                _state = State::Escape;
+            } else if (c < 0x20) {
+                fail(Error::Syntax);
+            } else {
+                appendText(c);
+            }
+            return;
+
+        case State::Escape:
+            _state = State::String;
+            switch (c) {
+                case '"': case '\\': case '/': appendText(c); return;
+                case 'b': appendText('\b'); return;
+                case 'f': appendText('\f'); return;
+                case 'n': appendText('\n'); return;
+                case 'r': appendText('\r'); return;
+                case 't': appendText('\t'); return;
+                case 'u':
+                    _unicode = 0;
+                    _unicodeDigits = 0;
+                    _state = State::Unicode;
+                    return;
+                default:
+                    fail(Error::Syntax);
+                    return;
+            }
+
+        case State::Unicode: {
+            int digit = hexDigit(c);
+            if (digit < 0) {
+                fail(Error::Syntax);
+                return;
+            }
+            _unicode = (_unicode << 4) | digit;
+            if (++_unicodeDigits == 4) {
+                appendUtf8(_unicode);
+                _state = State::String;
+            }
+            return;
+        }
+
+        case State::Number:
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                if (_textLength >= TEXT_CAPACITY - 1) {
+                    fail(Error::Syntax);
+                    return;
+                }
+                appendText(c);
+                return;
+            }
+            finishNumber();
+            if (_state != State::Failed) {
+                feedJson(c);  // The terminator belongs to what follows
+            }
+            return;
+
+        case State::Literal:
+            if (c != static_cast<uint8_t>(_literal[_literalIndex])) {
+                fail(Error::Syntax);
+                return;
+            }
+            if (_literal[++_literalIndex] == '\0') {
+                Value value = {};
+                if (_literal[0] == 'n') {
+                    value.type = Value::Type::Null;
+                } else {
+                    value.type = Value::Type::Boolean;
+                    value.boolean = _literal[0] == 't';
+                }
+                emitScalar(value);
+            }
+            return;
+
+        case State::Done:
+            if (!isJsonSpace(c)) fail(Error::Syntax);
+            return;
+
+        default:
+            fail(Error::Syntax);
+            return;
+    }
+}
+
+void DS3231StateReader::cborItem() {
+    bool keyPosition = _depth > 0 && (_keyNext & (1u << (_depth - 1)));
+    Value value = {};
+
+    switch (_major) {
+        case CBOR_UNSIGNED:
+        case CBOR_NEGATIVE:
+            if (_argument > static_cast<uint64_t>(INT64_MAX)) {
+                value.type = Value::Type::Real;
+                value.real = static_cast<double>(_argument);
+                if (_major == CBOR_NEGATIVE) value.real = -1.0 - value.real;
+            } else {
+                value.type = Value::Type::Integer;
+                value.integer = _major == CBOR_UNSIGNED ? static_cast<int64_t>(_argument)
+                                                        : -1 - static_cast<int64_t>(_argument);
+                value.real = static_cast<double>(value.integer);
+            }
+            emitScalar(value);
+            return;
+
+        case CBOR_BYTES:
+        case CBOR_TEXT:
+            _textLength = 0;
+            _textTruncated = false;
+            _payloadLeft = _argument;
+            if (_payloadLeft == 0) {
+                emitText();
+            } else {
+                _state = State::Payload;
+            }
+            return;
+
+        case CBOR_ARRAY:
+        case CBOR_MAP:
+            if (keyPosition || _argument > 0x7FFFFFFF) {
+                fail(Error::Syntax);
+                return;
+            }
+            if (push(_major == CBOR_MAP, static_cast<uint32_t>(_major == CBOR_MAP ? _argument * 2 : _argument))) {
+                _state = State::Header;
+                if (_argument == 0) {
+                    pop();
+                    completed();
+                }
+            }
+            return;
+
+        case CBOR_TAG:
+            _state = State::Header;  // Tags annotate the next item; the importer reads epochs either way
+            return;
+
+        default:  // CBOR_SIMPLE
+            switch (_additional) {
+                case 20: case 21:
+                    value.type = Value::Type::Boolean;
+                    value.boolean = _additional == 21;
+                    break;
+                case 25:
+                    value.type = Value::Type::Real;
+                    value.real = halfToDouble(static_cast<uint16_t>(_argument));
+                    break;
+                case 26: {
+                    uint32_t bits = static_cast<uint32_t>(_argument);
+                    float f;
+                    memcpy(&f, &bits, sizeof(f));
+                    value.type = Value::Type::Real;
+                    value.real = f;
+                    break;
+                }
+                case 27:
+                    value.type = Value::Type::Real;
+                    memcpy(&value.real, &_argument, sizeof(value.real));
+                    break;
+                default:  // null, undefined and unassigned simple values
+                    value.type = Value::Type::Null;
+                    break;
+            }
+            emitScalar(value);
+            return;
+    }
+}
+
+void DS3231StateReader::feedCbor(uint8_t c) {
+    switch (_state) {
+        case State::Value:  // Initial state
+        case State::Header:
+            _major = c >> 5;
+            _additional = c & 0x1F;
+            _argument = 0;
+            if (_additional < 24) {
+                _argument = _additional;
+                cborItem();
+            } else if (_additional <= 27) {
+                _argumentBytes = 1u << (_additional - 24);
+                _state = State::Argument;
+            } else if (_additional != CBOR_INDEFINITE) {
+                fail(Error::Syntax);
+            } else if (_major == CBOR_ARRAY || _major == CBOR_MAP) {
+                bool keyPosition = _depth > 0 && (_keyNext & (1u << (_depth - 1)));
+                if (keyPosition) {
+                    fail(Error::Syntax);
+                } else if (push(_major == CBOR_MAP, READER_INDEFINITE)) {
+                    _state = State::Header;
+                }
+            } else if (c == CBOR_BREAK && _depth > 0 && _remaining[_depth - 1] == READER_INDEFINITE &&
+                       (!(_maps & (1u << (_depth - 1))) || (_keyNext & (1u << (_depth - 1))))) {
+                pop();
+                completed();
+            } else {
+                fail(Error::Syntax);  // Indefinite strings, or a stray or mid-pair break
+            }
+            return;
+
+        case State::Argument:
+            _argument = (_argument << 8) | c;
+            if (--_argumentBytes == 0) {
+                cborItem();
+            }
+            return;
+
+        case State::Payload:
+            appendText(c);
+            if (--_payloadLeft == 0) {
+                emitText();
+            }
+            return;
+
+        default:  // Done: one document per reader
+            fail(Error::Syntax);
+            return;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Field helpers
+
+bool ds3231ParseTimeOfDay(const DS3231StateReader::Value& value, uint8_t& hour, uint8_t& minute) {
+    using Type = DS3231StateReader::Value::Type;
+    if (value.type == Type::Integer) {
+        if (value.integer < 0 || value.integer >= 24 * 60) return false;
+        hour = static_cast<uint8_t>(value.integer / 60);
+        minute = static_cast<uint8_t>(value.integer % 60);
+        return true;
+    }
+    if (value.type != Type::Text) return false;
+
+    const char* p = value.text;
+    int h, m;
+    uint8_t hourDigits = (p[0] && p[1] == ':') ? 1 : 2;
+    if (!parseDigits(p, hourDigits, h) || *p++ != ':' || !parseDigits(p, 2, m) || *p != '\0') {
+        return false;
+    }
+    if (h > 23 || m > 59) return false;
+    hour = static_cast<uint8_t>(h);
+    minute = static_cast<uint8_t>(m);
+    return true;
+}
+
+bool ds3231ParseDateTime(const DS3231StateReader::Value& value, DateTime& out) {
+    using Type = DS3231StateReader::Value::Type;
+    switch (value.type) {
+        case Type::Null:
+            out = DateTime(2000, 0, 0);  // Same invalid marker as the controller
+            return true;
+        case Type::Integer:
+            if (value.integer < 946684800LL || value.integer > 0xFFFFFFFFLL) return false;  // 2000 onwards
+            out = DateTime(static_cast<uint32_t>(value.integer));
+            return true;
+        case Type::Text:
+            break;
+        default:
+            return false;
+    }
+
+    const char* p = value.text;
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    if (!parseDigits(p, 4, year) || *p++ != '-' || !parseDigits(p, 2, month) || *p++ != '-' ||
+        !parseDigits(p, 2, day)) {
+        return false;
+    }
+    if (*p == 'T' || *p == ' ') {
+        p++;
+        if (!parseDigits(p, 2, hour) || *p++ != ':' || !parseDigits(p, 2, minute)) return false;
+        if (*p == ':') {
+            p++;
+            if (!parseDigits(p, 2, second)) return false;
+        }
+        if (*p == 'Z') p++;
+    }
+    if (*p != '\0' || year < 2000 || year > 2099 || hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+
+    DateTime parsed(year, month, day, hour, minute, second);
+    if (!parsed.isValid()) return false;  // Month or day out of range
+    out = parsed;
+    return true;
+}
@@ -0,0 +1,205 @@
+/*
+ * DS3231StateCodec.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_STATE_CODEC_H
+#define DS3231_STATE_CODEC_H
+
+#include <Arduino.h>
+#include <RTClib.h>
+
+// Streaming JSON and CBOR for the controller state document. Both sides work
+// in constant memory: the writer goes straight to a Print, and the reader is
+// a byte-at-a-time state machine that reports values to a handler as soon
+// as they are complete.
+
+enum class DS3231StateFormat : uint8_t {
+    Json,
+    Cbor,  // RFC 8949; times of day as minutes, date-times as tag 1 epochs
+};
+
+// Writes maps, arrays and scalars to a Print without buffering
+class DS3231StateWriter {
+public:
+    static constexpr uint8_t MAX_DEPTH = 8;
+    static constexpr uint32_t INDEFINITE = 0xFFFFFFFF;  // CBOR length unknown up front
+
+    DS3231StateWriter(Print& out, DS3231StateFormat format) : _out(out), _format(format) {}
+
+    // count is the number of entries (pairs for maps); JSON ignores it
+    void beginMap(uint32_t count = INDEFINITE) { beginContainer(true, count); }
+    void beginArray(uint32_t count = INDEFINITE) { beginContainer(false, count); }
+    void end();
+
+    void key(const char* name);
+    void value(const char* text);
+    void value(bool flag);
+    void value(int32_t number);
+    void value(uint32_t number);
+    void value(float number, uint8_t decimals = 2);
+    void null();
+    void timeOfDay(uint8_t hour, uint8_t minute);  // "HH:MM", or CBOR minutes since midnight
+    void dateTime(const DateTime& dt);             // ISO 8601, or CBOR tag 1 epoch; null if invalid
+
+    size_t bytesWritten() const { return _written; }
+    bool failed() const { return _failed; }  // The Print took fewer bytes than offered
+
+private:
+    void beginContainer(bool isMap, uint32_t count);
+    void separator();  // JSON comma before array items and map keys
+    void write(const uint8_t* data, size_t length);
+    void write(uint8_t byte) { write(&byte, 1); }
+    void write(const char* text) { write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+    void cborHeader(uint8_t major, uint64_t argument);
+    void jsonString(const char* text);
+
+    Print& _out;
+    DS3231StateFormat _format;
+    uint8_t _depth = 0;
+    uint8_t _maps = 0;        // Bit per depth: container is a map
+    uint8_t _indefinite = 0;  // Bit per depth: CBOR needs a break on end()
+    uint8_t _hasItems = 0;    // Bit per depth: JSON needs a comma before the next item
+    bool _afterKey = false;
+    bool _failed = false;
+    size_t _written = 0;
+};
+
+// Incremental reader. feed() accepts any split of the input; the handler
+// sees every map key before its value and is called from inside feed().
+class DS3231StateReader {
+public:
+    static constexpr uint8_t MAX_DEPTH = 8;
+    static constexpr size_t TEXT_CAPACITY = 64;  // Longer strings are truncated
+
+    enum class Error : uint8_t {
+        None = 0,
+        Syntax,      // Malformed input or unsupported construct
+        TooDeep,     // More than MAX_DEPTH nested containers
+        Incomplete,  // finish() before the document ended
+    };
+
+    struct Value {
+        enum class Type : uint8_t { Text, Integer, Real, Boolean, Null };
+        Type type;
+        const char* text;  // Text: NUL-terminated, possibly truncated
+        int64_t integer;   // Integer
+        double real;       // Real, and Integer converted
+        bool boolean;      // Boolean
+        bool truncated;    // Text was longer than TEXT_CAPACITY - 1
+    };
+
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual void beginContainer(bool isMap) = 0;
+        virtual void endContainer() = 0;
+        virtual void key(const char* name) = 0;
+        virtual void value(const Value& value) = 0;
+    };
+
+    DS3231StateReader(Handler& handler, DS3231StateFormat format) : _handler(handler), _format(format) {}
+
+    // False once an error stops the reader; bytes after the document are an error
+    bool feed(const uint8_t* data, size_t length);
+    Error finish();  // Incomplete unless exactly one whole document was fed
+
+    bool done() const { return _state == State::Done; }
+    Error error() const { return _error; }
+    size_t position() const { return _position; }  // Bytes consumed
+
+private:
+    enum class State : uint8_t {
+        // JSON
+        Value, Key, Colon, AfterValue, String, Escape, Unicode, Number, Literal,
+        // CBOR
+        Header, Argument, Payload,
+        Done, Failed
+    };
+
+    void feedJson(uint8_t c);
+    void feedCbor(uint8_t c);
+    void fail(Error error);
+    bool push(bool isMap, uint32_t remaining);
+    void pop();
+    void completed();  // A whole item (scalar or container) ended at the current depth
+    void emitText();
+    void emitScalar(const Value& value);
+    void appendText(uint8_t c);
+    void appendUtf8(uint32_t codepoint);
+    void finishNumber();
+    void cborItem();  // Header and argument are complete
+
+    Handler& _handler;
+    DS3231StateFormat _format;
+    State _state = State::Value;
+    Error _error = Error::None;
+    size_t _position = 0;
+
+    // Container stack
+    uint8_t _depth = 0;
+    uint8_t _maps = 0;      // Bit per depth: map
+    uint8_t _keyNext = 0;   // Bit per depth: next item is a key
+    uint32_t _remaining[MAX_DEPTH] = {};  // CBOR items left, or INDEFINITE
+
+    // Current token
+    char _text[TEXT_CAPACITY];
+    size_t _textLength = 0;
+    bool _textTruncated = false;
+    bool _textIsKey = false;
+    bool _canClose = false;  // JSON: container just opened, so it may close at once
+    uint32_t _unicode = 0;
+    uint8_t _unicodeDigits = 0;
+    const char* _literal = nullptr;
+    uint8_t _literalIndex = 0;
+
+    // CBOR header
+    uint8_t _major = 0;
+    uint8_t _additional = 0;
+    uint8_t _argumentBytes = 0;
+    uint64_t _argument = 0;
+    uint64_t _payloadLeft = 0;
+};
+
+enum class DS3231StateImportError : uint8_t {
+    None = 0,
+    Syntax,
+    TooDeep,
+    Incomplete,
+    Locked,  // Controller mutex not acquired
+};
+
+// Outcome of a state import; schedules are applied as each record completes
+struct DS3231StateImportResult {
+    DS3231StateImportError error;
+    uint8_t added;
+    uint8_t updated;
+    uint8_t removed;   // Only with replaceSchedules
+    uint8_t rejected;  // Records with out-of-range fields, or with no room left
+    size_t bytes;
+
+    bool ok() const { return error == DS3231StateImportError::None && rejected == 0; }
+};
+
+// Shared by the importer: "HH:MM", or minutes since midnight
+bool ds3231ParseTimeOfDay(const DS3231StateReader::Value& value, uint8_t& hour, uint8_t& minute);
+// "YYYY-MM-DD", "YYYY-MM-DDTHH:MM:SS", or a unix epoch; null gives an invalid DateTime
+bool ds3231ParseDateTime(const DS3231StateReader::Value& value, DateTime& out);
+
+#endif // DS3231_STATE_CODEC_H
@@ -0,0 +1,123 @@
+/*
+ * DS3231Stats.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231Stats.h"
+
+const char* DS3231Stats::opName(DS3231StatOp op) {
+    switch (op) {
+        case DS3231StatOp::Begin: return "begin";
+        case DS3231StatOp::Now: return "now";
+        case DS3231StatOp::SetTime: return "set_time";
+        case DS3231StatOp::Snapshot: return "snapshot";
+        case DS3231StatOp::Schedules: return "schedules";
+        case DS3231StatOp::Evaluate: return "evaluate";
+        case DS3231StatOp::Temperature: return "temperature";
+        case DS3231StatOp::Alarm: return "alarm";
+        case DS3231StatOp::Events: return "events";
+        case DS3231StatOp::Persistence: return "persistence";
+        case DS3231StatOp::BusJob: return "bus_job";
+        case DS3231StatOp::Clock: return "clock";
+        case DS3231StatOp::Config: return "config";
+        default: return "unknown";
+    }
+}
+
+const char* DS3231Stats::errorName(DS3231StatError error) {
+    switch (error) {
+        case DS3231StatError::None: return "none";
+        case DS3231StatError::LockTimeout: return "lock_timeout";
+        case DS3231StatError::I2cAddressNack: return "i2c_address_nack";
+        case DS3231StatError::I2cDataNack: return "i2c_data_nack";
+        case DS3231StatError::I2cTimeout: return "i2c_timeout";
+        case DS3231StatError::I2cOther: return "i2c_other";
+        case DS3231StatError::I2cShortRead: return "i2c_short_read";
+        default: return "unknown";
+    }
+}
+
+size_t DS3231Stats::printPrometheus(Print& out, const char* prefix) const {
+    size_t n = 0;
+
+    n += out.printf("# HELP %s_calls_total Controller API calls by operation\n", prefix);
+    n += out.printf("# TYPE %s_calls_total counter\n", prefix);
+    for (uint8_t i = 0; i < OP_COUNT; i++) {
+        n += out.printf("%s_calls_total{op=\"%s\"} %lu\n", prefix, opName(static_cast<DS3231StatOp>(i)),
+                        static_cast<unsigned long>(ops[i].calls));
+    }
+
+    n += out.printf("# HELP %s_lock_failures_total Mutex acquisitions that timed out\n", prefix);
+    n += out.printf("# TYPE %s_lock_failures_total counter\n", prefix);
+    for (uint8_t i = 0; i < OP_COUNT; i++) {
+        n += out.printf("%s_lock_failures_total{op=\"%s\"} %lu\n", prefix, opName(static_cast<DS3231StatOp>(i)),
+                        static_cast<unsigned long>(ops[i].lockFailures));
+    }
+
+    n += out.printf("# HELP %s_lock_wait_us Time spent waiting for the controller mutex\n", prefix);
+    n += out.printf("# TYPE %s_lock_wait_us histogram\n", prefix);
+    for (uint8_t i = 0; i < OP_COUNT; i++) {
+        const char* name = opName(static_cast<DS3231StatOp>(i));
+        unsigned long cumulative = 0;
+        for (uint8_t b = 0; b < WAIT_BUCKETS; b++) {
+            cumulative += ops[i].waitHistogram[b];
+            if (b < WAIT_BUCKETS - 1) {
+                n += out.printf("%s_lock_wait_us_bucket{op=\"%s\",le=\"%lu\"} %lu\n", prefix, name,
+                                static_cast<unsigned long>(WAIT_BUCKET_LIMITS_US[b]), cumulative);
+            } else {
+                n += out.printf("%s_lock_wait_us_bucket{op=\"%s\",le=\"+Inf\"} %lu\n", prefix, name, cumulative);
+            }
+        }
+        n += out.printf("%s_lock_wait_us_sum{op=\"%s\"} %lu\n", prefix, name,
+                        static_cast<unsigned long>(ops[i].waitTotalUs));
+        n += out.printf("%s_lock_wait_us_count{op=\"%s\"} %lu\n", prefix, name, cumulative);
+    }
+
+    n += out.printf("# HELP %s_lock_wait_max_us Longest mutex wait\n", prefix);
+    n += out.printf("# TYPE %s_lock_wait_max_us gauge\n", prefix);
+    for (uint8_t i = 0; i < OP_COUNT; i++) {
+        n += out.printf("%s_lock_wait_max_us{op=\"%s\"} %lu\n", prefix, opName(static_cast<DS3231StatOp>(i)),
+                        static_cast<unsigned long>(ops[i].maxWaitUs));
+    }
+
+    n += out.printf("# HELP %s_last_error Last error by operation (0 = none)\n", prefix);
+    n += out.printf("# TYPE %s_last_error gauge\n", prefix);
+    for (uint8_t i = 0; i < OP_COUNT; i++) {
+        n += out.printf("%s_last_error{op=\"%s\",error=\"%s\"} %lu\n", prefix, opName(static_cast<DS3231StatOp>(i)),
+                        errorName(static_cast<DS3231StatError>(ops[i].lastError)),
+                        static_cast<unsigned long>(ops[i].lastError));
+    }
+
+    n += out.printf("# HELP %s_i2c_transactions_total Register transfers issued by the controller\n", prefix);
+    n += out.printf("# TYPE %s_i2c_transactions_total counter\n", prefix);
+    n += out.printf("%s_i2c_transactions_total %lu\n", prefix, static_cast<unsigned long>(i2cTransactions));
+
+    n += out.printf("# HELP %s_i2c_errors_total Failed register transfers by kind\n", prefix);
+    n += out.printf("# TYPE %s_i2c_errors_total counter\n", prefix);
+    n += out.printf("%s_i2c_errors_total{kind=\"address_nack\"} %lu\n", prefix, static_cast<unsigned long>(i2cAddressNacks));
+    n += out.printf("%s_i2c_errors_total{kind=\"data_nack\"} %lu\n", prefix, static_cast<unsigned long>(i2cDataNacks));
+    n += out.printf("%s_i2c_errors_total{kind=\"timeout\"} %lu\n", prefix, static_cast<unsigned long>(i2cTimeouts));
+    n += out.printf("%s_i2c_errors_total{kind=\"other\"} %lu\n", prefix, static_cast<unsigned long>(i2cOtherErrors));
+    n += out.printf("%s_i2c_errors_total{kind=\"short_read\"} %lu\n", prefix, static_cast<unsigned long>(i2cShortReads));
+
+    n += out.printf("# HELP %s_rtclib_reads_total Time reads delegated to RTClib\n", prefix);
+    n += out.printf("# TYPE %s_rtclib_reads_total counter\n", prefix);
+    n += out.printf("%s_rtclib_reads_total %lu\n", prefix, static_cast<unsigned long>(rtclibReads));
+    return n;
+}
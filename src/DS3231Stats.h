@@ -0,0 +1,227 @@
+/*
+ * DS3231Stats.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_STATS_H
+#define DS3231_STATS_H
+
+#include <Arduino.h>
+#include <RecursiveMutexGuard.h>
+#include <esp_timer.h>
+#include <string.h>
+
+// Build with -DDS3231_STATS to count calls, mutex waits and I2C results in a
+// DS3231Stats block. Without it DS3231StatsGuard is a plain
+// RecursiveMutexGuard and the recorder is empty.
+
+// Public API entry points, grouped by what they do with the lock and the bus
+enum class DS3231StatOp : uint8_t {
+    Begin,        // begin()
+    Now,          // now(), isRunning() and every query that reads the clock
+    SetTime,      // setTime(), setTimeFromUTC()
+    Snapshot,     // readSnapshot()
+    Schedules,    // addSchedule(), updateSchedule(), removeSchedule(), clearAllSchedules()
+    Evaluate,     // evaluateAt()
+    Temperature,  // getTemperature*(), forceTemperatureConversion(), clearTemperatureHistory()
+    Alarm,        // setAlarm*(), clearAlarm(), isAlarmFired(), acknowledgeAlarm()
+    Events,       // Alarm interrupts and scheduler task passes
+    Persistence,  // (de)serialize*(), get*Size() and the store calls
+    BusJob,       // submitBusJob()
+    Clock,        // Cached clock, drift, aging, edge capture, time zone, syncSystemTime()
+    Config,       // Vacation, pump exercise, deep sleep, status and diagnostics
+    Count
+};
+
+enum class DS3231StatError : uint8_t {
+    None = 0,
+    LockTimeout,     // Mutex not acquired
+    I2cAddressNack,  // endTransmission() 2
+    I2cDataNack,     // endTransmission() 3
+    I2cTimeout,      // endTransmission() 5
+    I2cOther,        // Any other endTransmission() failure
+    I2cShortRead,    // requestFrom() returned fewer bytes than asked
+};
+
+// Counters readable from any task without a lock: every field is a naturally
+// aligned 32-bit word written atomically, so each one reads consistently.
+// Copy the block for a snapshot; fields may be a few events apart.
+struct DS3231Stats {
+    static constexpr uint8_t OP_COUNT = static_cast<uint8_t>(DS3231StatOp::Count);
+    static constexpr uint8_t WAIT_BUCKETS = 6;
+    static constexpr uint32_t WAIT_BUCKET_LIMITS_US[WAIT_BUCKETS - 1] = {10, 100, 1000, 10000, 100000};
+
+    struct OpStats {
+        uint32_t calls;
+        uint32_t lockFailures;
+        uint32_t waitHistogram[WAIT_BUCKETS];  // <10 us, <100 us, <1 ms, <10 ms, <100 ms, longer
+        uint32_t waitTotalUs;                  // Wraps after ~71 min of accumulated waiting
+        uint32_t maxWaitUs;
+        uint32_t lastError;                    // DS3231StatError
+        uint32_t lastErrorMs;                  // millis() of lastError
+    };
+    OpStats ops[OP_COUNT];
+
+    // Transfers the controller issues itself: burst reads, status, control,
+    // aging. RTClib time reads are counted separately; RTClib reports no errors.
+    uint32_t i2cTransactions;
+    uint32_t i2cAddressNacks;
+    uint32_t i2cDataNacks;
+    uint32_t i2cTimeouts;
+    uint32_t i2cOtherErrors;
+    uint32_t i2cShortReads;
+    uint32_t rtclibReads;
+
+    const OpStats& op(DS3231StatOp which) const { return ops[static_cast<uint8_t>(which)]; }
+
+    static const char* opName(DS3231StatOp op);
+    static const char* errorName(DS3231StatError error);
+
+    // Prometheus text exposition format, e.g. into a WiFiClient or WebServer
+    size_t printPrometheus(Print& out, const char* prefix = "ds3231") const;
+};
+
+#ifdef DS3231_STATS
+
+class DS3231StatsRecorder {
+public:
+    const DS3231Stats& stats() const { return _stats; }
+    void reset() { memset(&_stats, 0, sizeof(_stats)); }
+
+    void noteCall(DS3231StatOp op) { add(slot(op).calls); }
+
+    void noteLock(DS3231StatOp op, int64_t waitUs, bool acquired) {
+        DS3231Stats::OpStats& s = slot(op);
+        uint32_t us = waitUs > 0 ? static_cast<uint32_t>(waitUs) : 0;
+        uint8_t bucket = 0;
+        while (bucket < DS3231Stats::WAIT_BUCKETS - 1 && us >= DS3231Stats::WAIT_BUCKET_LIMITS_US[bucket]) {
+            bucket++;
+        }
+        add(s.calls);
+        add(s.waitHistogram[bucket]);
+        add(s.waitTotalUs, us);
+        if (us > __atomic_load_n(&s.maxWaitUs, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&s.maxWaitUs, us, __ATOMIC_RELAXED);  // Racing writers may keep the smaller
+        }
+        if (!acquired) {
+            add(s.lockFailures);
+            noteError(s, DS3231StatError::LockTimeout);
+        }
+    }
+
+    // endTransmission() result of a controller register transfer
+    void noteI2c(uint8_t result) {
+        add(_stats.i2cTransactions);
+        switch (result) {
+            case 0: return;
+            case 2: add(_stats.i2cAddressNacks); noteError(DS3231StatError::I2cAddressNack); return;
+            case 3: add(_stats.i2cDataNacks); noteError(DS3231StatError::I2cDataNack); return;
+            case 5: add(_stats.i2cTimeouts); noteError(DS3231StatError::I2cTimeout); return;
+            default: add(_stats.i2cOtherErrors); noteError(DS3231StatError::I2cOther); return;
+        }
+    }
+
+    void noteShortRead() {
+        add(_stats.i2cShortReads);
+        noteError(DS3231StatError::I2cShortRead);
+    }
+
+    void noteRtclibRead() { add(_stats.rtclibReads); }
+
+private:
+    friend class DS3231StatsGuard;
+
+    static void add(uint32_t& counter, uint32_t n = 1) { __atomic_fetch_add(&counter, n, __ATOMIC_RELAXED); }
+
+    DS3231Stats::OpStats& slot(DS3231StatOp op) { return _stats.ops[static_cast<uint8_t>(op)]; }
+
+    static void noteError(DS3231Stats::OpStats& s, DS3231StatError error) {
+        __atomic_store_n(&s.lastError, static_cast<uint32_t>(error), __ATOMIC_RELAXED);
+        __atomic_store_n(&s.lastErrorMs, static_cast<uint32_t>(millis()), __ATOMIC_RELAXED);
+    }
+
+    // Bus errors are charged to the operation holding the mutex
+    void noteError(DS3231StatError error) {
+        if (_current != DS3231StatOp::Count) {
+            noteError(slot(_current), error);
+        }
+    }
+
+    DS3231Stats _stats = {};
+    DS3231StatOp _current = DS3231StatOp::Count;  // Written under the controller mutex
+};
+
+// RecursiveMutexGuard that times the wait and marks its operation current
+// while held. Nested guards restore the outer operation on release.
+class DS3231StatsGuard {
+public:
+    DS3231StatsGuard(SemaphoreHandle_t mutex, DS3231StatsRecorder& recorder, DS3231StatOp op)
+        : _recorder(recorder), _startUs(esp_timer_get_time()), _guard(mutex), _previous(recorder._current) {
+        _locked = _guard.hasLock();
+        recorder.noteLock(op, esp_timer_get_time() - _startUs, _locked);
+        if (_locked) {
+            recorder._current = op;
+        }
+    }
+
+    ~DS3231StatsGuard() {
+        if (_locked) {
+            _recorder._current = _previous;
+        }
+    }
+
+    DS3231StatsGuard(const DS3231StatsGuard&) = delete;
+    DS3231StatsGuard& operator=(const DS3231StatsGuard&) = delete;
+
+    bool hasLock() const { return _locked; }
+
+private:
+    DS3231StatsRecorder& _recorder;
+    int64_t _startUs;
+    RecursiveMutexGuard _guard;
+    DS3231StatOp _previous;
+    bool _locked;
+};
+
+#else
+
+class DS3231StatsRecorder {
+public:
+    void noteCall(DS3231StatOp) {}
+    void noteI2c(uint8_t) {}
+    void noteShortRead() {}
+    void noteRtclibRead() {}
+};
+
+class DS3231StatsGuard {
+public:
+    DS3231StatsGuard(SemaphoreHandle_t mutex, DS3231StatsRecorder&, DS3231StatOp) : _guard(mutex) {}
+
+    DS3231StatsGuard(const DS3231StatsGuard&) = delete;
+    DS3231StatsGuard& operator=(const DS3231StatsGuard&) = delete;
+
+    bool hasLock() { return _guard.hasLock(); }
+
+private:
+    RecursiveMutexGuard _guard;
+};
+
+#endif // DS3231_STATS
+
+#endif // DS3231_STATS_H
@@ -0,0 +1,132 @@
+/*
+ * DS3231TemperatureHistory.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_TEMPERATURE_HISTORY_H
+#define DS3231_TEMPERATURE_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One temperature conversion. Stored in the register's own 0.25 °C steps so
+// the running sum stays exact.
+struct DS3231TemperatureSample {
+    uint32_t epoch;       // RTC time of the read (unixtime); UTC once a time zone is set
+    int16_t quarterC;     // Temperature in 0.25 °C steps
+
+    float celsius() const { return quarterC * 0.25f; }
+};
+
+// Fixed-capacity ring of temperature samples with O(1) min/max/mean over the
+// retained window. Min and max use monotonic queues of sample sequence
+// numbers, so evicting the oldest sample never rescans the ring.
+//
+// The storage is exposed in place: the retained samples are the span
+// firstPart() followed by secondPart(), oldest first. Writers and readers
+// must be serialized by the owner.
+template <size_t Capacity>
+class DS3231TemperatureHistory {
+    static_assert(Capacity > 0 && Capacity <= 0xFFFF, "DS3231TemperatureHistory needs 1..65535 entries");
+
+public:
+    void push(const DS3231TemperatureSample& sample) {
+        if (_count == Capacity) {
+            uint32_t evicted = _pushed - Capacity;
+            _sumQuarterC -= at(evicted).quarterC;
+            _minQueue.dropFront(evicted);
+            _maxQueue.dropFront(evicted);
+            _count--;
+        }
+
+        _samples[_pushed % Capacity] = sample;
+        _sumQuarterC += sample.quarterC;
+        while (!_minQueue.empty() && at(_minQueue.back()).quarterC >= sample.quarterC) {
+            _minQueue.popBack();
+        }
+        _minQueue.pushBack(_pushed);
+        while (!_maxQueue.empty() && at(_maxQueue.back()).quarterC <= sample.quarterC) {
+            _maxQueue.popBack();
+        }
+        _maxQueue.pushBack(_pushed);
+        _pushed++;
+        _count++;
+    }
+
+    void clear() {
+        _count = 0;
+        _sumQuarterC = 0;
+        _minQueue = IndexQueue();
+        _maxQueue = IndexQueue();
+    }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+    uint32_t totalPushed() const { return _pushed; }  // Sequence number of the next sample
+
+    // index 0 is the oldest retained sample
+    const DS3231TemperatureSample& operator[](size_t index) const { return at(_pushed - _count + index); }
+    const DS3231TemperatureSample& newest() const { return at(_pushed - 1); }
+
+    // Zero-copy view: firstPart() then secondPart() in chronological order
+    const DS3231TemperatureSample* firstPart() const { return &at(_pushed - _count); }
+    size_t firstPartSize() const {
+        size_t start = (_pushed - _count) % Capacity;
+        return (start + _count <= Capacity) ? _count : Capacity - start;
+    }
+    const DS3231TemperatureSample* secondPart() const { return _samples; }
+    size_t secondPartSize() const { return _count - firstPartSize(); }
+
+    // Statistics over the retained samples; 0 when empty
+    float minCelsius() const { return empty() ? 0.0f : at(_minQueue.front()).celsius(); }
+    float maxCelsius() const { return empty() ? 0.0f : at(_maxQueue.front()).celsius(); }
+    float meanCelsius() const { return empty() ? 0.0f : _sumQuarterC * 0.25f / _count; }
+
+private:
+    // Ring of sample sequence numbers used as a double-ended queue
+    struct IndexQueue {
+        uint32_t items[Capacity];
+        uint16_t head = 0;
+        uint16_t count = 0;
+
+        bool empty() const { return count == 0; }
+        uint32_t front() const { return items[head]; }
+        uint32_t back() const { return items[(head + count - 1) % Capacity]; }
+        void pushBack(uint32_t seq) { items[(head + count++) % Capacity] = seq; }
+        void popBack() { count--; }
+        void dropFront(uint32_t seq) {
+            if (count > 0 && items[head] == seq) {
+                head = (head + 1) % Capacity;
+                count--;
+            }
+        }
+    };
+
+    const DS3231TemperatureSample& at(uint32_t seq) const { return _samples[seq % Capacity]; }
+
+    DS3231TemperatureSample _samples[Capacity] = {};
+    IndexQueue _minQueue;
+    IndexQueue _maxQueue;
+    uint32_t _pushed = 0;
+    uint16_t _count = 0;
+    int32_t _sumQuarterC = 0;
+};
+
+#endif // DS3231_TEMPERATURE_HISTORY_H
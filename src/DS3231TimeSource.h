@@ -0,0 +1,40 @@
+/*
+ * DS3231TimeSource.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_TIME_SOURCE_H
+#define DS3231_TIME_SOURCE_H
+
+#include <RTClib.h>
+
+// Clock shared by several schedule sets. Every DS3231ControllerT is one; a
+// controller started with begin(DS3231TimeSource&) reads its time here
+// instead of from an RTC of its own.
+class DS3231TimeSource {
+public:
+    virtual ~DS3231TimeSource() = default;
+
+    // RTC-domain time: UTC while the source has a time zone set, local
+    // otherwise. Invalid if the clock could not be read. Called with the
+    // follower's mutex held, so it must never call back into a follower.
+    virtual DateTime readSourceTime() const = 0;
+};
+
+#endif // DS3231_TIME_SOURCE_H
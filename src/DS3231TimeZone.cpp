@@ -0,0 +1,344 @@
+/*
+ * DS3231TimeZone.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231TimeZone.h"
+#include <ctype.h>
+#include <string.h>
+
+namespace {
+
+constexpr int64_t SECONDS_PER_DAY = 86400;
+constexpr int32_t MAX_OFFSET_SECONDS = 24 * 3600;
+constexpr int32_t MAX_RULE_TIME_SECONDS = 167 * 3600;  // RFC 8536 extension
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+uint8_t daysInMonth(int year, uint8_t month) {
+    static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12) {
+        return 31;  // Only reachable from a torn latch copy, which is discarded
+    }
+    return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+int64_t daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(year - era * 400);
+    unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+int yearOf(uint32_t epoch) {
+    int64_t z = epoch / SECONDS_PER_DAY + 719468;
+    int64_t era = z / 146097;
+    unsigned doe = static_cast<unsigned>(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    return static_cast<int>(yoe + era * 400) + (mp >= 10);
+}
+
+uint32_t clampEpoch(int64_t seconds) {
+    return seconds < 0 ? 0 : (seconds > 0xFFFFFFFFLL ? 0xFFFFFFFFUL : static_cast<uint32_t>(seconds));
+}
+
+bool parseNumber(const char*& p, int32_t minValue, int32_t maxValue, int32_t& out) {
+    if (!isdigit(static_cast<unsigned char>(*p))) {
+        return false;
+    }
+    int32_t value = 0;
+    while (isdigit(static_cast<unsigned char>(*p))) {
+        value = value * 10 + (*p++ - '0');
+        if (value > maxValue) {
+            return false;
+        }
+    }
+    if (value < minValue) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+// [+|-]hh[:mm[:ss]] in seconds, sign as written
+bool parseTime(const char*& p, int32_t maxSeconds, int32_t& out) {
+    int32_t sign = 1;
+    if (*p == '+' || *p == '-') {
+        sign = (*p++ == '-') ? -1 : 1;
+    }
+    int32_t hours, minutes = 0, seconds = 0;
+    if (!parseNumber(p, 0, maxSeconds / 3600, hours)) {
+        return false;
+    }
+    if (*p == ':') {
+        p++;
+        if (!parseNumber(p, 0, 59, minutes)) {
+            return false;
+        }
+        if (*p == ':') {
+            p++;
+            if (!parseNumber(p, 0, 59, seconds)) {
+                return false;
+            }
+        }
+    }
+    out = sign * (hours * 3600 + minutes * 60 + seconds);
+    return out <= maxSeconds && out >= -maxSeconds;
+}
+
+// Alphabetic name of 3+ characters, or <...> with alphanumerics and signs
+bool parseName(const char*& p, char* name) {
+    const char* start = p;
+    size_t length = 0;
+    if (*p == '<') {
+        start = ++p;
+        while (isalnum(static_cast<unsigned char>(*p)) || *p == '+' || *p == '-') {
+            p++;
+        }
+        length = static_cast<size_t>(p - start);
+        if (*p++ != '>') {
+            return false;
+        }
+    } else {
+        while (isalpha(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        length = static_cast<size_t>(p - start);
+    }
+    if (length < 3) {
+        return false;
+    }
+    if (length >= DS3231TimeZone::NAME_SIZE) {
+        length = DS3231TimeZone::NAME_SIZE - 1;  // Abbreviations are display-only
+    }
+    memcpy(name, start, length);
+    name[length] = '\0';
+    return true;
+}
+
+}  // namespace
+
+DS3231TimeZone::DS3231TimeZone()
+    : _stdName("UTC"), _dstName("UTC"), _stdOffset(0), _dstOffset(0),
+      _start{'M', 0, 3, 2, 0, 7200}, _end{'M', 0, 11, 1, 0, 7200},
+      _hasDst(false), _cacheValid(false), _cache{} {}
+
+bool DS3231TimeZone::parse(const char* posixTz) {
+    if (!posixTz) {
+        return false;
+    }
+
+    auto parseRule = [](const char*& p, Rule& rule) {
+        int32_t value;
+        rule = Rule{'D', 0, 0, 0, 0, 7200};
+        if (*p == 'J') {
+            p++;
+            if (!parseNumber(p, 1, 365, value)) return false;
+            rule.kind = 'J';
+            rule.day = static_cast<uint16_t>(value);
+        } else if (*p == 'M') {
+            int32_t month, week, weekday;
+            p++;
+            if (!parseNumber(p, 1, 12, month) || *p++ != '.' || !parseNumber(p, 1, 5, week) ||
+                *p++ != '.' || !parseNumber(p, 0, 6, weekday)) {
+                return false;
+            }
+            rule.kind = 'M';
+            rule.month = static_cast<uint8_t>(month);
+            rule.week = static_cast<uint8_t>(week);
+            rule.weekday = static_cast<uint8_t>(weekday);
+        } else {
+            if (!parseNumber(p, 0, 365, value)) return false;
+            rule.day = static_cast<uint16_t>(value);
+        }
+        if (*p == '/') {
+            p++;
+            return parseTime(p, MAX_RULE_TIME_SECONDS, rule.timeSeconds);
+        }
+        return true;
+    };
+
+    DS3231TimeZone zone;
+    const char* p = posixTz;
+    int32_t west;
+
+    // POSIX offsets count hours west of Greenwich: "CET-1" is UTC+1
+    if (!parseName(p, zone._stdName) || !parseTime(p, MAX_OFFSET_SECONDS, west)) {
+        return false;
+    }
+    zone._stdOffset = -west;
+    zone._dstOffset = zone._stdOffset;
+    memcpy(zone._dstName, zone._stdName, NAME_SIZE);
+
+    if (*p != '\0') {
+        if (!parseName(p, zone._dstName)) {
+            return false;
+        }
+        zone._dstOffset = zone._stdOffset + 3600;
+        if (*p != '\0' && *p != ',') {
+            if (!parseTime(p, MAX_OFFSET_SECONDS, west)) {
+                return false;
+            }
+            zone._dstOffset = -west;
+        }
+        if (*p == ',') {
+            p++;
+            if (!parseRule(p, zone._start) || *p++ != ',' || !parseRule(p, zone._end)) {
+                return false;
+            }
+        }
+        if (*p != '\0') {
+            return false;
+        }
+        zone._hasDst = zone._dstOffset != zone._stdOffset;
+    }
+
+    *this = zone;
+    return true;
+}
+
+int64_t DS3231TimeZone::transitionUtc(const Rule& rule, int year, int32_t offsetBefore) const {
+    int64_t day;
+    if (rule.kind == 'J') {
+        // Jn never counts Feb 29
+        day = daysFromCivil(year, 1, 1) + rule.day - 1 + (isLeapYear(year) && rule.day >= 60 ? 1 : 0);
+    } else if (rule.kind == 'M') {
+        int64_t first = daysFromCivil(year, rule.month, 1);
+        int firstWeekday = static_cast<int>((first + 4) % 7);  // 1970-01-01 was a Thursday
+        int dayOfMonth = 1 + (rule.weekday - firstWeekday + 7) % 7 + (rule.week - 1) * 7;
+        while (dayOfMonth > daysInMonth(year, rule.month)) {
+            dayOfMonth -= 7;  // Week 5 means the last one
+        }
+        day = first + dayOfMonth - 1;
+    } else {
+        day = daysFromCivil(year, 1, 1) + rule.day;
+    }
+    // Rule times are local time under the offset in effect before the change
+    return day * SECONDS_PER_DAY + rule.timeSeconds - offsetBefore;
+}
+
+DS3231TimeZone::Span DS3231TimeZone::lookup(uint32_t utc) const {
+    if (!_hasDst) {
+        return Span{0, 0xFFFFFFFFUL, 0xFFFFFFFFUL, _stdOffset, _stdOffset, _stdOffset};
+    }
+
+    // Transitions of the surrounding years, sorted; southern-hemisphere rules
+    // start DST late in the year, so the order within a year varies
+    int64_t times[6];
+    int32_t offsets[6];  // In effect from times[i]
+    uint8_t count = 0;
+    int year = yearOf(utc);
+    for (int y = year - 1; y <= year + 1; y++) {
+        int64_t yearTimes[2] = {transitionUtc(_start, y, _stdOffset), transitionUtc(_end, y, _dstOffset)};
+        int32_t yearOffsets[2] = {_dstOffset, _stdOffset};
+        for (uint8_t k = 0; k < 2; k++) {
+            int64_t t = yearTimes[k];
+            int32_t offset = yearOffsets[k];
+            uint8_t i = count++;
+            while (i > 0 && times[i - 1] > t) {
+                times[i] = times[i - 1];
+                offsets[i] = offsets[i - 1];
+                i--;
+            }
+            times[i] = t;
+            offsets[i] = offset;
+        }
+    }
+
+    uint8_t i = 0;
+    while (i + 1 < count && times[i + 1] <= static_cast<int64_t>(utc)) {
+        i++;
+    }
+
+    Span span;
+    span.from = clampEpoch(times[i]);
+    span.offset = offsets[i];
+    span.prevOffset = i > 0 ? offsets[i - 1] : (span.offset == _dstOffset ? _stdOffset : _dstOffset);
+    span.until = i + 1 < count ? clampEpoch(times[i + 1]) : 0xFFFFFFFFUL;
+    span.nextOffset = i + 1 < count ? offsets[i + 1] : span.offset;
+    span.after = i + 2 < count ? clampEpoch(times[i + 2]) : span.until;
+    return span;
+}
+
+DS3231TimeZone::Span DS3231TimeZone::spanFor(uint32_t utc) const {
+    if (!isCached(utc)) {
+        return lookup(utc);
+    }
+    if (utc < _cache.until) {
+        return _cache;
+    }
+    // The cached next period
+    return Span{_cache.until, _cache.after, _cache.after, _cache.offset, _cache.nextOffset, _cache.nextOffset};
+}
+
+void DS3231TimeZone::refresh(uint32_t utc) {
+    _cache = lookup(utc);
+    _cacheValid = true;
+}
+
+int32_t DS3231TimeZone::offsetAt(uint32_t utc) const {
+    if (isCached(utc)) {
+        return utc < _cache.until ? _cache.offset : _cache.nextOffset;
+    }
+    return lookup(utc).offset;
+}
+
+uint32_t DS3231TimeZone::toUtc(uint32_t local) const {
+    if (!_hasDst) {
+        return local - _stdOffset;
+    }
+
+    uint32_t asStd = local - _stdOffset;
+    uint32_t asDst = local - _dstOffset;
+    bool stdValid = offsetAt(asStd) == _stdOffset;
+    bool dstValid = offsetAt(asDst) == _dstOffset;
+    if (stdValid && dstValid) {
+        return asStd < asDst ? asStd : asDst;  // Repeated: first occurrence
+    }
+    if (stdValid || dstValid) {
+        return stdValid ? asStd : asDst;
+    }
+    // Skipped: the transition lies between the two readings
+    return nextTransitionAfter(asStd < asDst ? asStd : asDst);
+}
+
+uint32_t DS3231TimeZone::toScheduleTime(uint32_t utc) const {
+    Span span = spanFor(utc);
+    if (span.prevOffset > span.offset && utc - span.from < static_cast<uint32_t>(span.prevOffset - span.offset)) {
+        return span.from + span.prevOffset - 1;
+    }
+    return utc + span.offset;
+}
+
+uint32_t DS3231TimeZone::nextTransitionAfter(uint32_t utc) const {
+    if (!_hasDst) {
+        return 0;
+    }
+    if (isCached(utc) && (utc < _cache.until || _cache.after != _cache.until)) {
+        return utc < _cache.until ? _cache.until : _cache.after;
+    }
+    return lookup(utc).until;
+}
@@ -0,0 +1,106 @@
+/*
+ * DS3231TimeZone.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_TIME_ZONE_H
+#define DS3231_TIME_ZONE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// POSIX TZ rule such as "CET-1CEST,M3.5.0,M10.5.0/3". The offset period
+// containing the last lookup and the one after it are cached, so converting
+// UTC to local time is a compare and an add until the second transition.
+//
+// Trivially copyable, so the controller can publish it through a
+// DS3231SeqLatch. Only refresh() and parse() modify it; lookups outside the
+// cache are computed from the rules without storing the result.
+class DS3231TimeZone {
+public:
+    static constexpr size_t NAME_SIZE = 8;  // Abbreviation incl. terminator
+
+    DS3231TimeZone();  // UTC, no daylight saving
+
+    // Supports std offset [dst [offset] [,start[/time],end[/time]]] with Jn, n
+    // and Mm.w.d dates and quoted <+03> names. A DST zone without rules uses
+    // the US rules. Returns false and leaves the zone unchanged on error.
+    [[nodiscard]] bool parse(const char* posixTz);
+
+    [[nodiscard]] bool hasDst() const { return _hasDst; }
+    [[nodiscard]] int32_t standardOffset() const { return _stdOffset; }  // Seconds east of UTC
+    [[nodiscard]] int32_t offsetAt(uint32_t utc) const;
+    [[nodiscard]] bool isDstAt(uint32_t utc) const { return _hasDst && offsetAt(utc) == _dstOffset; }
+    [[nodiscard]] const char* abbreviationAt(uint32_t utc) const { return isDstAt(utc) ? _dstName : _stdName; }
+    [[nodiscard]] uint32_t toLocal(uint32_t utc) const { return utc + offsetAt(utc); }
+
+    // Local wall time to UTC. A local time skipped by a spring-forward
+    // transition resolves to the transition instant, a repeated one to its
+    // first occurrence.
+    [[nodiscard]] uint32_t toUtc(uint32_t local) const;
+
+    // Local time as the schedule engine sees it: the wall clock, except that
+    // it holds at the last second before a fall-back transition until the
+    // repeated hour has passed, so nothing in that hour runs twice
+    [[nodiscard]] uint32_t toScheduleTime(uint32_t utc) const;
+
+    // First transition after utc, 0 if the zone has none
+    [[nodiscard]] uint32_t nextTransitionAfter(uint32_t utc) const;
+
+    [[nodiscard]] bool isCached(uint32_t utc) const { return _cacheValid && utc >= _cache.from && utc < _cache.after; }
+    void refresh(uint32_t utc);  // Cache the periods around utc
+
+private:
+    // Transition date: Julian day without Feb 29 ('J'), zero-based day ('D')
+    // or the w-th weekday d of month m ('M')
+    struct Rule {
+        char kind;
+        uint16_t day;
+        uint8_t month;
+        uint8_t week;
+        uint8_t weekday;
+        int32_t timeSeconds;  // Local time of day, may exceed 24 h
+    };
+
+    // Offset period [from, until) and the one after it, [until, after)
+    struct Span {
+        uint32_t from;
+        uint32_t until;
+        uint32_t after;
+        int32_t prevOffset;  // In effect before from
+        int32_t offset;
+        int32_t nextOffset;
+    };
+
+    Span lookup(uint32_t utc) const;
+    Span spanFor(uint32_t utc) const;  // Cached when possible
+    int64_t transitionUtc(const Rule& rule, int year, int32_t offsetBefore) const;
+
+    char _stdName[NAME_SIZE];
+    char _dstName[NAME_SIZE];
+    int32_t _stdOffset;
+    int32_t _dstOffset;
+    Rule _start;
+    Rule _end;
+    bool _hasDst;
+    bool _cacheValid;
+    Span _cache;
+};
+
+#endif // DS3231_TIME_ZONE_H
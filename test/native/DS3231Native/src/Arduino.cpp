@@ -0,0 +1,123 @@
+/*
+ * Arduino.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "Arduino.h"
+#include "DS3231Host.h"
+#include <stdarg.h>
+
+HardwareSerial Serial;
+
+unsigned long millis() {
+    return static_cast<unsigned long>(DS3231Host::nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(DS3231Host::nowUs());
+}
+
+void delay(uint32_t ms) {
+    DS3231Host::advanceMs(ms);
+}
+
+void delayMicroseconds(uint32_t us) {
+    DS3231Host::advanceUs(us);
+}
+
+void yield() {
+    DS3231Host::dispatch();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+int digitalRead(uint8_t pin) {
+    return DS3231Host::pinLevel(pin) ? HIGH : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    DS3231Host::setPinLevel(pin, value != LOW);
+}
+
+static void callPlainIsr(void* arg) {
+    reinterpret_cast<void (*)()>(arg)();
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+    DS3231Host::attachIsr(pin, callPlainIsr, reinterpret_cast<void*>(isr), mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    DS3231Host::attachIsr(pin, isr, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin) {
+    DS3231Host::detachIsr(pin);
+}
+
+String::String(double value, unsigned int decimals) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(decimals), value);
+    _str = buffer;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (to > _str.size()) {
+        to = static_cast<unsigned int>(_str.size());
+    }
+    if (from >= to) {
+        return String();
+    }
+    return String(_str.substr(from, to - from).c_str());
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    return write(buffer, strnlen(buffer, sizeof(buffer)));
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
@@ -0,0 +1,185 @@
+/*
+ * Arduino.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NATIVE_ARDUINO_H
+#define DS3231_NATIVE_ARDUINO_H
+
+// Subset of the ESP32 Arduino core the library and its tests use, on top of
+// the simulated clock and GPIO in DS3231Host.h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <string>
+
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+class String {
+public:
+    String() = default;
+    String(const char* str) : _str(str ? str : "") {}
+    String(const __FlashStringHelper* str) : String(reinterpret_cast<const char*>(str)) {}
+    String(char c) : _str(1, c) {}
+    String(int value) : _str(std::to_string(value)) {}
+    String(unsigned int value) : _str(std::to_string(value)) {}
+    String(long value) : _str(std::to_string(value)) {}
+    String(unsigned long value) : _str(std::to_string(value)) {}
+    String(float value, unsigned int decimals = 2) : String(static_cast<double>(value), decimals) {}
+    String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return _str.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(_str.size()); }
+    bool isEmpty() const { return _str.empty(); }
+    bool reserve(unsigned int size) { _str.reserve(size); return true; }
+
+    String& operator+=(const String& rhs) { _str += rhs._str; return *this; }
+    String& operator+=(const char* rhs) { _str += rhs ? rhs : ""; return *this; }
+    String& operator+=(char rhs) { _str += rhs; return *this; }
+    String& operator+=(int rhs) { _str += std::to_string(rhs); return *this; }
+    String& operator+=(unsigned int rhs) { _str += std::to_string(rhs); return *this; }
+    String& operator+=(long rhs) { _str += std::to_string(rhs); return *this; }
+    String& operator+=(unsigned long rhs) { _str += std::to_string(rhs); return *this; }
+    bool concat(const String& rhs) { *this += rhs; return true; }
+    bool concat(const char* rhs) { *this += rhs; return true; }
+    bool concat(char rhs) { *this += rhs; return true; }
+
+    template <typename T>
+    friend String operator+(const String& lhs, const T& rhs) { String result(lhs); result += rhs; return result; }
+    friend String operator+(const char* lhs, const String& rhs) { String result(lhs); result += rhs; return result; }
+
+    bool equals(const String& rhs) const { return _str == rhs._str; }
+    bool equals(const char* rhs) const { return rhs && _str == rhs; }
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* rhs) const { return equals(rhs); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* rhs) const { return !equals(rhs); }
+    char operator[](unsigned int index) const { return index < _str.size() ? _str[index] : '\0'; }
+
+    int indexOf(char c, unsigned int from = 0) const { return find(_str.find(c, from)); }
+    int indexOf(const char* str, unsigned int from = 0) const { return find(_str.find(str, from)); }
+    bool startsWith(const char* prefix) const { return _str.rfind(prefix, 0) == 0; }
+    String substring(unsigned int from, unsigned int to = UINT32_MAX) const;
+    long toInt() const { return strtol(_str.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(_str.c_str(), nullptr); }
+
+private:
+    static int find(size_t pos) { return pos == std::string::npos ? -1 : static_cast<int>(pos); }
+
+    std::string _str;
+};
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return str ? write(reinterpret_cast<const uint8_t*>(str), strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str) { return write(str.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    template <typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    // Host input is already buffered, so there is no timeout to wait out
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t n = 0;
+        for (int c; n < length && (c = read()) >= 0; n++) {
+            buffer[n] = static_cast<uint8_t>(c);
+        }
+        return n;
+    }
+    size_t readBytes(char* buffer, size_t length) { return readBytes(reinterpret_cast<uint8_t*>(buffer), length); }
+};
+
+// Serial writes to stdout and never has input
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+};
+
+extern HardwareSerial Serial;
+
+#endif // DS3231_NATIVE_ARDUINO_H
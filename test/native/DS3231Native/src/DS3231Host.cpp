@@ -0,0 +1,115 @@
+/*
+ * DS3231Host.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231Host.h"
+#include <algorithm>
+
+void hostClearPreferences();  // Preferences.cpp
+
+int64_t DS3231Host::_nowUs = DS3231Host::BOOT_US;
+std::vector<DS3231Host::Listener*> DS3231Host::_listeners;
+DS3231Host::Pin DS3231Host::_pins[DS3231Host::PIN_COUNT] = {};
+int DS3231Host::_wakeupCause = 0;
+uint32_t DS3231Host::_deepSleepStarts = 0;
+timeval DS3231Host::_systemTime = {0, 0};
+uint32_t DS3231Host::_systemTimeSets = 0;
+
+static constexpr int RISING_EDGE = 0x01;   // Arduino.h RISING
+static constexpr int FALLING_EDGE = 0x02;  // Arduino.h FALLING
+
+void DS3231Host::reset() {
+    _nowUs = BOOT_US;
+    for (Pin& pin : _pins) {
+        pin = {true, nullptr, nullptr, 0};
+    }
+    _wakeupCause = 0;
+    _deepSleepStarts = 0;
+    _systemTime = {0, 0};
+    _systemTimeSets = 0;
+    hostClearPreferences();
+}
+
+void DS3231Host::advanceUs(int64_t us) {
+    int64_t target = _nowUs + (us > 0 ? us : 0);
+    for (;;) {
+        // Earliest pending event, rescanned each time since callbacks may
+        // arm timers or change pin state
+        Listener* due = nullptr;
+        int64_t dueUs = INT64_MAX;
+        for (Listener* listener : _listeners) {
+            int64_t at = listener->nextEventUs();
+            if (at < dueUs) {
+                due = listener;
+                dueUs = at;
+            }
+        }
+        if (!due || dueUs > target) {
+            break;
+        }
+        _nowUs = std::max(_nowUs, dueUs);
+        due->onEvent(_nowUs);
+    }
+    _nowUs = std::max(_nowUs, target);
+}
+
+void DS3231Host::addListener(Listener* listener) {
+    if (std::find(_listeners.begin(), _listeners.end(), listener) == _listeners.end()) {
+        _listeners.push_back(listener);
+    }
+}
+
+void DS3231Host::removeListener(Listener* listener) {
+    _listeners.erase(std::remove(_listeners.begin(), _listeners.end(), listener), _listeners.end());
+}
+
+void DS3231Host::setPinLevel(uint8_t pin, bool high) {
+    if (pin >= PIN_COUNT || _pins[pin].high == high) {
+        return;
+    }
+    _pins[pin].high = high;
+    Pin& p = _pins[pin];
+    if (p.isr && (p.mode & (high ? RISING_EDGE : FALLING_EDGE))) {
+        p.isr(p.arg);
+    }
+}
+
+bool DS3231Host::pinLevel(uint8_t pin) {
+    return pin < PIN_COUNT ? _pins[pin].high : true;
+}
+
+void DS3231Host::attachIsr(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    if (pin < PIN_COUNT) {
+        _pins[pin].isr = isr;
+        _pins[pin].arg = arg;
+        _pins[pin].mode = mode;
+    }
+}
+
+void DS3231Host::detachIsr(uint8_t pin) {
+    if (pin < PIN_COUNT) {
+        _pins[pin].isr = nullptr;
+        _pins[pin].arg = nullptr;
+    }
+}
+
+bool DS3231Host::hasIsr(uint8_t pin) {
+    return pin < PIN_COUNT && _pins[pin].isr != nullptr;
+}
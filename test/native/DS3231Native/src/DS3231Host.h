@@ -0,0 +1,99 @@
+/*
+ * DS3231Host.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_HOST_H
+#define DS3231_HOST_H
+
+#include <stdint.h>
+#include <sys/time.h>
+#include <vector>
+
+// Host side of the native platform: one simulated monotonic clock behind
+// esp_timer_get_time(), millis() and the FreeRTOS tick count, the GPIO levels
+// behind attachInterruptArg(), and the hooks tests use to drive both.
+//
+// Time only moves when something moves it. advanceUs() dispatches every
+// event that falls due on the way (esp_timer callbacks, pin edges from mock
+// devices) in timestamp order; delay() and vTaskDelay() advance. elapseUs()
+// moves the clock without dispatching, which is how bus latency is charged:
+// callbacks that fall due mid-transaction run at the caller's next delay,
+// as the esp_timer task would once the caller yields.
+class DS3231Host {
+public:
+    static constexpr int64_t BOOT_US = 1000000;  // esp_timer_get_time() after reset()
+
+    // Anything that wants to run at a simulated instant
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+        virtual int64_t nextEventUs() const = 0;  // INT64_MAX = nothing pending
+        virtual void onEvent(int64_t nowUs) = 0;
+    };
+
+    // Back to BOOT_US, pins high, NVS empty, no wakeup cause. Timers and
+    // listeners stay registered; call before constructing the objects under test.
+    static void reset();
+
+    static int64_t nowUs() { return _nowUs; }
+    static void advanceUs(int64_t us);
+    static void advanceMs(uint32_t ms) { advanceUs(static_cast<int64_t>(ms) * 1000); }
+    static void elapseUs(int64_t us) { _nowUs += us > 0 ? us : 0; }
+    static void dispatch() { advanceUs(0); }
+
+    static void addListener(Listener* listener);
+    static void removeListener(Listener* listener);
+
+    // GPIO: inputs idle high (the DS3231 INT/SQW output is open drain)
+    static void setPinLevel(uint8_t pin, bool high);
+    static bool pinLevel(uint8_t pin);
+    static void attachIsr(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+    static void detachIsr(uint8_t pin);
+    static bool hasIsr(uint8_t pin);
+
+    // Deep sleep and system clock
+    static void setWakeupCause(int cause) { _wakeupCause = cause; }
+    static int wakeupCause() { return _wakeupCause; }
+    static uint32_t deepSleepStarts() { return _deepSleepStarts; }
+    static void noteDeepSleep() { _deepSleepStarts++; }
+    static const timeval& systemTime() { return _systemTime; }  // Last settimeofday()
+    static uint32_t systemTimeSets() { return _systemTimeSets; }
+    static void noteSystemTime(const timeval& tv) { _systemTime = tv; _systemTimeSets++; }
+
+private:
+    static constexpr uint8_t PIN_COUNT = 64;
+
+    struct Pin {
+        bool high;
+        void (*isr)(void*);
+        void* arg;
+        int mode;
+    };
+
+    static int64_t _nowUs;
+    static std::vector<Listener*> _listeners;
+    static Pin _pins[PIN_COUNT];
+    static int _wakeupCause;
+    static uint32_t _deepSleepStarts;
+    static timeval _systemTime;
+    static uint32_t _systemTimeSets;
+};
+
+#endif // DS3231_HOST_H
@@ -0,0 +1,519 @@
+/*
+ * DS3231Mock.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "DS3231Mock.h"
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+constexpr uint8_t REG_SECONDS = 0x00;
+constexpr uint8_t REG_HOURS = 0x02;
+constexpr uint8_t REG_DAY = 0x03;
+constexpr uint8_t REG_MONTH = 0x05;
+constexpr uint8_t REG_YEAR = 0x06;
+constexpr uint8_t REG_ALARM1 = 0x07;
+constexpr uint8_t REG_ALARM2 = 0x0B;
+constexpr uint8_t REG_CONTROL = 0x0E;
+constexpr uint8_t REG_STATUS = 0x0F;
+constexpr uint8_t REG_AGING = 0x10;
+constexpr uint8_t REG_TEMP_MSB = 0x11;
+constexpr uint8_t REG_TEMP_LSB = 0x12;
+
+constexpr uint8_t CONTROL_CONV = 0x20;
+constexpr uint8_t CONTROL_RS = 0x18;
+constexpr uint8_t CONTROL_INTCN = 0x04;
+constexpr uint8_t CONTROL_A2IE = 0x02;
+constexpr uint8_t CONTROL_A1IE = 0x01;
+constexpr uint8_t STATUS_OSF = 0x80;
+constexpr uint8_t STATUS_EN32KHZ = 0x08;
+constexpr uint8_t STATUS_BSY = 0x04;
+constexpr uint8_t STATUS_A2F = 0x02;
+constexpr uint8_t STATUS_A1F = 0x01;
+
+constexpr uint32_t EPOCH_2000 = 946684800UL;
+constexpr uint32_t MAX_ALARM_SCAN_SECONDS = 62 * 86400UL;  // Longest alarm period (monthly) twice over
+
+struct Civil {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t dayOfWeek;  // 0 = Sunday
+};
+
+uint8_t bcdToBin(uint8_t value) {
+    return value - 6 * (value >> 4);
+}
+
+uint8_t binToBcd(uint8_t value) {
+    return value + 6 * (value / 10);
+}
+
+// Days since 1970-01-01 (proleptic Gregorian)
+int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+Civil civilFromEpoch(uint32_t epoch) {
+    Civil c;
+    int64_t days = epoch / 86400;
+    uint32_t secs = epoch % 86400;
+    c.hour = secs / 3600;
+    c.minute = secs / 60 % 60;
+    c.second = secs % 60;
+    c.dayOfWeek = static_cast<uint8_t>((days + 4) % 7);  // 1970-01-01 was a Thursday
+
+    days += 719468;
+    int64_t era = days / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    c.day = static_cast<uint8_t>(doy - (153 * mp + 2) / 5 + 1);
+    c.month = static_cast<uint8_t>(mp < 10 ? mp + 3 : mp - 9);
+    c.year = static_cast<uint16_t>(yoe + era * 400 + (c.month <= 2));
+    return c;
+}
+
+// Hours register or alarm hours field, 12- or 24-hour mode
+uint8_t decodeHour(uint8_t value) {
+    if (value & 0x40) {
+        return bcdToBin(value & 0x1F) % 12 + ((value & 0x20) ? 12 : 0);
+    }
+    return bcdToBin(value & 0x3F);
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+// DS3231Mock
+// ----------------------------------------------------------------------------
+
+DS3231Mock::DS3231Mock() {
+    memset(_regs, 0, sizeof(_regs));
+    _regs[REG_CONTROL] = 0x1C;  // RS2 | RS1 | INTCN
+    _regs[REG_STATUS] = STATUS_OSF | STATUS_EN32KHZ;
+
+    int64_t now = DS3231Host::nowUs();
+    _baseUs = now;
+    _baseRtcUs = static_cast<int64_t>(EPOCH_2000) * US_PER_SECOND;
+    _alarmsCheckedEpoch = EPOCH_2000;
+    _powerOnUs = now;
+    _nextAutoConversionUs = now + AUTO_CONVERSION_PERIOD_US;
+    latchTemperature();
+    renderTime(EPOCH_2000);
+}
+
+DS3231Mock::~DS3231Mock() {
+    detach();
+    DS3231Host::removeListener(this);
+}
+
+void DS3231Mock::attach(TwoWire& wire) {
+    detach();
+    wire.attach(ADDRESS, *this);
+    _wire = &wire;
+}
+
+void DS3231Mock::detach() {
+    if (_wire) {
+        _wire->detach(ADDRESS);
+        _wire = nullptr;
+    }
+}
+
+void DS3231Mock::setTime(const DateTime& time) {
+    setRtcUs(static_cast<int64_t>(time.unixtime()) * US_PER_SECOND);
+    _dowOffset = 0;
+    _regs[REG_STATUS] &= ~STATUS_OSF;
+    renderTime(time.unixtime());
+}
+
+DateTime DS3231Mock::time() {
+    sync();
+    return DateTime(parseTime());
+}
+
+int64_t DS3231Mock::subsecondUs() {
+    return rtcUsAt(DS3231Host::nowUs()) % US_PER_SECOND;
+}
+
+void DS3231Mock::setDriftPpm(double ppm) {
+    rebase();
+    _driftPpm = ppm;
+}
+
+void DS3231Mock::setTemperature(float celsius) {
+    _temperatureC = celsius;
+}
+
+void DS3231Mock::stopOscillator() {
+    _regs[REG_STATUS] |= STATUS_OSF;
+}
+
+void DS3231Mock::connectInterrupt(int8_t pin) {
+    if (_pin >= 0) {
+        DS3231Host::setPinLevel(_pin, true);  // Released: the pull-up wins
+    }
+    _pin = pin;
+    _pinHigh = true;
+    if (pin >= 0) {
+        DS3231Host::setPinLevel(pin, true);
+        DS3231Host::addListener(this);
+    } else {
+        DS3231Host::removeListener(this);
+    }
+}
+
+uint8_t DS3231Mock::peek(uint8_t reg) {
+    sync();
+    return _regs[reg % REGISTER_COUNT];
+}
+
+void DS3231Mock::poke(uint8_t reg, uint8_t value) {
+    uint8_t buffer[2] = {reg, value};
+    write(buffer, sizeof(buffer));
+    _writes--;
+}
+
+bool DS3231Mock::write(const uint8_t* data, size_t length) {
+    _writes++;
+    if (length == 0) {
+        return true;  // Address probe
+    }
+    sync();
+
+    int64_t now = DS3231Host::nowUs();
+    bool timeWritten = false;
+    bool secondsWritten = false;
+    _pointer = data[0] % REGISTER_COUNT;
+    for (size_t i = 1; i < length; i++) {
+        uint8_t value = data[i];
+        switch (_pointer) {
+        case REG_CONTROL: {
+            bool converting = _conversionDoneUs >= 0;
+            if ((value & CONTROL_CONV) && !converting) {
+                _conversionDoneUs = now + _conversionUs;
+                converting = true;
+            }
+            _regs[REG_CONTROL] = (value & ~CONTROL_CONV) | (converting ? CONTROL_CONV : 0);
+            break;
+        }
+        case REG_STATUS: {
+            // Flags can only be cleared; BSY is read-only
+            uint8_t old = _regs[REG_STATUS];
+            uint8_t flags = STATUS_OSF | STATUS_A2F | STATUS_A1F;
+            _regs[REG_STATUS] = (old & value & flags) | (value & STATUS_EN32KHZ) | (old & STATUS_BSY);
+            break;
+        }
+        case REG_AGING:
+            rebase();
+            _regs[REG_AGING] = value;
+            break;
+        case REG_TEMP_MSB:
+        case REG_TEMP_LSB:
+            break;  // Read-only
+        default:
+            _regs[_pointer] = value;
+            if (_pointer <= REG_YEAR) {
+                timeWritten = true;
+                secondsWritten |= _pointer == REG_SECONDS;
+            }
+            break;
+        }
+        _pointer = (_pointer + 1) % REGISTER_COUNT;
+    }
+
+    if (timeWritten) {
+        uint32_t epoch = parseTime();
+        Civil civil = civilFromEpoch(epoch);
+        _dowOffset = static_cast<uint8_t>((_regs[REG_DAY] % 7 + 7 - civil.dayOfWeek) % 7);
+        // Writing the seconds restarts the countdown chain; other fields keep the phase
+        int64_t fraction = secondsWritten ? 0 : rtcUsAt(now) % US_PER_SECOND;
+        setRtcUs(static_cast<int64_t>(epoch) * US_PER_SECOND + fraction);
+        renderTime(epoch);
+    }
+    return true;
+}
+
+size_t DS3231Mock::read(uint8_t* data, size_t length) {
+    _reads++;
+    sync();
+    for (size_t i = 0; i < length; i++) {
+        data[i] = _regs[_pointer];
+        _pointer = (_pointer + 1) % REGISTER_COUNT;
+    }
+    return length;
+}
+
+double DS3231Mock::rate() const {
+    int8_t aging = static_cast<int8_t>(_regs[REG_AGING]);
+    return 1.0 + (_driftPpm - aging * 0.1) / 1e6;
+}
+
+int64_t DS3231Mock::rtcUsAt(int64_t hostUs) const {
+    return _baseRtcUs + static_cast<int64_t>(floor(static_cast<double>(hostUs - _baseUs) * rate()));
+}
+
+int64_t DS3231Mock::hostUsAt(int64_t rtcUs) const {
+    int64_t hostUs = _baseUs + static_cast<int64_t>(ceil(static_cast<double>(rtcUs - _baseRtcUs) / rate()));
+    while (rtcUsAt(hostUs) < rtcUs) {
+        hostUs++;  // Absorb rounding so the RTC has reached rtcUs by then
+    }
+    return hostUs;
+}
+
+void DS3231Mock::rebase() {
+    int64_t now = DS3231Host::nowUs();
+    _baseRtcUs = rtcUsAt(now);
+    _baseUs = now;
+}
+
+void DS3231Mock::setRtcUs(int64_t rtcUs) {
+    _baseUs = DS3231Host::nowUs();
+    _baseRtcUs = rtcUs;
+    _alarmsCheckedEpoch = static_cast<uint32_t>(rtcUs / US_PER_SECOND);  // Setting the time fires nothing
+}
+
+void DS3231Mock::sync() {
+    int64_t now = DS3231Host::nowUs();
+    uint32_t epoch = static_cast<uint32_t>(rtcUsAt(now) / US_PER_SECOND);
+    if (epoch > _alarmsCheckedEpoch) {
+        scanAlarms(_alarmsCheckedEpoch + 1, epoch);
+        _alarmsCheckedEpoch = epoch;
+    }
+    renderTime(epoch);
+
+    if (_conversionDoneUs >= 0 && now >= _conversionDoneUs) {
+        latchTemperature();
+        _conversionDoneUs = -1;
+        _regs[REG_CONTROL] &= ~CONTROL_CONV;
+    }
+    if (now >= _nextAutoConversionUs + _conversionUs) {
+        latchTemperature();
+        _nextAutoConversionUs += ((now - _nextAutoConversionUs - _conversionUs) / AUTO_CONVERSION_PERIOD_US + 1) *
+                                 AUTO_CONVERSION_PERIOD_US;
+    }
+    bool busy = _conversionDoneUs >= 0 || now >= _nextAutoConversionUs;
+    _regs[REG_STATUS] = (_regs[REG_STATUS] & ~STATUS_BSY) | (busy ? STATUS_BSY : 0);
+}
+
+void DS3231Mock::renderTime(uint32_t epoch) {
+    Civil c = civilFromEpoch(epoch);
+    _regs[REG_SECONDS] = binToBcd(c.second);
+    _regs[REG_SECONDS + 1] = binToBcd(c.minute);
+    if (_regs[REG_HOURS] & 0x40) {
+        uint8_t hour12 = c.hour % 12 == 0 ? 12 : c.hour % 12;
+        _regs[REG_HOURS] = 0x40 | (c.hour >= 12 ? 0x20 : 0) | binToBcd(hour12);
+    } else {
+        _regs[REG_HOURS] = binToBcd(c.hour);
+    }
+    uint8_t dow = (c.dayOfWeek + _dowOffset) % 7;
+    _regs[REG_DAY] = dow == 0 ? 7 : dow;
+    _regs[REG_DAY + 1] = binToBcd(c.day);
+    _regs[REG_MONTH] = binToBcd(c.month) | (c.year >= 2100 ? 0x80 : 0);
+    _regs[REG_YEAR] = binToBcd(c.year % 100);
+}
+
+uint32_t DS3231Mock::parseTime() const {
+    uint16_t year = 2000 + bcdToBin(_regs[REG_YEAR]) + ((_regs[REG_MONTH] & 0x80) ? 100 : 0);
+    unsigned month = bcdToBin(_regs[REG_MONTH] & 0x1F);
+    unsigned day = bcdToBin(_regs[REG_DAY + 1] & 0x3F);
+    int64_t days = daysFromCivil(year, month ? month : 1, day ? day : 1);
+    return static_cast<uint32_t>(days * 86400 + decodeHour(_regs[REG_HOURS]) * 3600 +
+                                 bcdToBin(_regs[REG_SECONDS + 1] & 0x7F) * 60 + bcdToBin(_regs[REG_SECONDS] & 0x7F));
+}
+
+bool DS3231Mock::alarmMatches(uint8_t alarm, uint32_t epoch) const {
+    Civil c = civilFromEpoch(epoch);
+    const uint8_t* a = alarm == 1 ? &_regs[REG_ALARM1] : &_regs[REG_ALARM2] - 1;  // a[0] = seconds
+
+    bool anySecond = alarm == 1 && (a[0] & 0x80);
+    uint8_t second = alarm == 1 ? bcdToBin(a[0] & 0x7F) : 0;
+    if (!anySecond && c.second != second) {
+        return false;
+    }
+    if (!(a[1] & 0x80) && c.minute != bcdToBin(a[1] & 0x7F)) {
+        return false;
+    }
+    if (!(a[2] & 0x80) && c.hour != decodeHour(a[2] & 0x7F)) {
+        return false;
+    }
+    if (!(a[3] & 0x80)) {
+        uint8_t target = bcdToBin(a[3] & 0x3F);
+        if (a[3] & 0x40) {
+            uint8_t dow = (c.dayOfWeek + _dowOffset) % 7;
+            return (dow == 0 ? 7 : dow) == target;
+        }
+        return c.day == target;
+    }
+    return true;
+}
+
+void DS3231Mock::scanAlarms(uint32_t fromEpoch, uint32_t toEpoch) {
+    if (toEpoch - fromEpoch > MAX_ALARM_SCAN_SECONDS) {
+        fromEpoch = toEpoch - MAX_ALARM_SCAN_SECONDS;
+    }
+    static const uint8_t flags[2] = {STATUS_A1F, STATUS_A2F};
+    for (uint8_t alarm = 1; alarm <= 2; alarm++) {
+        uint8_t flag = flags[alarm - 1];
+        if (_regs[REG_STATUS] & flag) {
+            continue;  // Latched until cleared
+        }
+        // Only seconds that can match: every second for a per-second Alarm 1,
+        // else one per minute
+        uint32_t step = 60;
+        uint32_t second = 0;
+        if (alarm == 1) {
+            if (_regs[REG_ALARM1] & 0x80) {
+                step = 1;
+            } else {
+                second = bcdToBin(_regs[REG_ALARM1] & 0x7F);
+            }
+        }
+        uint32_t t = fromEpoch;
+        if (step == 60) {
+            t += (second + 60 - t % 60) % 60;
+        }
+        for (; t <= toEpoch; t += step) {
+            if (alarmMatches(alarm, t)) {
+                _regs[REG_STATUS] |= flag;
+                break;
+            }
+        }
+    }
+}
+
+void DS3231Mock::latchTemperature() {
+    long quarters = lroundf(_temperatureC * 4.0f);
+    quarters = quarters < -512 ? -512 : (quarters > 511 ? 511 : quarters);
+    _regs[REG_TEMP_MSB] = static_cast<uint8_t>(static_cast<int8_t>(floor(quarters / 4.0)));
+    _regs[REG_TEMP_LSB] = static_cast<uint8_t>((quarters & 0x03) << 6);
+}
+
+bool DS3231Mock::desiredPinLevel() const {
+    uint8_t control = _regs[REG_CONTROL];
+    if (control & CONTROL_INTCN) {
+        uint8_t status = _regs[REG_STATUS];
+        bool asserted = ((status & STATUS_A1F) && (control & CONTROL_A1IE)) ||
+                        ((status & STATUS_A2F) && (control & CONTROL_A2IE));
+        return !asserted;
+    }
+    if (control & CONTROL_RS) {
+        return true;  // kHz square waves are not emulated
+    }
+    // 1 Hz: low for the first half of each second
+    return rtcUsAt(DS3231Host::nowUs()) % US_PER_SECOND >= US_PER_SECOND / 2;
+}
+
+int64_t DS3231Mock::nextEventUs() const {
+    int64_t now = DS3231Host::nowUs();
+    if (desiredPinLevel() != _pinHigh) {
+        return now;
+    }
+    uint8_t control = _regs[REG_CONTROL];
+    if (!(control & CONTROL_INTCN)) {
+        if (control & CONTROL_RS) {
+            return INT64_MAX;
+        }
+        int64_t halfSecond = US_PER_SECOND / 2;
+        return hostUsAt((rtcUsAt(now) / halfSecond + 1) * halfSecond);
+    }
+    if (control & (CONTROL_A1IE | CONTROL_A2IE)) {
+        return hostUsAt((static_cast<int64_t>(_alarmsCheckedEpoch) + 1) * US_PER_SECOND);
+    }
+    return INT64_MAX;
+}
+
+void DS3231Mock::onEvent(int64_t nowUs) {
+    (void)nowUs;
+    sync();
+    bool high = desiredPinLevel();
+    if (high != _pinHigh && _pin >= 0) {
+        _pinHigh = high;
+        DS3231Host::setPinLevel(_pin, high);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// DS3231MockEeprom
+// ----------------------------------------------------------------------------
+
+DS3231MockEeprom::DS3231MockEeprom() {
+    memset(_data, 0xFF, sizeof(_data));  // Erased
+}
+
+void DS3231MockEeprom::attach(TwoWire& wire, uint8_t address) {
+    detach();
+    wire.attach(address, *this);
+    _wire = &wire;
+    _busAddress = address;
+}
+
+void DS3231MockEeprom::detach() {
+    if (_wire) {
+        _wire->detach(_busAddress);
+        _wire = nullptr;
+    }
+}
+
+bool DS3231MockEeprom::write(const uint8_t* data, size_t length) {
+    if (busy()) {
+        return false;  // NACK during the write cycle (ACK polling)
+    }
+    if (length < 2) {
+        return true;
+    }
+    _address = ((data[0] << 8) | data[1]) % SIZE;
+    if (length == 2) {
+        return true;  // Address set for a random read
+    }
+
+    uint16_t page = _address & ~(PAGE_SIZE - 1);
+    uint16_t offset = _address & (PAGE_SIZE - 1);
+    for (size_t i = 2; i < length; i++) {
+        _data[page | offset] = data[i];
+        offset = (offset + 1) & (PAGE_SIZE - 1);  // Wraps within the page
+    }
+    _address = page | offset;
+    _busyUntilUs = DS3231Host::nowUs() + _writeCycleUs;
+    _pageWrites++;
+    return true;
+}
+
+size_t DS3231MockEeprom::read(uint8_t* data, size_t length) {
+    if (busy()) {
+        return 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        data[i] = _data[_address];
+        _address = (_address + 1) % SIZE;
+    }
+    return length;
+}
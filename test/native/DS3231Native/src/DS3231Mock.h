@@ -0,0 +1,167 @@
+/*
+ * DS3231Mock.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_MOCK_H
+#define DS3231_MOCK_H
+
+#include <Wire.h>
+#include <RTClib.h>
+#include "DS3231Host.h"
+
+// Register-level DS3231 on the host I2C bus.
+//
+// Timekeeping follows DS3231Host time: the registers read back the time last
+// written plus the elapsed host time, scaled by the configured drift and the
+// aging offset (0.1 ppm per LSB, positive slows the clock). Writing the
+// seconds register restarts the sub-second countdown, as on the chip.
+// Alarm flags are set for every matching second the clock passes, even
+// across large jumps; temperature conversions run every 64 s and on CONV and
+// hold BSY while they last.
+//
+// With connectInterrupt() the mock drives INT/SQW on a host GPIO: low while
+// an enabled alarm flag is set (INTCN=1), or the 1 Hz square wave with its
+// falling edge at each seconds rollover (INTCN=0, RS=00). Faster square
+// waves are not emulated and leave the pin high.
+class DS3231Mock : public TwoWireDevice, private DS3231Host::Listener {
+public:
+    static constexpr uint8_t ADDRESS = 0x68;
+    static constexpr uint8_t REGISTER_COUNT = 0x13;
+
+    // Power-on state: 2000-01-01 00:00:00, OSF set, INTCN set, 25 °C
+    DS3231Mock();
+    ~DS3231Mock() override;
+
+    DS3231Mock(const DS3231Mock&) = delete;
+    DS3231Mock& operator=(const DS3231Mock&) = delete;
+
+    // On one bus at a time; the destructor detaches
+    void attach(TwoWire& wire = Wire);
+    void detach();
+
+    // Set the time as a host would from outside the bus; clears OSF
+    void setTime(const DateTime& time);
+    DateTime time();
+    int64_t subsecondUs();  // Into the current RTC second
+
+    // Fractional rate error before the aging offset, positive = runs fast
+    void setDriftPpm(double ppm);
+    void setTemperature(float celsius);  // Latched by the next conversion
+    void setConversionTimeMs(uint32_t ms) { _conversionUs = static_cast<int64_t>(ms) * 1000; }
+    void stopOscillator();               // Power loss: sets OSF
+
+    // Drive INT/SQW on this host GPIO (-1 disconnects)
+    void connectInterrupt(int8_t pin);
+
+    // Register access without bus traffic
+    uint8_t peek(uint8_t reg);
+    void poke(uint8_t reg, uint8_t value);
+
+    // Bus traffic seen by this device
+    uint32_t readTransactions() const { return _reads; }
+    uint32_t writeTransactions() const { return _writes; }
+
+    // TwoWireDevice
+    bool write(const uint8_t* data, size_t length) override;
+    size_t read(uint8_t* data, size_t length) override;
+
+private:
+    static constexpr int64_t US_PER_SECOND = 1000000;
+    static constexpr int64_t AUTO_CONVERSION_PERIOD_US = 64 * US_PER_SECOND;
+
+    // DS3231Host::Listener: pin edges
+    int64_t nextEventUs() const override;
+    void onEvent(int64_t nowUs) override;
+
+    int64_t rtcUsAt(int64_t hostUs) const;
+    int64_t hostUsAt(int64_t rtcUs) const;
+    double rate() const;
+    void rebase();
+    void sync();
+    void setRtcUs(int64_t rtcUs);
+    void renderTime(uint32_t epoch);
+    uint32_t parseTime() const;
+    void scanAlarms(uint32_t fromEpoch, uint32_t toEpoch);
+    bool alarmMatches(uint8_t alarm, uint32_t epoch) const;
+    void latchTemperature();
+    bool desiredPinLevel() const;
+
+    TwoWire* _wire = nullptr;
+    uint8_t _regs[REGISTER_COUNT];
+    uint8_t _pointer = 0;
+
+    // RTC time in microseconds since 1970 is _baseRtcUs at host _baseUs
+    int64_t _baseUs;
+    int64_t _baseRtcUs;
+    double _driftPpm = 0.0;
+    uint8_t _dowOffset = 0;
+    uint32_t _alarmsCheckedEpoch;
+
+    float _temperatureC = 25.0f;
+    int64_t _conversionUs = 125000;
+    int64_t _conversionDoneUs = -1;  // Forced conversion in flight
+    int64_t _powerOnUs;
+    int64_t _nextAutoConversionUs;
+
+    int8_t _pin = -1;
+    bool _pinHigh = true;
+
+    uint32_t _reads = 0;
+    uint32_t _writes = 0;
+};
+
+// AT24C32 EEPROM as fitted to DS3231 modules: 4 KiB, 32-byte pages that
+// wrap within the page, and a write cycle during which the chip NACKs
+class DS3231MockEeprom : public TwoWireDevice {
+public:
+    static constexpr uint8_t ADDRESS = 0x57;
+    static constexpr uint16_t SIZE = 4096;
+    static constexpr uint16_t PAGE_SIZE = 32;
+
+    DS3231MockEeprom();
+
+    DS3231MockEeprom(const DS3231MockEeprom&) = delete;
+    DS3231MockEeprom& operator=(const DS3231MockEeprom&) = delete;
+    ~DS3231MockEeprom() override { detach(); }
+
+    void attach(TwoWire& wire = Wire, uint8_t address = ADDRESS);
+    void detach();
+
+    void setWriteCycleMs(uint32_t ms) { _writeCycleUs = static_cast<int64_t>(ms) * 1000; }
+    uint8_t* data() { return _data; }
+    uint32_t pageWrites() const { return _pageWrites; }
+
+    // TwoWireDevice
+    bool write(const uint8_t* data, size_t length) override;
+    size_t read(uint8_t* data, size_t length) override;
+
+private:
+    bool busy() const { return DS3231Host::nowUs() < _busyUntilUs; }
+
+    TwoWire* _wire = nullptr;
+    uint8_t _busAddress = ADDRESS;
+    uint8_t _data[SIZE];
+    uint16_t _address = 0;
+    int64_t _writeCycleUs = 5000;
+    int64_t _busyUntilUs = 0;
+    uint32_t _pageWrites = 0;
+};
+
+#endif // DS3231_MOCK_H
@@ -0,0 +1,451 @@
+/*
+ * DS3231NativePlatform.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// FreeRTOS, esp_timer, esp_sleep, esp_log and settimeofday() for the host
+// build, all driven by DS3231Host
+
+#include "DS3231Host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "esp_log.h"
+
+#include <stdarg.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Semaphores
+// ----------------------------------------------------------------------------
+
+struct HostSemaphore {
+    bool recursive;
+    UBaseType_t count;  // Nested takes (recursive), else 1 while taken or empty
+};
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    return new HostSemaphore{true, 0};
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new HostSemaphore{false, 0};
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new HostSemaphore{false, 1};  // Created empty: one "take" is outstanding
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!semaphore || !semaphore->recursive) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+    if (!semaphore || !semaphore->recursive || semaphore->count == 0) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!semaphore || semaphore->recursive || semaphore->count != 0) {
+        return pdFALSE;
+    }
+    semaphore->count = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (!semaphore || semaphore->recursive || semaphore->count == 0) {
+        return pdFALSE;
+    }
+    semaphore->count = 0;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+// ----------------------------------------------------------------------------
+// Tasks
+// ----------------------------------------------------------------------------
+
+struct HostTask {
+    int unused;
+};
+
+static HostTask mainTask = {0};
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* createdTask, BaseType_t coreId) {
+    (void)code;
+    (void)name;
+    (void)stackDepth;
+    (void)parameters;
+    (void)priority;
+    (void)coreId;
+    if (createdTask) {
+        *createdTask = nullptr;
+    }
+    return pdFAIL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* createdTask) {
+    return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    (void)task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    DS3231Host::advanceMs(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(DS3231Host::nowUs() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return &mainTask;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    (void)task;
+    (void)value;
+    (void)action;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticksToWait) {
+    (void)clearOnEntry;
+    (void)clearOnExit;
+    (void)ticksToWait;
+    if (value) {
+        *value = 0;
+    }
+    return pdFALSE;
+}
+
+// ----------------------------------------------------------------------------
+// Queues
+// ----------------------------------------------------------------------------
+
+struct HostQueue {
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new HostQueue{length, itemSize, {}};
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!queue || queue->items.size() >= queue->length) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!queue || queue->items.empty()) {
+        return pdFALSE;
+    }
+    memcpy(buffer, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue ? static_cast<UBaseType_t>(queue->items.size()) : 0;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (queue) {
+        queue->items.clear();
+    }
+    return pdPASS;
+}
+
+// ----------------------------------------------------------------------------
+// esp_timer
+// ----------------------------------------------------------------------------
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    bool armed;
+    int64_t deadlineUs;
+    uint64_t periodUs;  // 0 = one-shot
+};
+
+namespace {
+
+// Fires the earliest armed timer whenever DS3231Host time reaches it
+class TimerDispatcher : public DS3231Host::Listener {
+public:
+    void add(esp_timer* timer) {
+        _timers.push_back(timer);
+        DS3231Host::addListener(this);
+    }
+
+    void remove(esp_timer* timer) {
+        for (size_t i = 0; i < _timers.size(); i++) {
+            if (_timers[i] == timer) {
+                _timers.erase(_timers.begin() + i);
+                break;
+            }
+        }
+        if (_timers.empty()) {
+            DS3231Host::removeListener(this);
+        }
+    }
+
+    int64_t nextEventUs() const override {
+        const esp_timer* next = earliest();
+        return next ? next->deadlineUs : INT64_MAX;
+    }
+
+    void onEvent(int64_t nowUs) override {
+        esp_timer* timer = earliest();
+        if (!timer || timer->deadlineUs > nowUs) {
+            return;
+        }
+        if (timer->periodUs) {
+            timer->deadlineUs += static_cast<int64_t>(timer->periodUs);
+        } else {
+            timer->armed = false;
+        }
+        timer->callback(timer->arg);
+    }
+
+private:
+    esp_timer* earliest() const {
+        esp_timer* next = nullptr;
+        for (esp_timer* timer : _timers) {
+            if (timer->armed && (!next || timer->deadlineUs < next->deadlineUs)) {
+                next = timer;
+            }
+        }
+        return next;
+    }
+
+    std::vector<esp_timer*> _timers;
+};
+
+TimerDispatcher& timerDispatcher() {
+    static TimerDispatcher dispatcher;
+    return dispatcher;
+}
+
+}  // namespace
+
+int64_t esp_timer_get_time() {
+    return DS3231Host::nowUs();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* outHandle) {
+    if (!args || !args->callback || !outHandle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *outHandle = new esp_timer{args->callback, args->arg, false, 0, 0};
+    timerDispatcher().add(*outHandle);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->deadlineUs = DS3231Host::nowUs() + static_cast<int64_t>(timeoutUs);
+    timer->periodUs = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (!timer || periodUs == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->deadlineUs = DS3231Host::nowUs() + static_cast<int64_t>(periodUs);
+    timer->periodUs = periodUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timerDispatcher().remove(timer);
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->armed;
+}
+
+// ----------------------------------------------------------------------------
+// Sleep
+// ----------------------------------------------------------------------------
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return static_cast<esp_sleep_wakeup_cause_t>(DS3231Host::wakeupCause());
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio, int level) {
+    (void)level;
+    return gpio >= 0 && gpio < 40 ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode) {
+    (void)mode;
+    return mask ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+    (void)timeUs;
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    DS3231Host::noteDeepSleep();
+}
+
+esp_err_t esp_light_sleep_start() {
+    return ESP_OK;
+}
+
+// ----------------------------------------------------------------------------
+// Logging
+// ----------------------------------------------------------------------------
+
+static esp_log_level_t logLevel = ESP_LOG_ERROR;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+    (void)tag;
+    logLevel = level;
+}
+
+esp_log_level_t esp_log_level_get(const char* tag) {
+    (void)tag;
+    return logLevel;
+}
+
+unsigned long esp_log_timestamp() {
+    return static_cast<unsigned long>(DS3231Host::nowUs() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    (void)tag;
+    if (level > logLevel) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+// ----------------------------------------------------------------------------
+// System clock: recorded instead of setting the host's
+// ----------------------------------------------------------------------------
+
+#if defined(__GLIBC__)
+extern "C" int settimeofday(const struct timeval* tv, const struct timezone* tz) noexcept {
+#else
+extern "C" int settimeofday(const struct timeval* tv, const struct timezone* tz) {
+#endif
+    (void)tz;
+    if (!tv) {
+        return -1;
+    }
+    DS3231Host::noteSystemTime(*tv);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Preferences.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "Preferences.h"
+#include <string.h>
+#include <map>
+#include <vector>
+
+namespace {
+
+std::map<std::string, std::vector<uint8_t>>& store() {
+    static std::map<std::string, std::vector<uint8_t>> blobs;
+    return blobs;
+}
+
+uint32_t writeCount = 0;
+
+}  // namespace
+
+void hostClearPreferences() {
+    store().clear();
+    writeCount = 0;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (!name || !*name || strlen(name) > 15) {
+        return false;
+    }
+    _namespace = name;
+    _readOnly = readOnly;
+    _started = true;
+    return true;
+}
+
+void Preferences::end() {
+    _started = false;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!_started || _readOnly || !key || !value || length == 0) {
+        return 0;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    store()[path(key)] = std::vector<uint8_t>(bytes, bytes + length);
+    writeCount++;
+    return length;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    if (!_started || !key || !buffer) {
+        return 0;
+    }
+    auto it = store().find(path(key));
+    if (it == store().end() || it->second.size() > maxLength) {
+        return 0;
+    }
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!_started || !key) {
+        return 0;
+    }
+    auto it = store().find(path(key));
+    return it == store().end() ? 0 : it->second.size();
+}
+
+bool Preferences::isKey(const char* key) {
+    return _started && key && store().count(path(key)) > 0;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_started || _readOnly || !key) {
+        return false;
+    }
+    return store().erase(path(key)) > 0;
+}
+
+bool Preferences::clear() {
+    if (!_started || _readOnly) {
+        return false;
+    }
+    std::string prefix = _namespace + '/';
+    for (auto it = store().begin(); it != store().end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? store().erase(it) : std::next(it);
+    }
+    return true;
+}
+
+uint32_t Preferences::writes() {
+    return writeCount;
+}
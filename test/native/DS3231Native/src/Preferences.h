@@ -0,0 +1,53 @@
+/*
+ * Preferences.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NATIVE_PREFERENCES_H
+#define DS3231_NATIVE_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// In-memory NVS behind the Arduino Preferences blob API. All instances share
+// one store per namespace; DS3231Host::reset() empties it.
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+    bool isKey(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+    static uint32_t writes();  // putBytes() calls that reached the store, across instances
+
+private:
+    std::string path(const char* key) const { return _namespace + '/' + key; }
+
+    std::string _namespace;
+    bool _started = false;
+    bool _readOnly = false;
+};
+
+#endif // DS3231_NATIVE_PREFERENCES_H
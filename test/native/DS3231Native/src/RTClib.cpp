@@ -0,0 +1,353 @@
+/*
+ * RTClib.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "RTClib.h"
+
+static constexpr uint8_t DS3231_ADDRESS = 0x68;
+static constexpr uint8_t DS3231_TIME = 0x00;
+static constexpr uint8_t DS3231_ALARM1 = 0x07;
+static constexpr uint8_t DS3231_ALARM2 = 0x0B;
+static constexpr uint8_t DS3231_CONTROL = 0x0E;
+static constexpr uint8_t DS3231_STATUSREG = 0x0F;
+static constexpr uint8_t DS3231_TEMPERATUREREG = 0x11;
+
+static const uint8_t daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30};
+
+static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d) {
+    if (y >= 2000U) {
+        y -= 2000U;
+    }
+    uint16_t days = d;
+    for (uint8_t i = 1; i < m; ++i) {
+        days += daysInMonth[i - 1];
+    }
+    if (m > 2 && y % 4 == 0) {
+        ++days;
+    }
+    return days + 365 * y + (y + 3) / 4 - 1;
+}
+
+static uint32_t time2ulong(uint16_t days, uint8_t h, uint8_t m, uint8_t s) {
+    return ((days * 24UL + h) * 60 + m) * 60 + s;
+}
+
+static uint8_t conv2d(const char* p) {
+    uint8_t v = 0;
+    if ('0' <= *p && *p <= '9') {
+        v = *p - '0';
+    }
+    return 10 * v + *++p - '0';
+}
+
+static uint8_t dowToDS3231(uint8_t d) {
+    return d == 0 ? 7 : d;
+}
+
+DateTime::DateTime(uint32_t t) {
+    t -= SECONDS_FROM_1970_TO_2000;
+    ss = t % 60;
+    t /= 60;
+    mm = t % 60;
+    t /= 60;
+    hh = t % 24;
+    uint16_t days = t / 24;
+    uint8_t leap;
+    for (yOff = 0;; ++yOff) {
+        leap = yOff % 4 == 0;
+        if (days < 365U + leap) {
+            break;
+        }
+        days -= 365 + leap;
+    }
+    for (m = 1; m < 12; ++m) {
+        uint8_t daysPerMonth = daysInMonth[m - 1];
+        if (leap && m == 2) {
+            ++daysPerMonth;
+        }
+        if (days < daysPerMonth) {
+            break;
+        }
+        days -= daysPerMonth;
+    }
+    d = days + 1;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec) {
+    if (year >= 2000U) {
+        year -= 2000U;
+    }
+    yOff = year;
+    m = month;
+    d = day;
+    hh = hour;
+    mm = min;
+    ss = sec;
+}
+
+DateTime::DateTime(const char* date, const char* time) {
+    yOff = conv2d(date + 9);
+    switch (date[0]) {
+    case 'J': m = (date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7); break;
+    case 'F': m = 2; break;
+    case 'A': m = date[2] == 'r' ? 4 : 8; break;
+    case 'M': m = date[2] == 'r' ? 3 : 5; break;
+    case 'S': m = 9; break;
+    case 'O': m = 10; break;
+    case 'N': m = 11; break;
+    case 'D': m = 12; break;
+    default: m = 0; break;
+    }
+    d = conv2d(date + 4);
+    hh = conv2d(time);
+    mm = conv2d(time + 3);
+    ss = conv2d(time + 6);
+}
+
+DateTime::DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time)
+    : DateTime(reinterpret_cast<const char*>(date), reinterpret_cast<const char*>(time)) {}
+
+bool DateTime::isValid() const {
+    if (yOff >= 100) {
+        return false;
+    }
+    DateTime other(unixtime());
+    return yOff == other.yOff && m == other.m && d == other.d && hh == other.hh && mm == other.mm &&
+           ss == other.ss;
+}
+
+uint8_t DateTime::dayOfTheWeek() const {
+    uint16_t day = date2days(yOff, m, d);
+    return (day + 6) % 7;  // Jan 1, 2000 is a Saturday
+}
+
+uint32_t DateTime::secondstime() const {
+    return time2ulong(date2days(yOff, m, d), hh, mm, ss);
+}
+
+uint32_t DateTime::unixtime() const {
+    return secondstime() + SECONDS_FROM_1970_TO_2000;
+}
+
+String DateTime::timestamp(timestampOpt opt) const {
+    char buffer[25];
+    switch (opt) {
+    case TIMESTAMP_TIME:
+        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", hh, mm, ss);
+        break;
+    case TIMESTAMP_DATE:
+        snprintf(buffer, sizeof(buffer), "%u-%02d-%02d", 2000U + yOff, m, d);
+        break;
+    default:
+        snprintf(buffer, sizeof(buffer), "%u-%02d-%02dT%02d:%02d:%02d", 2000U + yOff, m, d, hh, mm, ss);
+        break;
+    }
+    return String(buffer);
+}
+
+DateTime DateTime::operator+(const TimeSpan& span) const {
+    return DateTime(unixtime() + span.totalseconds());
+}
+
+DateTime DateTime::operator-(const TimeSpan& span) const {
+    return DateTime(unixtime() - span.totalseconds());
+}
+
+TimeSpan DateTime::operator-(const DateTime& right) const {
+    return TimeSpan(static_cast<int32_t>(unixtime() - right.unixtime()));
+}
+
+bool DateTime::operator<(const DateTime& right) const {
+    return yOff + 2000U < right.year() ||
+           (yOff + 2000U == right.year() &&
+            (m < right.month() ||
+             (m == right.month() &&
+              (d < right.day() ||
+               (d == right.day() &&
+                (hh < right.hour() ||
+                 (hh == right.hour() && (mm < right.minute() || (mm == right.minute() && ss < right.second())))))))));
+}
+
+bool DateTime::operator==(const DateTime& right) const {
+    return right.year() == yOff + 2000U && right.month() == m && right.day() == d && right.hour() == hh &&
+           right.minute() == mm && right.second() == ss;
+}
+
+bool RTC_DS3231::begin(TwoWire* wire) {
+    _wire = wire;
+    _wire->beginTransmission(DS3231_ADDRESS);
+    return _wire->endTransmission() == 0;
+}
+
+void RTC_DS3231::adjust(const DateTime& dt) {
+    uint8_t buffer[8] = {DS3231_TIME,
+                         bin2bcd(dt.second()),
+                         bin2bcd(dt.minute()),
+                         bin2bcd(dt.hour()),
+                         bin2bcd(dowToDS3231(dt.dayOfTheWeek())),
+                         bin2bcd(dt.day()),
+                         bin2bcd(dt.month()),
+                         bin2bcd(dt.year() - 2000U)};
+    writeBlock(buffer, sizeof(buffer));
+
+    uint8_t status = readRegister(DS3231_STATUSREG);
+    status &= ~0x80;  // Clear OSF
+    writeRegister(DS3231_STATUSREG, status);
+}
+
+bool RTC_DS3231::lostPower() {
+    return readRegister(DS3231_STATUSREG) >> 7;
+}
+
+DateTime RTC_DS3231::now() {
+    uint8_t buffer[7] = {};
+    readBlock(DS3231_TIME, buffer, sizeof(buffer));
+    return DateTime(bcd2bin(buffer[6]) + 2000U, bcd2bin(buffer[5] & 0x7F), bcd2bin(buffer[4]),
+                    bcd2bin(buffer[2]), bcd2bin(buffer[1]), bcd2bin(buffer[0] & 0x7F));
+}
+
+Ds3231SqwPinMode RTC_DS3231::readSqwPinMode() {
+    int mode = readRegister(DS3231_CONTROL) & 0x1C;
+    if (mode & 0x04) {
+        mode = DS3231_OFF;
+    }
+    return static_cast<Ds3231SqwPinMode>(mode);
+}
+
+void RTC_DS3231::writeSqwPinMode(Ds3231SqwPinMode mode) {
+    uint8_t ctrl = readRegister(DS3231_CONTROL);
+    ctrl &= ~0x04;  // Turn off INTCN
+    ctrl &= ~0x18;  // Set freq bits to 0
+    ctrl |= mode;
+    writeRegister(DS3231_CONTROL, ctrl);
+}
+
+bool RTC_DS3231::setAlarm1(const DateTime& dt, Ds3231Alarm1Mode alarmMode) {
+    uint8_t ctrl = readRegister(DS3231_CONTROL);
+    if (!(ctrl & 0x04)) {
+        return false;
+    }
+
+    uint8_t A1M1 = (alarmMode & 0x01) << 7;
+    uint8_t A1M2 = (alarmMode & 0x02) << 6;
+    uint8_t A1M3 = (alarmMode & 0x04) << 5;
+    uint8_t A1M4 = (alarmMode & 0x08) << 4;
+    uint8_t DY_DT = (alarmMode & 0x10) << 2;
+    uint8_t day = DY_DT ? dowToDS3231(dt.dayOfTheWeek()) : dt.day();
+
+    uint8_t buffer[5] = {DS3231_ALARM1, static_cast<uint8_t>(bin2bcd(dt.second()) | A1M1),
+                         static_cast<uint8_t>(bin2bcd(dt.minute()) | A1M2),
+                         static_cast<uint8_t>(bin2bcd(dt.hour()) | A1M3),
+                         static_cast<uint8_t>(bin2bcd(day) | A1M4 | DY_DT)};
+    writeBlock(buffer, sizeof(buffer));
+
+    writeRegister(DS3231_CONTROL, ctrl | 0x01);  // AI1E
+    return true;
+}
+
+bool RTC_DS3231::setAlarm2(const DateTime& dt, Ds3231Alarm2Mode alarmMode) {
+    uint8_t ctrl = readRegister(DS3231_CONTROL);
+    if (!(ctrl & 0x04)) {
+        return false;
+    }
+
+    uint8_t A2M2 = (alarmMode & 0x01) << 7;
+    uint8_t A2M3 = (alarmMode & 0x02) << 6;
+    uint8_t A2M4 = (alarmMode & 0x04) << 5;
+    uint8_t DY_DT = (alarmMode & 0x08) << 3;
+    uint8_t day = DY_DT ? dowToDS3231(dt.dayOfTheWeek()) : dt.day();
+
+    uint8_t buffer[4] = {DS3231_ALARM2, static_cast<uint8_t>(bin2bcd(dt.minute()) | A2M2),
+                         static_cast<uint8_t>(bin2bcd(dt.hour()) | A2M3),
+                         static_cast<uint8_t>(bin2bcd(day) | A2M4 | DY_DT)};
+    writeBlock(buffer, sizeof(buffer));
+
+    writeRegister(DS3231_CONTROL, ctrl | 0x02);  // AI2E
+    return true;
+}
+
+void RTC_DS3231::disableAlarm(uint8_t alarmNum) {
+    uint8_t ctrl = readRegister(DS3231_CONTROL);
+    ctrl &= ~(1 << (alarmNum - 1));
+    writeRegister(DS3231_CONTROL, ctrl);
+}
+
+void RTC_DS3231::clearAlarm(uint8_t alarmNum) {
+    uint8_t status = readRegister(DS3231_STATUSREG);
+    status &= ~(0x1 << (alarmNum - 1));
+    writeRegister(DS3231_STATUSREG, status);
+}
+
+bool RTC_DS3231::alarmFired(uint8_t alarmNum) {
+    return (readRegister(DS3231_STATUSREG) >> (alarmNum - 1)) & 0x1;
+}
+
+void RTC_DS3231::enable32K() {
+    writeRegister(DS3231_STATUSREG, readRegister(DS3231_STATUSREG) | 0x08);
+}
+
+void RTC_DS3231::disable32K() {
+    writeRegister(DS3231_STATUSREG, readRegister(DS3231_STATUSREG) & ~0x08);
+}
+
+bool RTC_DS3231::isEnabled32K() {
+    return (readRegister(DS3231_STATUSREG) >> 3) & 0x01;
+}
+
+float RTC_DS3231::getTemperature() {
+    uint8_t buffer[2] = {};
+    readBlock(DS3231_TEMPERATUREREG, buffer, sizeof(buffer));
+    return static_cast<float>(static_cast<int8_t>(buffer[0])) + (buffer[1] >> 6) * 0.25f;
+}
+
+uint8_t RTC_DS3231::readRegister(uint8_t reg) {
+    uint8_t value = 0;
+    readBlock(reg, &value, 1);
+    return value;
+}
+
+void RTC_DS3231::writeRegister(uint8_t reg, uint8_t value) {
+    uint8_t buffer[2] = {reg, value};
+    writeBlock(buffer, sizeof(buffer));
+}
+
+bool RTC_DS3231::readBlock(uint8_t reg, uint8_t* buffer, size_t length) {
+    if (!_wire) {
+        return false;
+    }
+    _wire->beginTransmission(DS3231_ADDRESS);
+    _wire->write(reg);
+    if (_wire->endTransmission(false) != 0 || _wire->requestFrom(DS3231_ADDRESS, length, true) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        buffer[i] = static_cast<uint8_t>(_wire->read());
+    }
+    return true;
+}
+
+bool RTC_DS3231::writeBlock(const uint8_t* buffer, size_t length) {
+    if (!_wire) {
+        return false;
+    }
+    _wire->beginTransmission(DS3231_ADDRESS);
+    _wire->write(buffer, length);
+    return _wire->endTransmission() == 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * RTClib.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NATIVE_RTCLIB_H
+#define DS3231_NATIVE_RTCLIB_H
+
+// The parts of Adafruit RTClib 2.1.4 the library uses: DateTime and TimeSpan
+// with RTClib's arithmetic, and RTC_DS3231 talking to register 0x68 over
+// TwoWire exactly as RTClib does, so a DS3231Mock on the bus sees the same
+// transactions as a real chip would.
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define SECONDS_FROM_1970_TO_2000 946684800
+
+class TimeSpan;
+
+class DateTime {
+public:
+    DateTime(uint32_t t = SECONDS_FROM_1970_TO_2000);
+    DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+    DateTime(const DateTime& copy) = default;
+    DateTime(const char* date, const char* time);  // __DATE__, __TIME__
+    DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time);
+    DateTime& operator=(const DateTime&) = default;
+
+    bool isValid() const;
+
+    uint16_t year() const { return 2000U + yOff; }
+    uint8_t month() const { return m; }
+    uint8_t day() const { return d; }
+    uint8_t hour() const { return hh; }
+    uint8_t minute() const { return mm; }
+    uint8_t second() const { return ss; }
+    uint8_t dayOfTheWeek() const;
+
+    uint32_t secondstime() const;
+    uint32_t unixtime() const;
+
+    enum timestampOpt { TIMESTAMP_FULL, TIMESTAMP_TIME, TIMESTAMP_DATE };
+    String timestamp(timestampOpt opt = TIMESTAMP_FULL) const;
+
+    DateTime operator+(const TimeSpan& span) const;
+    DateTime operator-(const TimeSpan& span) const;
+    TimeSpan operator-(const DateTime& right) const;
+    bool operator<(const DateTime& right) const;
+    bool operator>(const DateTime& right) const { return right < *this; }
+    bool operator<=(const DateTime& right) const { return !(*this > right); }
+    bool operator>=(const DateTime& right) const { return !(*this < right); }
+    bool operator==(const DateTime& right) const;
+    bool operator!=(const DateTime& right) const { return !(*this == right); }
+
+protected:
+    uint8_t yOff;
+    uint8_t m;
+    uint8_t d;
+    uint8_t hh;
+    uint8_t mm;
+    uint8_t ss;
+};
+
+class TimeSpan {
+public:
+    TimeSpan(int32_t seconds = 0) : _seconds(seconds) {}
+    TimeSpan(int16_t days, int8_t hours, int8_t minutes, int8_t seconds)
+        : _seconds(static_cast<int32_t>(days) * 86400L + static_cast<int32_t>(hours) * 3600 +
+                   static_cast<int32_t>(minutes) * 60 + seconds) {}
+    TimeSpan(const TimeSpan& copy) = default;
+    TimeSpan& operator=(const TimeSpan&) = default;
+
+    int16_t days() const { return _seconds / 86400L; }
+    int8_t hours() const { return _seconds / 3600 % 24; }
+    int8_t minutes() const { return _seconds / 60 % 60; }
+    int8_t seconds() const { return _seconds % 60; }
+    int32_t totalseconds() const { return _seconds; }
+
+    TimeSpan operator+(const TimeSpan& right) const { return TimeSpan(_seconds + right._seconds); }
+    TimeSpan operator-(const TimeSpan& right) const { return TimeSpan(_seconds - right._seconds); }
+
+protected:
+    int32_t _seconds;
+};
+
+enum Ds3231SqwPinMode {
+    DS3231_OFF = 0x1C,
+    DS3231_SquareWave1Hz = 0x00,
+    DS3231_SquareWave1kHz = 0x08,
+    DS3231_SquareWave4kHz = 0x10,
+    DS3231_SquareWave8kHz = 0x18
+};
+
+enum Ds3231Alarm1Mode {
+    DS3231_A1_PerSecond = 0x0F,
+    DS3231_A1_Second = 0x0E,
+    DS3231_A1_Minute = 0x0C,
+    DS3231_A1_Hour = 0x08,
+    DS3231_A1_Date = 0x00,
+    DS3231_A1_Day = 0x10
+};
+
+enum Ds3231Alarm2Mode {
+    DS3231_A2_PerMinute = 0x7,
+    DS3231_A2_Minute = 0x6,
+    DS3231_A2_Hour = 0x4,
+    DS3231_A2_Date = 0x0,
+    DS3231_A2_Day = 0x8
+};
+
+class RTC_DS3231 {
+public:
+    bool begin(TwoWire* wire = &Wire);
+    void adjust(const DateTime& dt);
+    bool lostPower();
+    DateTime now();
+    Ds3231SqwPinMode readSqwPinMode();
+    void writeSqwPinMode(Ds3231SqwPinMode mode);
+    bool setAlarm1(const DateTime& dt, Ds3231Alarm1Mode alarmMode);
+    bool setAlarm2(const DateTime& dt, Ds3231Alarm2Mode alarmMode);
+    void disableAlarm(uint8_t alarmNum);
+    void clearAlarm(uint8_t alarmNum);
+    bool alarmFired(uint8_t alarmNum);
+    void enable32K();
+    void disable32K();
+    bool isEnabled32K();
+    float getTemperature();
+
+    static uint8_t bcd2bin(uint8_t val) { return val - 6 * (val >> 4); }
+    static uint8_t bin2bcd(uint8_t val) { return val + 6 * (val / 10); }
+
+private:
+    uint8_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint8_t value);
+    bool readBlock(uint8_t reg, uint8_t* buffer, size_t length);
+    bool writeBlock(const uint8_t* buffer, size_t length);
+
+    TwoWire* _wire = nullptr;
+};
+
+#endif // DS3231_NATIVE_RTCLIB_H
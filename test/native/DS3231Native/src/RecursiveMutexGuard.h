@@ -0,0 +1,50 @@
+/*
+ * RecursiveMutexGuard.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NATIVE_RECURSIVE_MUTEX_GUARD_H
+#define DS3231_NATIVE_RECURSIVE_MUTEX_GUARD_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Same interface as ESP32-MutexGuard's RecursiveMutexGuard, over the host
+// semaphores
+class RecursiveMutexGuard {
+public:
+    explicit RecursiveMutexGuard(SemaphoreHandle_t mutex, TickType_t timeout = portMAX_DELAY)
+        : _mutex(mutex), _locked(mutex && xSemaphoreTakeRecursive(mutex, timeout) == pdTRUE) {}
+    ~RecursiveMutexGuard() {
+        if (_locked) {
+            xSemaphoreGiveRecursive(_mutex);
+        }
+    }
+
+    RecursiveMutexGuard(const RecursiveMutexGuard&) = delete;
+    RecursiveMutexGuard& operator=(const RecursiveMutexGuard&) = delete;
+
+    bool hasLock() const { return _locked; }
+
+private:
+    SemaphoreHandle_t _mutex;
+    bool _locked;
+};
+
+#endif // DS3231_NATIVE_RECURSIVE_MUTEX_GUARD_H
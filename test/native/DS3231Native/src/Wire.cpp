@@ -0,0 +1,106 @@
+/*
+ * Wire.cpp - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "Wire.h"
+#include "DS3231Host.h"
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    if (frequency) {
+        _frequency = frequency;
+    }
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    _txAddress = address & 0x7F;
+    _txLength = 0;
+    _transmitting = true;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (!_transmitting || _txLength >= BUFFER_SIZE) {
+        return 0;
+    }
+    _txBuffer[_txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (written < length && write(data[written])) {
+        written++;
+    }
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    if (!_transmitting) {
+        return 4;
+    }
+    _transmitting = false;
+    charge(_txLength);
+    TwoWireDevice* device = _devices[_txAddress];
+    if (!device) {
+        return 2;
+    }
+    if (!device->write(_txBuffer, _txLength)) {
+        return _txLength ? 3 : 2;
+    }
+    return 0;
+}
+
+size_t TwoWire::requestFrom(uint8_t address, size_t length, bool sendStop) {
+    (void)sendStop;
+    _rxIndex = 0;
+    _rxLength = 0;
+    if (length > BUFFER_SIZE) {
+        return 0;
+    }
+    TwoWireDevice* device = _devices[address & 0x7F];
+    _rxLength = device ? device->read(_rxBuffer, length) : 0;
+    charge(_rxLength);
+    return _rxLength;
+}
+
+void TwoWire::attach(uint8_t address, TwoWireDevice& device) {
+    _devices[address & 0x7F] = &device;
+}
+
+void TwoWire::detach(uint8_t address) {
+    _devices[address & 0x7F] = nullptr;
+}
+
+void TwoWire::setLatency(uint32_t perTransactionUs, uint32_t perByteUs) {
+    _latencyUs = perTransactionUs;
+    _latencyPerByteUs = perByteUs;
+}
+
+void TwoWire::charge(size_t bytes) {
+    _transactions++;
+    _bytes += static_cast<uint32_t>(bytes);
+    DS3231Host::elapseUs(_latencyUs + static_cast<int64_t>(_latencyPerByteUs) * static_cast<int64_t>(bytes));
+}
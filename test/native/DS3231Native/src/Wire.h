@@ -0,0 +1,102 @@
+/*
+ * Wire.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NATIVE_WIRE_H
+#define DS3231_NATIVE_WIRE_H
+
+#include "Arduino.h"
+
+// A device on the host I2C bus. write() receives each write transaction
+// (empty for an address probe) and returns false to NACK it; read() fills up
+// to length bytes and returns how many it supplied, 0 for a NACK.
+class TwoWireDevice {
+public:
+    virtual ~TwoWireDevice() = default;
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+    virtual size_t read(uint8_t* data, size_t length) = 0;
+};
+
+// ESP32 TwoWire over devices attached by address. Every transaction charges
+// setLatency() time to DS3231Host without dispatching, so a test can price
+// an API call in bus time as well as count its transactions.
+class TwoWire : public Stream {
+public:
+    static constexpr size_t BUFFER_SIZE = 128;  // Arduino-ESP32 I2C_BUFFER_LENGTH
+
+    explicit TwoWire(uint8_t busNum) : _busNum(busNum) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end() { return true; }
+    bool setClock(uint32_t frequency) { _frequency = frequency; return true; }
+    uint32_t getClock() const { return _frequency; }
+    void setTimeOut(uint16_t timeoutMs) { _timeoutMs = timeoutMs; }
+    uint16_t getTimeOut() const { return _timeoutMs; }
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission(static_cast<uint8_t>(address)); }
+    uint8_t endTransmission(bool sendStop = true);  // 0 ok, 2 address NACK, 3 data NACK, 4 other
+    size_t requestFrom(uint8_t address, size_t length, bool sendStop = true);
+    uint8_t requestFrom(int address, int length) {
+        return static_cast<uint8_t>(requestFrom(static_cast<uint8_t>(address), static_cast<size_t>(length), true));
+    }
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+    int available() override { return static_cast<int>(_rxLength - _rxIndex); }
+    int read() override { return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1; }
+    int peek() override { return _rxIndex < _rxLength ? _rxBuffer[_rxIndex] : -1; }
+    void flush() override {}
+
+    // Host side
+    void attach(uint8_t address, TwoWireDevice& device);
+    void detach(uint8_t address);
+    void setLatency(uint32_t perTransactionUs, uint32_t perByteUs = 0);
+    uint32_t transactions() const { return _transactions; }
+    uint32_t bytesTransferred() const { return _bytes; }
+    void resetCounters() { _transactions = 0; _bytes = 0; }
+
+private:
+    void charge(size_t bytes);
+
+    uint8_t _busNum;
+    uint32_t _frequency = 100000;
+    uint16_t _timeoutMs = 50;
+    TwoWireDevice* _devices[128] = {};
+
+    uint8_t _txAddress = 0;
+    bool _transmitting = false;
+    uint8_t _txBuffer[BUFFER_SIZE] = {};
+    size_t _txLength = 0;
+    uint8_t _rxBuffer[BUFFER_SIZE] = {};
+    size_t _rxLength = 0;
+    size_t _rxIndex = 0;
+
+    uint32_t _latencyUs = 0;
+    uint32_t _latencyPerByteUs = 0;
+    uint32_t _transactions = 0;
+    uint32_t _bytes = 0;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif // DS3231_NATIVE_WIRE_H
@@ -0,0 +1,40 @@
+/*
+ * rtc_io.h - part of the ESP32-DS3231Controller library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DS3231_NATIVE_RTC_IO_H
+#define DS3231_NATIVE_RTC_IO_H
+
+#include "driver/gpio.h"
+
+// GPIOs below 40 count as RTC-capable, as on the ESP32
+inline bool rtc_gpio_is_valid_gpio(gpio_num_t gpio) {
+    return gpio >= 0 && gpio < 40;
+}
+
+inline esp_err_t rtc_gpio_pullup_en(gpio_num_t gpio) {
+    return rtc_gpio_is_valid_gpio(gpio) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+inline esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpio) {
+    return rtc_gpio_is_valid_gpio(gpio) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+#endif // DS3231_NATIVE_RTC_IO_H
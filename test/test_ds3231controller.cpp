@@ -9,9 +9,19 @@
 #include <unity.h>
 #include <string.h>
 #include "DS3231Controller.h"
+#include "DS3231SeqLatch.h"
+#include "DS3231EepromStore.h"
+#ifdef DS3231_NATIVE
+#include <DS3231Mock.h>
+#endif
 
 void setUp(void) {
     // Unity setup - called before each test
+#ifdef DS3231_NATIVE
+    DS3231Host::reset();
+    Wire.setLatency(0);
+    Wire.resetCounters();
+#endif
 }
 
 void tearDown(void) {
@@ -221,15 +231,45 @@ void test_format_day_mask_all_days(void) {
     TEST_ASSERT_TRUE(result.indexOf("Sa") >= 0);
 }
 
+void test_format_day_mask_table_matches_masks(void) {
+    const char* days[] = {"Su", "Mo", "Tu", "We", "Th", "Fr", "Sa"};
+    for (int mask = 0; mask < 128; mask++) {
+        char expected[DS3231Controller::DAY_MASK_TEXT_SIZE] = "";
+        for (int day = 0; day < 7; day++) {
+            if (mask & (1 << day)) {
+                if (expected[0]) strcat(expected, ",");
+                strcat(expected, days[day]);
+            }
+        }
+        if (!expected[0]) strcpy(expected, "None");
+        TEST_ASSERT_EQUAL_STRING(expected, DS3231Controller::dayMaskText(static_cast<uint8_t>(mask)));
+    }
+    TEST_ASSERT_EQUAL_STRING("Su", DS3231Controller::dayMaskText(0x81));  // Bit 7 ignored
+}
+
+void test_format_day_mask_buffer_is_snprintf_style(void) {
+    char buffer[6];
+    // Full length is returned; the copy is truncated and terminated
+    TEST_ASSERT_EQUAL_UINT32(14, DS3231Controller::formatDayMask(0b00111110, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_STRING("Mo,Tu", buffer);
+    TEST_ASSERT_EQUAL_UINT32(4, DS3231Controller::formatDayMask(0, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_STRING("None", buffer);
+    TEST_ASSERT_EQUAL_UINT32(20, DS3231Controller::formatDayMask(0x7F, nullptr, 0));
+
+    char timestamp[DS3231Controller::TIMESTAMP_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(19, DS3231Controller::formatTimestamp(DateTime(2025, 6, 1, 7, 5, 9),
+                                                                   timestamp, sizeof(timestamp)));
+    TEST_ASSERT_EQUAL_STRING("2025-06-01T07:05:09", timestamp);
+}
+
 // ============================================================================
 // Constants Tests
 // ============================================================================
 
 void test_max_schedules_reasonable(void) {
-    // MAX_SCHEDULES is private, but we can test behavior indirectly
-    // For now, just ensure the library concept is reasonable
     // A hot water system typically needs 1-10 schedules
-    TEST_PASS();  // Constant validation is implicit in usage
+    TEST_ASSERT_GREATER_OR_EQUAL(1, DS3231Controller::MAX_SCHEDULES);
+    TEST_ASSERT_EQUAL(32, DS3231Controller::SCHEDULE_NAME_SIZE);
 }
 
 void test_schedule_time_range_validity(void) {
@@ -302,6 +342,1618 @@ void test_schedule_can_span_midnight(void) {
     TEST_ASSERT_LESS_THAN(sched.startHour, sched.endHour);
 }
 
+// ============================================================================
+// Snapshot Evaluation (no RTC access required)
+// ============================================================================
+
+static DS3231Controller::Schedule makeSchedule(uint8_t dayMask, uint8_t startHour, uint8_t startMinute,
+                                               uint8_t endHour, uint8_t endMinute, const char* name) {
+    DS3231Controller::Schedule sched;
+    sched.id = 0;
+    sched.dayMask = dayMask;
+    sched.startHour = startHour;
+    sched.startMinute = startMinute;
+    sched.endHour = endHour;
+    sched.endMinute = endMinute;
+    sched.enabled = true;
+    sched.name = name;
+    return sched;
+}
+
+void test_evaluate_at_active_window(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111110, 6, 0, 8, 0, "Morning")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 18, 0, 21, 0, "Evening")));
+
+    // Monday 2025-01-06 07:15
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 6, 7, 15, 0));
+    TEST_ASSERT_NOT_NULL(eval.active);
+    TEST_ASSERT_EQUAL_STRING("Morning", eval.active->name.c_str());
+    TEST_ASSERT_TRUE(eval.isOn());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 8, 0, 0).unixtime(), eval.nextEnd.unixtime());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 18, 0, 0).unixtime(), eval.nextStart.unixtime());
+}
+
+void test_evaluate_at_idle_has_no_end(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111110, 6, 0, 8, 0, "Morning")));
+
+    // Saturday 2025-01-11 12:00: weekday schedule next starts Monday
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 11, 12, 0, 0));
+    TEST_ASSERT_NULL(eval.active);
+    TEST_ASSERT_FALSE(eval.isOn());
+    TEST_ASSERT_FALSE(eval.nextEnd.isValid());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 13, 6, 0, 0).unixtime(), eval.nextStart.unixtime());
+}
+
+void test_evaluate_at_midnight_span_end(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 23, 0, 1, 0, "Night")));
+
+    // Before midnight the window ends tomorrow, after midnight it ends today
+    auto late = controller.evaluateAt(DateTime(2025, 1, 6, 23, 30, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 7, 1, 0, 0).unixtime(), late.nextEnd.unixtime());
+
+    auto early = controller.evaluateAt(DateTime(2025, 1, 7, 0, 30, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 7, 1, 0, 0).unixtime(), early.nextEnd.unixtime());
+}
+
+void test_evaluate_at_vacation_suppresses(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 8, 0, "Morning")));
+    controller.setVacationMode(true, DateTime(2025, 1, 1, 0, 0, 0), DateTime(2025, 1, 31, 0, 0, 0));
+
+    DateTime at(2025, 1, 6, 7, 0, 0);
+    auto eval = controller.evaluateAt(at);
+    TEST_ASSERT_TRUE(eval.vacationActive);
+    TEST_ASSERT_NOT_NULL(eval.active);
+    TEST_ASSERT_FALSE(eval.isOn());
+    TEST_ASSERT_FALSE(controller.isWithinAnySchedule(at));
+}
+
+// ============================================================================
+// Weekly Transition Table
+// ============================================================================
+
+void test_transition_table_wraps_week(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01000000, 9, 0, 10, 0, "Saturday")));
+
+    // Saturday 2025-01-11 after the window: next start is a week later
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 11, 11, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 18, 9, 0, 0).unixtime(), eval.nextStart.unixtime());
+
+    // Exactly at the start minute the window is active and the next start is next week
+    auto atStart = controller.evaluateAt(DateTime(2025, 1, 11, 9, 0, 30));
+    TEST_ASSERT_NOT_NULL(atStart.active);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 11, 10, 0, 0).unixtime(), atStart.nextEnd.unixtime());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 18, 9, 0, 0).unixtime(), atStart.nextStart.unixtime());
+}
+
+void test_transition_table_midnight_span_belongs_to_start_day(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01000000, 23, 0, 1, 0, "Saturday night")));
+
+    // Sunday 00:30 is still inside Saturday's window even though Sunday is off
+    auto sunday = controller.evaluateAt(DateTime(2025, 1, 12, 0, 30, 0));
+    TEST_ASSERT_NOT_NULL(sunday.active);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 12, 1, 0, 0).unixtime(), sunday.nextEnd.unixtime());
+
+    // Saturday 00:30 belongs to Friday's (disabled) window
+    auto saturday = controller.evaluateAt(DateTime(2025, 1, 11, 0, 30, 0));
+    TEST_ASSERT_NULL(saturday.active);
+}
+
+void test_transition_table_rebuilt_on_update(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 8, 0, "Morning")));
+    uint8_t id = controller.getAllSchedules()[0].id;
+
+    TEST_ASSERT_TRUE(controller.updateSchedule(id, makeSchedule(0b01111111, 7, 0, 9, 0, "Morning")));
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 6, 5, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 7, 0, 0).unixtime(), eval.nextStart.unixtime());
+
+    TEST_ASSERT_TRUE(controller.removeSchedule(id));
+    TEST_ASSERT_FALSE(controller.evaluateAt(DateTime(2025, 1, 6, 5, 0, 0)).nextStart.isValid());
+}
+
+void test_coverage_merges_overlapping_and_touching(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 8, 0, "Early")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 7, 30, 9, 0, "Overlap")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 9, 0, 10, 0, "Touching")));
+
+    // Heating runs on until the union ends; the first schedule still ends at 8:00
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 6, 6, 30, 0));
+    TEST_ASSERT_EQUAL(1, eval.activeId);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 10, 0, 0).unixtime(), eval.nextEnd.unixtime());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 8, 0, 0).unixtime(), eval.nextScheduleEnd.unixtime());
+    TEST_ASSERT_TRUE(controller.isWithinAnySchedule(DateTime(2025, 1, 6, 9, 59, 0)));
+    TEST_ASSERT_FALSE(controller.isWithinAnySchedule(DateTime(2025, 1, 6, 10, 0, 0)));
+
+    // A disabled schedule leaves a gap
+    DS3231Controller::Schedule off = makeSchedule(0b01111111, 7, 30, 9, 0, "Overlap");
+    off.enabled = false;
+    TEST_ASSERT_TRUE(controller.updateSchedule(2, off));
+    auto gap = controller.evaluateAt(DateTime(2025, 1, 6, 6, 30, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 8, 0, 0).unixtime(), gap.nextEnd.unixtime());
+}
+
+void test_coverage_crosses_week_end_and_rules(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01000000, 22, 0, 2, 0, "Saturday night")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00000001, 1, 0, 3, 0, "Sunday early")));
+    DS3231Controller::Schedule rule = makeSchedule(0, 3, 0, 4, 0, "Rule");
+    rule.recurrence = DS3231Controller::Recurrence::EveryNDays;
+    rule.interval = 1;
+    rule.setDateRange(DateTime(2025, 1, 12, 0, 0, 0), DateTime(2025, 1, 12, 0, 0, 0));
+    TEST_ASSERT_TRUE(controller.addSchedule(rule));
+
+    // Saturday 22:00 to Sunday 04:00 through the week end and the one-day rule
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 11, 23, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 12, 4, 0, 0).unixtime(), eval.nextEnd.unixtime());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 12, 2, 0, 0).unixtime(), eval.nextScheduleEnd.unixtime());
+
+    // A week later the rule is over and the run stops at 3:00
+    auto later = controller.evaluateAt(DateTime(2025, 1, 18, 23, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 19, 3, 0, 0).unixtime(), later.nextEnd.unixtime());
+}
+
+void test_coverage_round_the_clock_has_no_end(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 0, 0, 12, 0, "Day")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 12, 0, 0, 0, "Night")));
+
+    auto eval = controller.evaluateAt(DateTime(2025, 1, 8, 15, 0, 0));
+    TEST_ASSERT_TRUE(eval.isOn());
+    TEST_ASSERT_FALSE(eval.nextEnd.isValid());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 9, 0, 0, 0).unixtime(), eval.nextScheduleEnd.unixtime());
+}
+
+// ============================================================================
+// Recurrence Rules
+// ============================================================================
+
+static DS3231Controller::Schedule makeRule(DS3231Controller::Recurrence recurrence, uint8_t interval,
+                                           uint8_t startHour, uint8_t endHour, const char* name) {
+    DS3231Controller::Schedule sched = makeSchedule(0, startHour, 0, endHour, 0, name);
+    sched.recurrence = recurrence;
+    sched.interval = interval;
+    return sched;
+}
+
+void test_rule_monthly_clamps_to_month_end(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeRule(DS3231Controller::Recurrence::Monthly, 31, 2, 4, "Legionella")));
+
+    // February has no 31st: the window runs on the 28th
+    auto feb = controller.evaluateAt(DateTime(2025, 2, 1, 12, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 2, 28, 2, 0, 0).unixtime(), feb.nextStart.unixtime());
+    TEST_ASSERT_TRUE(controller.evaluateAt(DateTime(2025, 2, 28, 3, 0, 0)).isOn());
+    TEST_ASSERT_FALSE(controller.evaluateAt(DateTime(2025, 2, 27, 3, 0, 0)).isOn());
+
+    auto afterMarch = controller.evaluateAt(DateTime(2025, 3, 31, 5, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 4, 30, 2, 0, 0).unixtime(), afterMarch.nextStart.unixtime());
+}
+
+void test_rule_every_n_days_and_date_range(void) {
+    DS3231Controller controller;
+    DS3231Controller::Schedule sched = makeRule(DS3231Controller::Recurrence::EveryNDays, 3, 23, 1, "Flush");
+    sched.setDateRange(DateTime(2025, 1, 1, 0, 0, 0), DateTime(2025, 1, 7, 0, 0, 0));
+    TEST_ASSERT_TRUE(controller.addSchedule(sched));
+
+    // Runs on the 1st, 4th and 7th; the 7th's window spills past the range into the 8th
+    TEST_ASSERT_TRUE(controller.evaluateAt(DateTime(2025, 1, 5, 0, 30, 0)).isOn());
+    TEST_ASSERT_FALSE(controller.evaluateAt(DateTime(2025, 1, 5, 23, 30, 0)).isOn());
+    auto last = controller.evaluateAt(DateTime(2025, 1, 8, 0, 30, 0));
+    TEST_ASSERT_TRUE(last.isOn());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 8, 1, 0, 0).unixtime(), last.nextEnd.unixtime());
+    TEST_ASSERT_FALSE(last.nextStart.isValid());
+
+    auto next = controller.evaluateAt(DateTime(2025, 1, 2, 12, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 4, 23, 0, 0).unixtime(), next.nextStart.unixtime());
+}
+
+void test_rule_once_far_ahead_and_weekly_mix(void) {
+    DS3231Controller controller;
+    DS3231Controller::Schedule once = makeRule(DS3231Controller::Recurrence::Once, 0, 10, 12, "Service");
+    once.firstDay = DS3231Controller::dayNumber(DateTime(2025, 9, 15, 0, 0, 0));
+    TEST_ASSERT_TRUE(controller.addSchedule(once));
+
+    // Months beyond the lookahead: the walk skips to the rule's first day
+    auto far = controller.evaluateAt(DateTime(2025, 1, 6, 12, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 9, 15, 10, 0, 0).unixtime(), far.nextStart.unixtime());
+
+    // A weekly schedule still comes first, from the same table
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00000010, 6, 0, 7, 0, "Monday")));
+    auto soon = controller.evaluateAt(DateTime(2025, 1, 6, 12, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 13, 6, 0, 0).unixtime(), soon.nextStart.unixtime());
+    TEST_ASSERT_TRUE(controller.evaluateAt(DateTime(2025, 9, 15, 11, 0, 0)).isOn());
+    TEST_ASSERT_FALSE(controller.evaluateAt(DateTime(2025, 9, 22, 11, 0, 0)).isOn());
+}
+
+void test_rule_schedules_roundtrip_as_v3(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 7, 0, "Daily")));
+    uint8_t weeklyOnly[DS3231Controller::MAX_SCHEDULE_DATA_SIZE];
+    size_t weeklySize = controller.getScheduleDataSize();
+    TEST_ASSERT_TRUE(controller.serializeSchedules(weeklyOnly, sizeof(weeklyOnly)));
+    TEST_ASSERT_EQUAL_UINT8(2, weeklyOnly[2]);  // Plain weekly blobs stay v2
+
+    DS3231Controller::Schedule sched = makeRule(DS3231Controller::Recurrence::EveryNDays, 10, 8, 9, "Rinse");
+    sched.setDateRange(DateTime(2025, 3, 1, 0, 0, 0));
+    TEST_ASSERT_TRUE(controller.addSchedule(sched));
+    uint8_t buffer[DS3231Controller::MAX_SCHEDULE_DATA_SIZE];
+    size_t size = controller.getScheduleDataSize();
+    TEST_ASSERT_EQUAL(weeklySize + 6 + 5 + 6, size);  // Fixed part, name, rule
+    TEST_ASSERT_TRUE(controller.serializeSchedules(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_UINT8(3, buffer[2]);
+
+    DS3231Controller restored;
+    TEST_ASSERT_TRUE(restored.deserializeSchedules(buffer, size));
+    const DS3231Controller::Schedule& rule = restored.getAllSchedules()[1];
+    TEST_ASSERT_EQUAL(static_cast<int>(DS3231Controller::Recurrence::EveryNDays), static_cast<int>(rule.recurrence));
+    TEST_ASSERT_EQUAL_UINT8(10, rule.interval);
+    TEST_ASSERT_EQUAL_UINT16(DS3231Controller::dayNumber(DateTime(2025, 3, 1, 0, 0, 0)), rule.firstDay);
+    TEST_ASSERT_EQUAL_UINT16(DS3231Controller::NO_END_DAY, rule.lastDay);
+    TEST_ASSERT_TRUE(restored.evaluateAt(DateTime(2025, 3, 11, 8, 30, 0)).isOn());
+}
+
+// ============================================================================
+// What-if Simulation
+// ============================================================================
+
+// Keeps the first events of a simulation
+struct SimulationLog {
+    static constexpr size_t CAPACITY = 64;
+    DS3231Controller::SimulationEvent events[CAPACITY];
+    size_t count = 0;
+
+    DS3231Controller::SimulationSink sink() {
+        return [this](const DS3231Controller::SimulationEvent& event) {
+            if (count < CAPACITY) {
+                events[count] = event;
+            }
+            count++;
+        };
+    }
+};
+
+void test_simulate_week_merges_on_time(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 6, 0, 8, 0, "Weekday")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 7, 30, 9, 0, "Daily")));
+
+    // Mon-Fri 6:00-9:00 merged, Sat and Sun 7:30-9:00
+    SimulationLog log;
+    auto result = controller.simulate(DateTime(2025, 1, 6, 0, 0, 0), DateTime(2025, 1, 13, 0, 0, 0), log.sink());
+    TEST_ASSERT_EQUAL_UINT32(12, result.scheduleStarts);
+    TEST_ASSERT_EQUAL_UINT32(7, result.heatingPeriods);
+    TEST_ASSERT_EQUAL_UINT32(5 * 180 + 2 * 90, result.onMinutes);
+    TEST_ASSERT_EQUAL_UINT32(38, result.events);
+
+    // Monday: start, on, start, end (the overlap keeps heating on), end, off
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::SimulationEventType::ScheduleStart),
+                            static_cast<uint8_t>(log.events[0].type));
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::SimulationEventType::HeatingOn),
+                            static_cast<uint8_t>(log.events[1].type));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 6, 0, 0).unixtime(), log.events[1].time);
+    TEST_ASSERT_EQUAL_UINT8(2, log.events[2].scheduleId);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::SimulationEventType::HeatingOff),
+                            static_cast<uint8_t>(log.events[5].type));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 9, 0, 0).unixtime(), log.events[5].time);
+}
+
+void test_simulate_vacation_and_pump_exercise(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 22, 0, 2, 0, "Night")));
+    controller.setVacationMode(true, DateTime(2025, 3, 3, 0, 0, 0), DateTime(2025, 3, 4, 23, 59, 59));
+    controller.setPumpExercise(true, 4, 3, 0);
+
+    // Already running at 'from'; the vacation suspends the 3/2 night and resumes the 3/4 one
+    SimulationLog log;
+    DateTime from(2025, 3, 1, 1, 0, 0);
+    auto week = controller.simulate(from, DateTime(2025, 3, 8, 1, 0, 0), log.sink());
+    TEST_ASSERT_EQUAL_UINT32(from.unixtime(), log.events[0].time);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::SimulationEventType::ScheduleStart),
+                            static_cast<uint8_t>(log.events[0].type));
+    TEST_ASSERT_EQUAL_UINT32(60 + 240 + 120 + 120 + 2 * 240 + 180, week.onMinutes);
+    TEST_ASSERT_EQUAL_UINT32(0, week.pumpRuns);  // The 4th falls in the vacation
+
+    // A year: every month but March; no sink needed for the totals
+    auto year = controller.simulate(DateTime(2025, 3, 1, 0, 0, 0), DateTime(2026, 3, 1, 0, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(11, year.pumpRuns);
+    TEST_ASSERT_EQUAL_UINT32(1 + 365 - 1, year.heatingPeriods);  // Running at 'from', 365 nights, one in the vacation
+}
+
+void test_simulate_agrees_with_queries(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01000001, 8, 0, 12, 0, "Weekend")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00100000, 23, 30, 0, 30, "Friday late")));
+    DS3231Controller::Schedule rule = makeRule(DS3231Controller::Recurrence::EveryNDays, 3, 11, 13, "Every third");
+    rule.setDateRange(DateTime(2025, 1, 2, 0, 0, 0));
+    TEST_ASSERT_TRUE(controller.addSchedule(rule));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeRule(DS3231Controller::Recurrence::Monthly, 31, 2, 4, "Legionella")));
+
+    // Every heating edge of a year matches the coverage queries on both sides
+    DateTime from(2025, 1, 1, 0, 0, 0);
+    uint32_t checked = 0;
+    uint32_t mismatches = 0;
+    auto result = controller.simulate(from, DateTime(2026, 1, 1, 0, 0, 0),
+                                      [&](const DS3231Controller::SimulationEvent& event) {
+        bool on = event.type == DS3231Controller::SimulationEventType::HeatingOn;
+        if (!on && event.type != DS3231Controller::SimulationEventType::HeatingOff) {
+            return;
+        }
+        checked++;
+        mismatches += controller.isWithinAnySchedule(DateTime(event.time)) != on;
+        mismatches += controller.isWithinAnySchedule(DateTime(event.time - 60)) == on;
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_EQUAL_UINT32(result.heatingPeriods * 2, checked);
+    TEST_ASSERT_TRUE(result.heatingPeriods > 100);
+}
+
+// ============================================================================
+// Schedule Storage
+// ============================================================================
+
+void test_schedule_capacity_enforced(void) {
+    DS3231Controller controller;
+    for (uint8_t i = 0; i < DS3231Controller::MAX_SCHEDULES; i++) {
+        TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 7, 0, "Slot")));
+    }
+    TEST_ASSERT_FALSE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 7, 0, "Overflow")));
+    TEST_ASSERT_EQUAL(DS3231Controller::MAX_SCHEDULES, controller.getAllSchedules().size());
+}
+
+void test_schedule_name_roundtrip_truncates(void) {
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.addSchedule(
+        makeSchedule(0b00111110, 6, 0, 7, 0, "A schedule name well over thirty-one characters")));
+
+    uint8_t buffer[256];
+    TEST_ASSERT_TRUE(sizeof(buffer) >= source.getScheduleDataSize());
+    TEST_ASSERT_TRUE(source.serializeSchedules(buffer, sizeof(buffer)));
+
+    DS3231Controller restored;
+    TEST_ASSERT_TRUE(restored.deserializeSchedules(buffer, source.getScheduleDataSize()));
+    TEST_ASSERT_EQUAL(1, restored.getAllSchedules().size());
+    TEST_ASSERT_EQUAL(31, restored.getAllSchedules()[0].name.length());
+    TEST_ASSERT_EQUAL_STRING("A schedule name well over thirt", restored.getAllSchedules()[0].name.c_str());
+}
+
+void test_serialize_v2_compact_with_crc(void) {
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b00111110, 22, 30, 6, 15, "Night")));
+    source.setVacationMode(true, DateTime(2025, 7, 1, 0, 0, 0), DateTime(2025, 7, 14, 0, 0, 0));
+    source.setPumpExercise(true, 15, 4, 30, 120);
+
+    uint8_t buffer[DS3231Controller::MAX_SCHEDULE_DATA_SIZE];
+    size_t size = source.getScheduleDataSize();
+    TEST_ASSERT_EQUAL(5 + 6 + 5 + 9 + 10 + 2, size);
+    TEST_ASSERT_TRUE(source.serializeSchedules(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(2, buffer[2]);
+
+    DS3231Controller restored;
+    TEST_ASSERT_TRUE(restored.deserializeSchedules(buffer, size));
+    const auto& sched = restored.getAllSchedules()[0];
+    TEST_ASSERT_EQUAL(0b00111110, sched.dayMask);
+    TEST_ASSERT_EQUAL(22, sched.startHour);
+    TEST_ASSERT_EQUAL(15, sched.endMinute);
+    TEST_ASSERT_TRUE(restored.getVacationMode().enabled);
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 14, 0, 0, 0).unixtime(), restored.getVacationMode().endDate.unixtime());
+    TEST_ASSERT_EQUAL(120, restored.getPumpExercise().durationSeconds);
+
+    // Any flipped bit is rejected and leaves the target untouched
+    buffer[8] ^= 0x04;
+    TEST_ASSERT_FALSE(restored.deserializeSchedules(buffer, size));
+    TEST_ASSERT_EQUAL(22, restored.getAllSchedules()[0].startHour);
+}
+
+void test_deserialize_v1_buffer(void) {
+    DS3231Controller controller;
+    uint8_t buffer[4 + 39];
+    memset(buffer, 0, sizeof(buffer));
+    const uint8_t header[] = {0xD3, 0x23, 1, 1, 7, 0b01000001, 8, 0, 12, 30, 1};
+    memcpy(buffer, header, sizeof(header));
+    memcpy(&buffer[11], "Weekend", 7);
+
+    TEST_ASSERT_TRUE(controller.deserializeSchedules(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(1, controller.getAllSchedules().size());
+    TEST_ASSERT_EQUAL(7, controller.getAllSchedules()[0].id);
+    TEST_ASSERT_EQUAL_STRING("Weekend", controller.getAllSchedules()[0].name.c_str());
+    TEST_ASSERT_TRUE(controller.evaluateAt(DateTime(2025, 1, 4, 9, 0, 0)).isOn());  // Saturday
+
+    TEST_ASSERT_FALSE(controller.deserializeSchedules(buffer, sizeof(buffer) - 1));
+}
+
+void test_deserialize_v1_buffer_small_names(void) {
+    // v1 name slots are 32 bytes whatever the reader's NameSize
+    using SmallNames = DS3231ControllerT<4, 16>;
+    SmallNames controller;
+    uint8_t buffer[4 + 2 * 39 + sizeof(SmallNames::VacationMode)];
+    memset(buffer, 0, sizeof(buffer));
+    const uint8_t header[] = {0xD3, 0x23, 1, 2};
+    memcpy(buffer, header, sizeof(header));
+    const uint8_t first[] = {3, 0b00111110, 6, 0, 7, 0, 1};
+    memcpy(&buffer[4], first, sizeof(first));
+    memcpy(&buffer[11], "Weekday morning heating", 23);
+    const uint8_t second[] = {9, 0b01000001, 8, 0, 12, 30, 1};
+    memcpy(&buffer[43], second, sizeof(second));
+    memcpy(&buffer[50], "Weekend", 7);
+
+    SmallNames::VacationMode vacation = {};
+    vacation.enabled = true;
+    vacation.startDate = DateTime(2025, 7, 1, 0, 0, 0);
+    vacation.endDate = DateTime(2025, 7, 14, 0, 0, 0);
+    memcpy(&buffer[82], &vacation, sizeof(vacation));
+
+    TEST_ASSERT_TRUE(controller.deserializeSchedules(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(2, controller.getAllSchedules().size());
+    TEST_ASSERT_EQUAL_STRING("Weekday morning", controller.getAllSchedules()[0].name.c_str());
+    TEST_ASSERT_EQUAL(9, controller.getAllSchedules()[1].id);
+    TEST_ASSERT_EQUAL(30, controller.getAllSchedules()[1].endMinute);
+    TEST_ASSERT_EQUAL_STRING("Weekend", controller.getAllSchedules()[1].name.c_str());
+    TEST_ASSERT_TRUE(controller.getVacationMode().enabled);
+    uint32_t endDate = controller.getVacationMode().endDate.unixtime();
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 14, 0, 0, 0).unixtime(), endDate);
+}
+
+void test_serialize_changes_delta(void) {
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01111111, 6, 0, 7, 0, "Morning")));
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01111111, 18, 0, 19, 0, "Evening")));
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01111111, 21, 0, 22, 0, "Late")));
+
+    uint8_t base[DS3231Controller::MAX_SCHEDULE_DATA_SIZE];
+    size_t baseSize = source.getScheduleDataSize();
+    TEST_ASSERT_TRUE(source.serializeSchedules(base, sizeof(base)));
+    TEST_ASSERT_FALSE(source.hasScheduleChanges());
+
+    uint8_t firstId = source.getAllSchedules()[0].id;
+    uint8_t lastId = source.getAllSchedules()[2].id;
+    TEST_ASSERT_TRUE(source.updateSchedule(firstId, makeSchedule(0b01111111, 5, 30, 7, 0, "Morning")));
+    TEST_ASSERT_TRUE(source.removeSchedule(lastId));
+    TEST_ASSERT_TRUE(source.hasScheduleChanges());
+
+    uint8_t delta[DS3231Controller::MAX_SCHEDULE_DELTA_SIZE];
+    size_t written = 0;
+    TEST_ASSERT_TRUE(source.serializeScheduleChanges(delta, sizeof(delta), written));
+    TEST_ASSERT_EQUAL(5 + 2 + 6 + 7 + 2, written);  // One removal, one edited record
+    TEST_ASSERT_FALSE(source.hasScheduleChanges());
+
+    DS3231Controller restored;
+    TEST_ASSERT_TRUE(restored.deserializeSchedules(base, baseSize));
+    TEST_ASSERT_TRUE(restored.deserializeSchedules(delta, written));
+    TEST_ASSERT_EQUAL(2, restored.getAllSchedules().size());
+    TEST_ASSERT_EQUAL(30, restored.getSchedule(firstId)->startMinute);
+    TEST_ASSERT_TRUE(restored.getSchedule(lastId) == nullptr);
+}
+
+// In-memory backend standing in for NVS or EEPROM
+class MemoryStore : public DS3231ScheduleStore {
+public:
+    bool load(uint8_t* buffer, size_t capacity, size_t& length) override {
+        length = _length;
+        if (_length == 0 || _length > capacity) return false;
+        memcpy(buffer, _data, _length);
+        return true;
+    }
+    bool save(const uint8_t* data, size_t length) override {
+        if (length > sizeof(_data)) return false;
+        memcpy(_data, data, length);
+        _length = length;
+        saves++;
+        return true;
+    }
+    int saves = 0;
+
+private:
+    uint8_t _data[512];
+    size_t _length = 0;
+};
+
+void test_store_commits_coalesced_and_restores(void) {
+    MemoryStore store;
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.attachStore(store));
+    TEST_ASSERT_FALSE(source.hasUnsavedChanges());
+
+    for (uint8_t hour = 6; hour < 10; hour++) {
+        TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01111111, hour, 0, hour, 30, "Slot")));
+    }
+    source.setVacationMode(false);
+    TEST_ASSERT_TRUE(source.hasUnsavedChanges());
+    TEST_ASSERT_TRUE(source.flushStore());
+    TEST_ASSERT_EQUAL(1, store.saves);
+    TEST_ASSERT_FALSE(source.hasUnsavedChanges());
+
+    // An edit that is undone before the commit writes nothing
+    uint8_t id = source.getAllSchedules()[0].id;
+    DS3231Controller::Schedule original = source.getAllSchedules()[0];
+    TEST_ASSERT_TRUE(source.updateSchedule(id, makeSchedule(0b01111111, 5, 0, 5, 30, "Slot")));
+    TEST_ASSERT_TRUE(source.updateSchedule(id, original));
+    TEST_ASSERT_TRUE(source.flushStore());
+    TEST_ASSERT_EQUAL(1, store.saves);
+
+    DS3231Controller restored;
+    TEST_ASSERT_TRUE(restored.attachStore(store));
+    TEST_ASSERT_TRUE(restored.restoreFromStore());
+    TEST_ASSERT_EQUAL(4, restored.getAllSchedules().size());
+    TEST_ASSERT_FALSE(restored.hasUnsavedChanges());
+}
+
+void test_eeprom_store_slot_geometry(void) {
+    DS3231EepromStore whole;
+    TEST_ASSERT_EQUAL(8, whole.getSlotCount());
+    TEST_ASSERT_TRUE(whole.getMaxBlobSize() >= DS3231Controller::MAX_SCHEDULE_DATA_SIZE);
+
+    DS3231EepromStore upperHalf(2048, 2048, 256);
+    TEST_ASSERT_EQUAL(8, upperHalf.getSlotCount());
+
+    // Slots must be page aligned; such a store refuses to start
+    DS3231EepromStore misaligned(0, 4096, 500);
+    TEST_ASSERT_EQUAL(0, misaligned.getSlotCount());
+    TEST_ASSERT_FALSE(misaligned.begin());
+}
+
+// ============================================================================
+// State Document
+// ============================================================================
+
+// Collects written bytes (NUL-terminated for text) and replays them as a Stream
+class BufferStream : public Stream {
+public:
+    size_t write(uint8_t c) override {
+        if (length >= sizeof(data) - 1) return 0;
+        data[length++] = c;
+        data[length] = 0;
+        return 1;
+    }
+    int available() override { return static_cast<int>(length - position); }
+    int read() override { return position < length ? data[position++] : -1; }
+    int peek() override { return position < length ? data[position] : -1; }
+    const char* text() const { return reinterpret_cast<const char*>(data); }
+
+    uint8_t data[1024] = {};
+    size_t length = 0;
+    size_t position = 0;
+};
+
+void test_state_json_roundtrip(void) {
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b00111110, 6, 0, 7, 30, "Morning \"early\"")));
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01000001, 18, 0, 19, 0, "Weekend")));
+    source.setVacationMode(true, DateTime(2025, 7, 1, 0, 0, 0), DateTime(2025, 7, 14, 0, 0, 0));
+    source.setPumpExercise(true, 15, 4, 30, 120);
+
+    BufferStream json;
+    size_t written = source.exportState(json);
+    TEST_ASSERT_EQUAL_UINT32(json.length, written);
+    TEST_ASSERT_NOT_NULL(strstr(json.text(), "{\"version\":1,\"time\":null,\"schedules\":[{\"id\":1,"
+                                             "\"name\":\"Morning \\\"early\\\"\",\"enabled\":true,\"days\":62,"
+                                             "\"start\":\"06:00\",\"end\":\"07:30\"},"));
+    TEST_ASSERT_NOT_NULL(strstr(json.text(), "\"start\":\"2025-07-01T00:00:00\""));
+    TEST_ASSERT_NOT_NULL(strstr(json.text(), "\"dayOfMonth\":15,\"hour\":4,\"minute\":30,\"durationSeconds\":120"));
+
+    DS3231Controller restored;
+    DS3231Controller::StateImportResult result = restored.importState(json);
+    TEST_ASSERT_TRUE(result.ok());
+    TEST_ASSERT_EQUAL(2, result.added);
+    TEST_ASSERT_EQUAL_UINT32(json.length, result.bytes);
+    TEST_ASSERT_EQUAL(2, restored.getAllSchedules().size());
+    const DS3231Controller::Schedule* morning = restored.getSchedule(1);
+    TEST_ASSERT_NOT_NULL(morning);
+    TEST_ASSERT_EQUAL_STRING("Morning \"early\"", morning->name.c_str());
+    TEST_ASSERT_EQUAL(0b00111110, morning->dayMask);
+    TEST_ASSERT_EQUAL(7, morning->endHour);
+    TEST_ASSERT_EQUAL(30, morning->endMinute);
+    TEST_ASSERT_TRUE(restored.getVacationMode().enabled);
+    TEST_ASSERT_EQUAL(14, restored.getVacationMode().endDate.day());
+    TEST_ASSERT_EQUAL(15, restored.getPumpExercise().dayOfMonth);
+    TEST_ASSERT_EQUAL(120, restored.getPumpExercise().durationSeconds);
+}
+
+void test_state_json_carries_rules(void) {
+    DS3231Controller source;
+    DS3231Controller::Schedule sched = makeRule(DS3231Controller::Recurrence::Monthly, 1, 5, 6, "Rent");
+    sched.setDateRange(DateTime(2025, 1, 1, 0, 0, 0), DateTime(2025, 12, 31, 0, 0, 0));
+    TEST_ASSERT_TRUE(source.addSchedule(sched));
+
+    BufferStream json;
+    source.exportState(json);
+    TEST_ASSERT_NOT_NULL(strstr(json.text(), "\"repeat\":\"monthly\",\"interval\":1,"
+                                             "\"from\":\"2025-01-01T00:00:00\",\"until\":\"2025-12-31T00:00:00\""));
+
+    DS3231Controller restored;
+    DS3231Controller::StateImportResult result = restored.importState(json);
+    TEST_ASSERT_TRUE(result.ok());
+    const DS3231Controller::Schedule* rent = restored.getSchedule(1);
+    TEST_ASSERT_NOT_NULL(rent);
+    TEST_ASSERT_EQUAL(static_cast<int>(DS3231Controller::Recurrence::Monthly), static_cast<int>(rent->recurrence));
+    TEST_ASSERT_EQUAL_UINT16(sched.firstDay, rent->firstDay);
+    TEST_ASSERT_EQUAL_UINT16(sched.lastDay, rent->lastDay);
+    TEST_ASSERT_TRUE(restored.evaluateAt(DateTime(2025, 8, 1, 5, 30, 0)).isOn());
+    TEST_ASSERT_FALSE(restored.evaluateAt(DateTime(2026, 1, 1, 5, 30, 0)).isOn());
+}
+
+void test_state_cbor_roundtrip_byte_by_byte(void) {
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01111111, 22, 15, 1, 0, "Night")));
+    source.setPumpExercise(false, 2, 3, 0, 60);
+
+    BufferStream cbor;
+    size_t written = source.exportState(cbor, DS3231Controller::StateFormat::Cbor);
+    TEST_ASSERT_EQUAL_UINT32(cbor.length, written);
+    TEST_ASSERT_EQUAL_HEX8(0xA6, cbor.data[0]);  // Map of six entries
+
+    DS3231Controller restored;
+    DS3231Controller::StateImporter importer(restored, DS3231Controller::StateFormat::Cbor);
+    for (size_t i = 0; i < written; i++) {
+        TEST_ASSERT_TRUE(importer.feed(&cbor.data[i], 1));
+    }
+    TEST_ASSERT_TRUE(importer.done());
+    DS3231Controller::StateImportResult result = importer.finish();
+    TEST_ASSERT_TRUE(result.ok());
+    TEST_ASSERT_EQUAL(1, result.added);
+
+    const DS3231Controller::Schedule* night = restored.getSchedule(1);
+    TEST_ASSERT_NOT_NULL(night);
+    TEST_ASSERT_EQUAL_STRING("Night", night->name.c_str());
+    TEST_ASSERT_EQUAL(22, night->startHour);
+    TEST_ASSERT_EQUAL(15, night->startMinute);
+    TEST_ASSERT_EQUAL(1, night->endHour);
+    TEST_ASSERT_FALSE(restored.getPumpExercise().enabled);
+    TEST_ASSERT_EQUAL(2, restored.getPumpExercise().dayOfMonth);
+}
+
+void test_state_import_merges_skips_and_rejects(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 6, 0, 7, 0, "Morning")));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 18, 0, 19, 0, "Evening")));
+
+    DS3231Controller::StateImporter importer(controller, DS3231Controller::StateFormat::Json, true);
+    TEST_ASSERT_TRUE(importer.feed("{\"schedules\": [ {\"id\": 1, \"enabled\": false},\n"
+                                   "  {\"start\": \"25:00\", \"end\": \"07:00\"},\n"
+                                   "  {\"id\": 9, \"start\": 360, \"end\": \"7:15\", \"extra\": {\"x\": [1, 2.5e0]}} ],\n"
+                                   " \"unknown\": [true, null, {\"a\": \"\\u00e9\"}]"));
+    TEST_ASSERT_EQUAL(2, controller.getAllSchedules().size() - 1);  // Applied as records complete
+    TEST_ASSERT_TRUE(importer.feed("}"));
+    DS3231Controller::StateImportResult result = importer.finish();
+
+    TEST_ASSERT_EQUAL(DS3231Controller::StateImportError::None, result.error);
+    TEST_ASSERT_FALSE(result.ok());
+    TEST_ASSERT_EQUAL(1, result.updated);
+    TEST_ASSERT_EQUAL(1, result.added);
+    TEST_ASSERT_EQUAL(1, result.rejected);
+    TEST_ASSERT_EQUAL(1, result.removed);  // "Evening" was not listed
+    TEST_ASSERT_EQUAL(2, controller.getAllSchedules().size());
+
+    const DS3231Controller::Schedule* morning = controller.getSchedule(1);
+    TEST_ASSERT_NOT_NULL(morning);
+    TEST_ASSERT_FALSE(morning->enabled);
+    TEST_ASSERT_EQUAL_STRING("Morning", morning->name.c_str());  // Unlisted fields kept
+    const DS3231Controller::Schedule* added = controller.getSchedule(9);
+    TEST_ASSERT_NOT_NULL(added);
+    TEST_ASSERT_EQUAL(6, added->startHour);
+    TEST_ASSERT_EQUAL(15, added->endMinute);
+    TEST_ASSERT_EQUAL(0b01111111, added->dayMask);
+}
+
+void test_state_import_publishes_pump_fields(void) {
+    DS3231Controller controller;
+    controller.setPumpExercise(true, 15, 4, 30);
+    controller.setVacationMode(true, DateTime(2025, 6, 10, 0, 0, 0), DateTime(2025, 6, 20, 23, 59, 59));
+    DateTime pumpTime(2025, 6, 15, 4, 30, 0);
+    TEST_ASSERT_FALSE(controller.evaluateAt(pumpTime).pumpExerciseDue);  // Held off by the vacation
+
+    // Fields without a setter take effect at once, not at the next mutation
+    DS3231Controller::StateImporter vacation(controller, DS3231Controller::StateFormat::Json);
+    TEST_ASSERT_TRUE(vacation.feed("{\"vacation\":{\"runPumpExercise\":true}}"));
+    TEST_ASSERT_TRUE(vacation.finish().ok());
+    TEST_ASSERT_TRUE(controller.evaluateAt(pumpTime).pumpExerciseDue);
+
+    DS3231Controller::StateImporter pump(controller, DS3231Controller::StateFormat::Json);
+    TEST_ASSERT_TRUE(pump.feed("{\"pumpExercise\":{\"lastRun\":\"2025-06-15T04:30:00\"}}"));
+    TEST_ASSERT_TRUE(pump.finish().ok());
+    TEST_ASSERT_FALSE(controller.evaluateAt(pumpTime).pumpExerciseDue);  // Already ran this month
+}
+
+void test_state_import_incomplete_document_removes_nothing(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 6, 0, 7, 0, "Morning")));
+
+    DS3231Controller::StateImporter truncated(controller, DS3231Controller::StateFormat::Json, true);
+    TEST_ASSERT_TRUE(truncated.feed("{\"schedules\":[{\"id\":5,\"start\":\"08:00\",\"end\":\"09:00\"}"));
+    DS3231Controller::StateImportResult result = truncated.finish();
+    TEST_ASSERT_EQUAL(DS3231Controller::StateImportError::Incomplete, result.error);
+    TEST_ASSERT_EQUAL(1, result.added);
+    TEST_ASSERT_EQUAL(0, result.removed);
+    TEST_ASSERT_NOT_NULL(controller.getSchedule(1));
+
+    DS3231Controller::StateImporter malformed(controller, DS3231Controller::StateFormat::Json);
+    TEST_ASSERT_FALSE(malformed.feed("{\"schedules\":[1,]}"));
+    TEST_ASSERT_EQUAL(DS3231Controller::StateImportError::Syntax, malformed.finish().error);
+}
+
+// ============================================================================
+// Compile-time Capacity
+// ============================================================================
+
+using SmallController = DS3231ControllerT<2, 8>;
+
+void test_template_capacity_and_name_size(void) {
+    SmallController controller;
+    SmallController::Schedule sched;
+    sched.id = 0;
+    sched.dayMask = 0b01111111;
+    sched.startHour = 6;
+    sched.startMinute = 0;
+    sched.endHour = 7;
+    sched.endMinute = 0;
+    sched.enabled = true;
+    sched.name = "Morning shower";
+    sched.recurrence = SmallController::Recurrence::Monthly;  // Rule records are the largest
+    sched.interval = 6;
+
+    TEST_ASSERT_TRUE(controller.addSchedule(sched));
+    TEST_ASSERT_TRUE(controller.addSchedule(sched));
+    TEST_ASSERT_FALSE(controller.addSchedule(sched));
+
+    uint8_t buffer[SmallController::MAX_SCHEDULE_DATA_SIZE];
+    TEST_ASSERT_EQUAL(sizeof(buffer), controller.getScheduleDataSize());
+    TEST_ASSERT_TRUE(controller.serializeSchedules(buffer, sizeof(buffer)));
+
+    SmallController restored;
+    TEST_ASSERT_TRUE(restored.deserializeSchedules(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_STRING("Morning", restored.getAllSchedules()[1].name.c_str());
+    TEST_ASSERT_TRUE(restored.evaluateAt(DateTime(2025, 1, 6, 6, 30, 0)).isOn());
+}
+
+void test_template_default_alias(void) {
+    TEST_ASSERT_EQUAL(10, DS3231Controller::MAX_SCHEDULES);
+    // Header, 10 records of 6 bytes + 31 name bytes + 6 rule bytes, vacation, pump, CRC
+    TEST_ASSERT_EQUAL(5 + 10 * 43 + 9 + 10 + 2, DS3231Controller::MAX_SCHEDULE_DATA_SIZE);
+}
+
+// ============================================================================
+// Lock-free Read Path
+// ============================================================================
+
+struct LatchPayload {
+    uint32_t value;
+    uint32_t check;
+};
+
+void test_seq_latch_update_and_read(void) {
+    DS3231SeqLatch<LatchPayload> latch(LatchPayload{1, ~1u});
+    TEST_ASSERT_EQUAL_UINT32(1, latch.load().value);
+
+    latch.update([](LatchPayload& p) { p.value = 42; p.check = ~42u; });
+    LatchPayload p = latch.load();
+    TEST_ASSERT_EQUAL_UINT32(42, p.value);
+    TEST_ASSERT_EQUAL_UINT32(~42u, p.check);
+    TEST_ASSERT_EQUAL_UINT32(42, latch.stable().value);
+    TEST_ASSERT_EQUAL_UINT32(42, latch.read([](const LatchPayload& v) { return v.value; }));
+}
+
+void test_snapshot_queries_follow_mutations(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b01111111, 6, 0, 8, 0, "Morning")));
+    uint8_t id = controller.getAllSchedules()[0].id;
+    DateTime at(2025, 1, 6, 7, 0, 0);
+
+    TEST_ASSERT_TRUE(controller.isWithinSchedule(id, at));
+    auto eval = controller.evaluateAt(at);
+    TEST_ASSERT_EQUAL(id, eval.activeId);
+    TEST_ASSERT_NOT_NULL(eval.active);
+
+    // Disabling republishes the compiled state
+    DS3231Controller::Schedule disabled = controller.getAllSchedules()[0];
+    disabled.enabled = false;
+    TEST_ASSERT_TRUE(controller.updateSchedule(id, disabled));
+    TEST_ASSERT_FALSE(controller.isWithinSchedule(id, at));
+    TEST_ASSERT_EQUAL(0, controller.evaluateAt(at).activeId);
+
+    // Vacation range is part of the published state too
+    TEST_ASSERT_TRUE(controller.updateSchedule(id, makeSchedule(0b01111111, 6, 0, 8, 0, "Morning")));
+    controller.setVacationMode(true, DateTime(2025, 1, 6, 0, 0, 0), DateTime(2025, 1, 6, 23, 59, 59));
+    TEST_ASSERT_FALSE(controller.isWithinAnySchedule(at));
+    controller.setVacationMode(false);
+    TEST_ASSERT_TRUE(controller.isWithinAnySchedule(at));
+}
+
+// ============================================================================
+// Register Snapshot Decoding
+// ============================================================================
+
+void test_parse_registers_24h(void) {
+    uint8_t regs[DS3231Controller::DS3231_REGISTER_COUNT] = {0};
+    regs[0x00] = 0x45;  // 45 s
+    regs[0x01] = 0x59;  // 59 min
+    regs[0x02] = 0x23;  // 23 h
+    regs[0x04] = 0x31;  // 31st
+    regs[0x05] = 0x12;  // December
+    regs[0x06] = 0x25;  // 2025
+    regs[0x0E] = 0x1C;
+    regs[0x0F] = 0x83;  // OSF + both alarm flags
+    regs[0x10] = 0xFE;  // Aging -2
+    regs[0x11] = 0xF6;  // -10 °C
+    regs[0x12] = 0x40;  // +0.25
+
+    DS3231Controller::RegisterSnapshot snap;
+    TEST_ASSERT_TRUE(DS3231Controller::parseRegisters(regs, snap));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 12, 31, 23, 59, 45).unixtime(), snap.time.unixtime());
+    TEST_ASSERT_EQUAL_FLOAT(-9.75f, snap.temperatureC);
+    TEST_ASSERT_EQUAL_INT8(-2, snap.agingOffset);
+    TEST_ASSERT_TRUE(snap.oscillatorStopped());
+    TEST_ASSERT_TRUE(snap.alarmFired(1));
+    TEST_ASSERT_TRUE(snap.alarmFired(2));
+    TEST_ASSERT_FALSE(snap.alarmFired(3));
+}
+
+void test_parse_registers_12h_and_invalid(void) {
+    uint8_t regs[DS3231Controller::DS3231_REGISTER_COUNT] = {0};
+    regs[0x02] = 0x40 | 0x20 | 0x12;  // 12-hour mode, 12 PM
+    regs[0x04] = 0x01;
+    regs[0x05] = 0x81;  // January with century flag
+    regs[0x06] = 0x26;
+
+    DS3231Controller::RegisterSnapshot snap;
+    TEST_ASSERT_TRUE(DS3231Controller::parseRegisters(regs, snap));
+    TEST_ASSERT_EQUAL(12, snap.time.hour());
+    TEST_ASSERT_EQUAL(1, snap.time.month());
+
+    regs[0x05] = 0x13;  // Month 13
+    TEST_ASSERT_FALSE(DS3231Controller::parseRegisters(regs, snap));
+    TEST_ASSERT_FALSE(snap.valid);
+}
+
+// ============================================================================
+// Drift Estimation
+// ============================================================================
+
+void test_drift_estimate_prefers_reference_band(void) {
+    DS3231Controller::DriftBin bins[DS3231Controller::DRIFT_TEMP_BINS] = {};
+    TEST_ASSERT_FALSE(DS3231Controller::estimateDrift(bins).valid);
+    TEST_ASSERT_EQUAL(0, DS3231Controller::driftBinFor(-10.0f));
+    TEST_ASSERT_EQUAL(5, DS3231Controller::driftBinFor(25.0f));
+    TEST_ASSERT_EQUAL(DS3231Controller::DRIFT_TEMP_BINS - 1, DS3231Controller::driftBinFor(80.0f));
+
+    // Cold-only data is used while it is all there is
+    bins[0] = {-10, 5 * 86400, 5};
+    DS3231Controller::DriftEstimate cold = DS3231Controller::estimateDrift(bins);
+    TEST_ASSERT_TRUE(cold.valid);
+    TEST_ASSERT_FALSE(cold.referenceBand);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -23.15f, cold.ppm);
+
+    // A day of 15-35 °C data takes over
+    bins[DS3231Controller::driftBinFor(22.0f)] = {2, 2 * 86400, 2};
+    DS3231Controller::DriftEstimate band = DS3231Controller::estimateDrift(bins);
+    TEST_ASSERT_TRUE(band.referenceBand);
+    TEST_ASSERT_EQUAL(2, band.samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 11.57f, band.ppm);
+}
+
+void test_edge_capture_requires_begin(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_FALSE(controller.isSecondEdgeCaptureEnabled());
+    TEST_ASSERT_FALSE(controller.enableSecondEdgeCapture(4));
+    TEST_ASSERT_FALSE(controller.isSecondEdgeCaptureEnabled());
+    TEST_ASSERT_FALSE(controller.syncSystemTime());
+}
+
+// ============================================================================
+// Temperature History
+// ============================================================================
+
+void test_temperature_history_window_stats(void) {
+    DS3231TemperatureHistory<3> history;
+    TEST_ASSERT_TRUE(history.empty());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, history.meanCelsius());
+
+    const int16_t quarters[] = {80, 100, 88, 84, 120};  // 20.0, 25.0, 22.0, 21.0, 30.0 °C
+    for (uint32_t i = 0; i < 5; i++) {
+        history.push({1000 + i, quarters[i]});
+    }
+
+    // Only the last three remain; 25.0 °C was evicted from the max queue
+    TEST_ASSERT_EQUAL(3, history.size());
+    TEST_ASSERT_EQUAL(1002, history[0].epoch);
+    TEST_ASSERT_EQUAL(1004, history.newest().epoch);
+    TEST_ASSERT_EQUAL_FLOAT(21.0f, history.minCelsius());
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, history.maxCelsius());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 73.0f / 3, history.meanCelsius());
+
+    // The two in-place spans cover the window oldest first
+    TEST_ASSERT_EQUAL(1, history.firstPartSize());
+    TEST_ASSERT_EQUAL(2, history.secondPartSize());
+    TEST_ASSERT_EQUAL(1002, history.firstPart()[0].epoch);
+    TEST_ASSERT_EQUAL(1003, history.secondPart()[0].epoch);
+}
+
+void test_temperature_conversion_requires_begin(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_FALSE(controller.forceTemperatureConversion());
+    TEST_ASSERT_TRUE(controller.getTemperatureHistory().empty());
+}
+
+// ============================================================================
+// Time Zone Rules
+// ============================================================================
+
+void test_time_zone_parses_posix_rules(void) {
+    DS3231TimeZone tz;
+    TEST_ASSERT_FALSE(tz.hasDst());
+    TEST_ASSERT_EQUAL(0, tz.offsetAt(1750000000));
+    TEST_ASSERT_FALSE(tz.parse("X-1"));                 // Name too short
+    TEST_ASSERT_FALSE(tz.parse("CET-1CEST,M3.5.0"));    // End rule missing
+    TEST_ASSERT_TRUE(tz.parse("<+0330>-3:30"));
+    TEST_ASSERT_EQUAL(12600, tz.offsetAt(1750000000));
+
+    // Europe: DST from 2025-03-30 01:00 UTC to 2025-10-26 01:00 UTC
+    TEST_ASSERT_TRUE(tz.parse("CET-1CEST,M3.5.0,M10.5.0/3"));
+    TEST_ASSERT_TRUE(tz.hasDst());
+    uint32_t springUtc = DateTime(2025, 3, 30, 1, 0, 0).unixtime();
+    uint32_t fallUtc = DateTime(2025, 10, 26, 1, 0, 0).unixtime();
+    TEST_ASSERT_EQUAL(3600, tz.offsetAt(springUtc - 1));
+    TEST_ASSERT_EQUAL(7200, tz.offsetAt(springUtc));
+    TEST_ASSERT_EQUAL(springUtc, tz.nextTransitionAfter(springUtc - 3600));
+    TEST_ASSERT_EQUAL(fallUtc, tz.nextTransitionAfter(springUtc));
+    TEST_ASSERT_EQUAL_STRING("CEST", tz.abbreviationAt(springUtc));
+
+    TEST_ASSERT_FALSE(tz.isCached(springUtc));
+    tz.refresh(springUtc - 3600);
+    TEST_ASSERT_TRUE(tz.isCached(fallUtc - 1));         // Current and next period
+    TEST_ASSERT_EQUAL(7200, tz.offsetAt(fallUtc - 1));
+
+    // Southern hemisphere DST spans the new year
+    TEST_ASSERT_TRUE(tz.parse("AEST-10AEDT,M10.1.0,M4.1.0/3"));
+    TEST_ASSERT_EQUAL(39600, tz.offsetAt(DateTime(2025, 1, 15, 0, 0, 0).unixtime()));
+    TEST_ASSERT_EQUAL(36000, tz.offsetAt(DateTime(2025, 7, 15, 0, 0, 0).unixtime()));
+}
+
+void test_time_zone_resolves_skipped_and_repeated_hours(void) {
+    DS3231TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("CET-1CEST,M3.5.0,M10.5.0/3"));
+    uint32_t springUtc = DateTime(2025, 3, 30, 1, 0, 0).unixtime();
+    uint32_t fallUtc = DateTime(2025, 10, 26, 1, 0, 0).unixtime();
+
+    // 02:30 never happens on 2025-03-30: it maps to the transition
+    TEST_ASSERT_EQUAL(springUtc, tz.toUtc(DateTime(2025, 3, 30, 2, 30, 0).unixtime()));
+    TEST_ASSERT_EQUAL(springUtc + 1800, tz.toUtc(DateTime(2025, 3, 30, 3, 30, 0).unixtime()));
+
+    // 02:30 happens twice on 2025-10-26: the first (CEST) one wins
+    TEST_ASSERT_EQUAL(fallUtc - 1800, tz.toUtc(DateTime(2025, 10, 26, 2, 30, 0).unixtime()));
+
+    // The schedule clock holds at 02:59:59 through the repeated hour
+    uint32_t heldLocal = DateTime(2025, 10, 26, 2, 59, 59).unixtime();
+    TEST_ASSERT_EQUAL(DateTime(2025, 10, 26, 2, 30, 0).unixtime(), tz.toScheduleTime(fallUtc - 1800));
+    TEST_ASSERT_EQUAL(heldLocal, tz.toScheduleTime(fallUtc));
+    TEST_ASSERT_EQUAL(heldLocal, tz.toScheduleTime(fallUtc + 3599));
+    TEST_ASSERT_EQUAL(heldLocal + 1, tz.toScheduleTime(fallUtc + 3600));
+    TEST_ASSERT_EQUAL(DateTime(2025, 10, 26, 2, 30, 0).unixtime(), tz.toLocal(fallUtc + 1800));
+}
+
+void test_time_zone_requires_valid_rules(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_FALSE(controller.hasTimeZone());
+    TEST_ASSERT_FALSE(controller.setTimeZone("CET-1CEST,M13.5.0,M10.5.0"));
+    TEST_ASSERT_FALSE(controller.hasTimeZone());
+    TEST_ASSERT_TRUE(controller.setTimeZone("CET-1CEST,M3.5.0,M10.5.0/3"));
+    TEST_ASSERT_TRUE(controller.hasTimeZone());
+    TEST_ASSERT_EQUAL(3600, controller.getTimeZone().standardOffset());
+    TEST_ASSERT_TRUE(controller.setTimeZone(nullptr));
+    TEST_ASSERT_FALSE(controller.hasTimeZone());
+}
+
+// ============================================================================
+// Async Bus Requests
+// ============================================================================
+
+void test_async_requests_need_worker(void) {
+    DS3231Controller controller;
+    TEST_ASSERT_FALSE(controller.isBusWorkerRunning());
+
+    DS3231Controller::AsyncHandle handle;
+    DateTime cached = controller.nowAsync(nullptr, &handle);
+    TEST_ASSERT_FALSE(cached.isValid());  // Never anchored
+    TEST_ASSERT_FALSE(handle.isValid());
+    TEST_ASSERT_EQUAL(DS3231Controller::AsyncStatus::Invalid, controller.getAsyncStatus(handle));
+
+    auto job = controller.submitBusJob([](TwoWire&) { return true; });
+    TEST_ASSERT_FALSE(job.isValid());
+}
+
+// ============================================================================
+// Host Backend (native env: mock DS3231 and AT24C32 on the host I2C bus)
+// ============================================================================
+
+#ifdef DS3231_NATIVE
+void test_native_time_follows_mock_rtc(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_FALSE(rtc.peek(0x0F) & 0x80);  // Power loss handled: OSF cleared
+
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 12, 0, 0)));
+    DS3231Host::advanceMs(90500);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 10, 12, 1, 30).unixtime(), controller.now().unixtime());
+
+    // 20 ppm fast gains 1.728 s a day
+    rtc.setDriftPpm(20.0);
+    DS3231Host::advanceUs(86400LL * 1000000);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 11, 12, 1, 32).unixtime(), controller.now().unixtime());
+}
+
+void test_native_schedule_engine_against_mock_clock(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 7, 15, 0));  // Monday
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 6, 0, 8, 0, "Morning")));
+
+    TEST_ASSERT_TRUE(controller.isWithinAnySchedule());
+    TEST_ASSERT_EQUAL_UINT32(45 * 60, controller.getSecondsUntilNextEvent());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 8, 0, 0).unixtime(),
+                             controller.getNextScheduledEnd().unixtime());
+
+    DS3231Host::advanceMs(45 * 60 * 1000UL);
+    TEST_ASSERT_FALSE(controller.isWithinAnySchedule());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 7, 6, 0, 0).unixtime(),
+                             controller.getNextScheduledStart().unixtime());
+
+    // Alarm 1 raises its flag and pulls INT/SQW low once the clock gets there
+    rtc.connectInterrupt(4);
+    controller.clearAlarm(1);
+    TEST_ASSERT_TRUE(controller.setAlarmForNextSchedule());
+    DS3231Host::advanceUs((22LL * 3600 - 1) * 1000000);
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(4));
+    DS3231Host::advanceMs(1000);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(4));
+    TEST_ASSERT_TRUE(controller.isAlarmFired(1));
+    controller.acknowledgeAlarm(1);
+    DS3231Host::dispatch();
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(4));
+}
+
+void test_native_alarm_for_far_edge_arms_waypoint(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 12, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    DS3231Controller::Schedule once = makeRule(DS3231Controller::Recurrence::Once, 0, 10, 12, "Service");
+    once.firstDay = DS3231Controller::dayNumber(DateTime(2025, 9, 15, 0, 0, 0));
+    TEST_ASSERT_TRUE(controller.addSchedule(once));
+
+    // Alarm 1 would match 10:00 on the 15th of January already; arm 27 days out
+    TEST_ASSERT_TRUE(controller.setAlarmForNextSchedule());
+    TEST_ASSERT_EQUAL_HEX8(0x02, rtc.peek(0x0A) & 0x3F);  // Date 2 (BCD)
+    TEST_ASSERT_EQUAL_HEX8(0x12, rtc.peek(0x09) & 0x3F);  // 12 h (BCD)
+    DS3231Host::advanceUs(10LL * 86400 * 1000000);
+    TEST_ASSERT_FALSE(controller.isAlarmFired(1));
+}
+
+void test_native_store_debounce_commits_to_eeprom(void) {
+    DS3231Mock rtc;
+    DS3231MockEeprom eeprom;
+    rtc.attach();
+    eeprom.attach();
+    DS3231Controller source;
+    TEST_ASSERT_TRUE(source.begin(&Wire));
+    DS3231EepromStore store;
+    TEST_ASSERT_TRUE(store.begin(&Wire, source.getBusMutex()));
+    TEST_ASSERT_TRUE(source.attachStore(store, 500));
+
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01111111, 6, 0, 7, 0, "Morning")));
+    TEST_ASSERT_TRUE(source.addSchedule(makeSchedule(0b01000001, 9, 30, 11, 0, "Weekend")));
+    DS3231Host::advanceMs(499);
+    TEST_ASSERT_TRUE(source.hasUnsavedChanges());
+    DS3231Host::advanceMs(1);  // Debounce timer fires and writes the slot
+    TEST_ASSERT_FALSE(source.hasUnsavedChanges());
+    TEST_ASSERT_GREATER_THAN(0, eeprom.pageWrites());
+
+    DS3231Controller restored;
+    TEST_ASSERT_TRUE(restored.begin(&Wire));
+    TEST_ASSERT_TRUE(restored.attachStore(store));
+    TEST_ASSERT_TRUE(restored.restoreFromStore());
+    TEST_ASSERT_EQUAL(2, restored.getAllSchedules().size());
+    TEST_ASSERT_EQUAL_UINT8(30, restored.getAllSchedules()[1].startMinute);
+    TEST_ASSERT_EQUAL_STRING("Weekend", restored.getAllSchedules()[1].name.c_str());
+}
+
+void test_native_time_zone_keeps_rtc_in_utc(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 3, 30, 0, 59, 58));  // UTC, two seconds before CET -> CEST
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.setTimeZone("CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 30, 1, 59, 58).unixtime(), controller.now().unixtime());
+    TEST_ASSERT_EQUAL_INT32(3600, controller.getUtcOffset());
+    DS3231Host::advanceMs(3000);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 30, 3, 0, 1).unixtime(), controller.now().unixtime());
+    TEST_ASSERT_EQUAL_INT32(7200, controller.getUtcOffset());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 30, 1, 0, 1).unixtime(), rtc.time().unixtime());
+}
+
+void test_native_temperature_timestamp_is_local(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));  // UTC
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.setTimeZone("CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    DS3231Controller::TemperatureData data = controller.getTemperature();
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 12, 0, 0).unixtime(), data.timestamp.unixtime());
+
+    // The history keeps the RTC's UTC epochs
+    TEST_ASSERT_FALSE(controller.getTemperatureHistory().empty());
+    uint32_t sampleEpoch = controller.getTemperatureHistory().newest().epoch;
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 10, 0, 0).unixtime(), sampleEpoch);
+}
+
+void test_native_bus_latency_and_cached_clock(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+
+    // 100 kHz: about 100 us of addressing per transaction and 90 us per byte
+    Wire.setLatency(100, 90);
+    Wire.resetCounters();
+    int64_t startUs = DS3231Host::nowUs();
+    TEST_ASSERT_TRUE(controller.now().isValid());
+    TEST_ASSERT_GREATER_THAN(0, Wire.transactions());
+    TEST_ASSERT_EQUAL(static_cast<int64_t>(Wire.transactions()) * 100 + Wire.bytesTransferred() * 90,
+                      DS3231Host::nowUs() - startUs);
+
+    // The cached clock answers from esp_timer between re-anchors
+    controller.enableCachedClock(true);
+    TEST_ASSERT_TRUE(controller.reanchorClock());
+    Wire.resetCounters();
+    DS3231Host::advanceMs(10000);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 10, 0, 10).unixtime(), controller.now().unixtime());
+    TEST_ASSERT_FALSE(controller.isWithinAnySchedule());
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.transactions());
+}
+
+void test_native_edge_capture_aligns_system_time(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.connectInterrupt(5);
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Host::advanceMs(300);
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.enableSecondEdgeCapture(5));
+
+    DS3231Host::advanceMs(1950);  // Falling edges at 10:00:01 and 10:00:02
+    TEST_ASSERT_TRUE(controller.syncSystemTime());
+    TEST_ASSERT_EQUAL(DateTime(2025, 6, 1, 10, 0, 2).unixtime(), DS3231Host::systemTime().tv_sec);
+    TEST_ASSERT_INT_WITHIN(2000, 250000, DS3231Host::systemTime().tv_usec);
+}
+
+void test_native_status_into_caller_buffers(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 5, 30, 0));  // Monday
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 6, 0, 7, 0, "Morning")));
+
+    char time[DS3231Controller::FORMATTED_TIME_SIZE];
+    char date[DS3231Controller::FORMATTED_DATE_SIZE];
+    char status[DS3231Controller::SCHEDULE_STATUS_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(8, controller.getFormattedTime(time, sizeof(time)));
+    TEST_ASSERT_EQUAL_STRING("05:30:00", time);
+    TEST_ASSERT_EQUAL_UINT32(10, controller.getFormattedDate(date, sizeof(date)));
+    TEST_ASSERT_EQUAL_STRING("2025-01-06", date);
+    controller.getScheduleStatus(status, sizeof(status));
+    TEST_ASSERT_EQUAL_STRING("Next: 06:00:00", status);
+
+    DS3231Host::advanceMs(45UL * 60 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(15, controller.getScheduleStatus(status, 8));  // "Active: Morning"
+    TEST_ASSERT_EQUAL_STRING("Active:", status);
+    TEST_ASSERT_EQUAL_STRING("Active: Morning", controller.getScheduleStatus().c_str());
+}
+
+void test_native_follower_shares_source_clock(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 7, 58, 0));  // Monday
+    DS3231Controller primary;
+    TEST_ASSERT_TRUE(primary.begin(&Wire));
+    DS3231ControllerT<4, 16> follower;
+    TEST_ASSERT_TRUE(follower.begin(primary));
+    TEST_ASSERT_TRUE(follower.isFollower());
+
+    // Separate schedule sets on one clock
+    TEST_ASSERT_TRUE(primary.addSchedule(makeSchedule(0b00111110, 7, 0, 8, 0, "Heating")));
+    DS3231ControllerT<4, 16>::Schedule pump;
+    pump.id = 0;
+    pump.dayMask = 0b00111110;
+    pump.startHour = 8;
+    pump.startMinute = 0;
+    pump.endHour = 9;
+    pump.endMinute = 0;
+    pump.enabled = true;
+    pump.name = "Pump";
+    TEST_ASSERT_TRUE(follower.addSchedule(pump));
+    TEST_ASSERT_TRUE(primary.isWithinAnySchedule());
+    TEST_ASSERT_FALSE(follower.isWithinAnySchedule());
+    TEST_ASSERT_EQUAL_UINT32(primary.now().unixtime(), follower.now().unixtime());
+
+    // With the source's cached clock, follower queries stay off the bus
+    primary.enableCachedClock(true);
+    TEST_ASSERT_TRUE(primary.reanchorClock());
+    Wire.resetCounters();
+    DS3231Host::advanceMs(3UL * 60 * 1000);
+    TEST_ASSERT_TRUE(follower.isWithinAnySchedule());
+    TEST_ASSERT_FALSE(primary.isWithinAnySchedule());
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.transactions());
+
+    // No RTC of its own
+    TEST_ASSERT_FALSE(follower.setAlarm1(DateTime(2025, 1, 6, 9, 0, 0)));
+    TEST_ASSERT_FALSE(follower.setTime(DateTime(2025, 1, 6, 9, 0, 0)));
+    TEST_ASSERT_FALSE(follower.attachSecondaryRtc(&Wire1));
+}
+
+void test_native_failover_to_secondary_rtc(void) {
+    DS3231Mock first;
+    DS3231Mock second;
+    first.attach(Wire);
+    second.attach(Wire1);
+    first.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    second.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.attachSecondaryRtc(&Wire1));
+    TEST_ASSERT_FALSE(controller.isOnSecondaryRtc());
+
+    first.detach();  // Primary stops answering
+    DateTime now = controller.now();
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 10, 0, 0).unixtime(), now.unixtime());
+    TEST_ASSERT_TRUE(controller.isOnSecondaryRtc());
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getRtcFailoverCount());
+    TEST_ASSERT_FALSE(controller.usePrimaryRtc());
+
+    // Time set while the primary is out is carried back to it
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 6, 1, 12, 0, 0)));
+    first.attach(Wire);
+    TEST_ASSERT_TRUE(controller.usePrimaryRtc());
+    TEST_ASSERT_FALSE(controller.isOnSecondaryRtc());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 12, 0, 0).unixtime(), first.time().unixtime());
+}
+
+void test_native_failover_moves_sqw_mode(void) {
+    DS3231Mock first;
+    DS3231Mock second;
+    first.attach(Wire);
+    second.attach(Wire1);
+    first.connectInterrupt(5);
+    first.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    second.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.attachSecondaryRtc(&Wire1));
+    TEST_ASSERT_TRUE(controller.enableSecondEdgeCapture(5));
+    TEST_ASSERT_EQUAL_HEX8(0, first.peek(0x0E) & 0x04);  // INTCN clear: 1 Hz out
+
+    first.detach();
+    TEST_ASSERT_TRUE(controller.now().isValid());
+    TEST_ASSERT_TRUE(controller.isOnSecondaryRtc());
+    TEST_ASSERT_EQUAL_HEX8(0, second.peek(0x0E) & 0x04);
+
+    // The primary comes back from a power loss with INTCN set again
+    first.poke(0x0E, 0x1C);
+    first.attach(Wire);
+    TEST_ASSERT_TRUE(controller.usePrimaryRtc());
+    TEST_ASSERT_EQUAL_HEX8(0, first.peek(0x0E) & 0x04);
+}
+
+void test_native_begin_skips_primary_that_lost_power(void) {
+    DS3231Mock first;  // Power-on state: OSF set
+    DS3231Mock second;
+    first.attach(Wire);
+    second.attach(Wire1);
+    second.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.attachSecondaryRtc(&Wire1));
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+
+    TEST_ASSERT_TRUE(controller.isOnSecondaryRtc());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 10, 0, 0).unixtime(), controller.now().unixtime());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 10, 0, 0).unixtime(), first.time().unixtime());
+}
+
+void test_native_boot_is_one_read_and_one_write(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    for (uint8_t reg = 0x07; reg <= 0x0A; reg++) {
+        rtc.poke(reg, 0x80);  // Alarm 1 once per second: fires while we are off
+    }
+    DS3231Host::advanceMs(1500);
+    Wire.resetCounters();
+
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    const DS3231Controller::BootReport& report = controller.getBootReport();
+    TEST_ASSERT_TRUE(report.alarmsCleared);
+    TEST_ASSERT_FALSE(report.lostPower);
+    TEST_ASSERT_FALSE(report.clockSet);
+    TEST_ASSERT_EQUAL_HEX8(0, rtc.peek(0x0F) & 0x01);
+    uint32_t transactions = Wire.transactions();
+    TEST_ASSERT_EQUAL_UINT32(4, transactions);  // Probe, pointer write, burst read, status write
+}
+
+void test_native_boot_policy_keeps_lost_time_and_wake_alarms(void) {
+    DS3231Mock rtc;  // Power-on state: OSF set
+    rtc.attach();
+    for (uint8_t reg = 0x07; reg <= 0x0A; reg++) {
+        rtc.poke(reg, 0x80);  // The alarm that woke us
+    }
+    DS3231Host::advanceMs(1500);
+    DS3231Host::setWakeupCause(ESP_SLEEP_WAKEUP_EXT0);  // No sleep cache: full begin()
+
+    DS3231Controller controller;
+    DS3231Controller::BootPolicy policy;
+    policy.onPowerLoss = DS3231Controller::PowerLossAction::KeepTime;
+    policy.keepAlarmsOnWake = true;
+    controller.setBootPolicy(policy);
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+
+    const DS3231Controller::BootReport& report = controller.getBootReport();
+    TEST_ASSERT_TRUE(report.lostPower);
+    TEST_ASSERT_FALSE(report.clockSet);
+    TEST_ASSERT_TRUE(report.alarmsKept);
+    TEST_ASSERT_EQUAL_HEX8(0x81, rtc.peek(0x0F) & 0x81);  // OSF and A1F untouched
+    TEST_ASSERT_EQUAL(2000, controller.now().year());
+
+    // NTP arrives: setting the time clears OSF
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 6, 1, 10, 0, 0)));
+    TEST_ASSERT_EQUAL_HEX8(0, rtc.peek(0x0F) & 0x80);
+}
+
+void test_native_boot_deferred_validation_only_probes(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    Wire.setLatency(25, 23);
+
+    DS3231Controller controller;
+    DS3231Controller::BootPolicy policy;
+    policy.deferValidation = true;
+    controller.setBootPolicy(policy);
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    uint32_t transactions = Wire.transactions();
+    TEST_ASSERT_EQUAL_UINT32(1, transactions);
+    TEST_ASSERT_TRUE(controller.getBootReport().validationDeferred);
+    TEST_ASSERT_EQUAL_UINT32(25, controller.getBootReport().durationUs);  // One bus probe, no data bytes
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 6, 1, 10, 0, 0).unixtime(), controller.now().unixtime());
+}
+
+void test_native_events_queue_until_dispatched(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.enableEventQueue(4));
+
+    // The callback may use the controller: it no longer runs under the mutex
+    uint32_t seen = 0;
+    uint8_t events = 0;
+    controller.onTimeChange([&](const DateTime&) { seen = controller.now().unixtime(); });
+    controller.onEvent([&](const DS3231Controller::Event&) { events++; });
+
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 12, 0, 0)));
+    controller.acknowledgeAlarm(2);
+    TEST_ASSERT_EQUAL_UINT32(0, seen);
+
+    uint8_t dispatched = controller.dispatchEvents();
+    TEST_ASSERT_EQUAL_UINT8(2, dispatched);
+    TEST_ASSERT_EQUAL_UINT8(2, events);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 10, 12, 0, 0).unixtime(), seen);
+}
+
+void test_native_events_carry_type_and_payload(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+
+    // No queue: dispatched in place, after the lock is released
+    DS3231Controller::Event last = {};
+    controller.onEvent([&](const DS3231Controller::Event& event) { last = event; });
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 12, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::EventType::TimeChanged),
+                            static_cast<uint8_t>(last.type));
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 3, 10, 12, 0, 0).unixtime(), last.time);
+
+    controller.acknowledgeAlarm(1);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::EventType::AlarmFired),
+                            static_cast<uint8_t>(last.type));
+    TEST_ASSERT_EQUAL_UINT8(1, last.alarmNumber);
+}
+
+void test_native_full_event_queue_drops_and_counts(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.enableEventQueue(1));
+    TEST_ASSERT_FALSE(controller.startEventDispatcher());  // No tasks on the host; queue kept
+    TEST_ASSERT_TRUE(controller.isEventQueueEnabled());
+
+    uint8_t changes = 0;
+    controller.onTimeChange([&](const DateTime&) { changes++; });
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 12, 0, 0)));
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 13, 0, 0)));
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 14, 0, 0)));
+    uint32_t dropped = controller.getDroppedEventCount();
+    TEST_ASSERT_EQUAL_UINT32(1, dropped);  // One slot plus the stop reserve
+
+    // Stopping drains what was queued, then dispatches in place again
+    controller.stopEventDispatcher();
+    TEST_ASSERT_EQUAL_UINT8(2, changes);
+    TEST_ASSERT_FALSE(controller.isEventQueueEnabled());
+    TEST_ASSERT_TRUE(controller.setTime(DateTime(2025, 3, 10, 15, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT8(3, changes);
+}
+
+void test_native_holdover_rides_through_missing_rtc(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 7, 0, 0));  // Monday
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_TRUE(controller.addSchedule(makeSchedule(0b00111110, 6, 0, 8, 0, "Morning")));
+    controller.enableHoldover(true);
+
+    // Connector pulled: the schedule keeps running on esp_timer
+    rtc.detach();
+    DS3231Host::advanceMs(10000);
+    TEST_ASSERT_TRUE(controller.isWithinAnySchedule());
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 7, 0, 10).unixtime(), controller.now().unixtime());
+    DS3231Controller::HealthReport health = controller.getHealth();
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::ClockHealth::Holdover),
+                            static_cast<uint8_t>(health.state));
+    TEST_ASSERT_EQUAL_UINT32(1, health.failedReads);
+    TEST_ASSERT_EQUAL_UINT32(2, health.holdoverReads);
+
+    // Backing off: no bus traffic until the retry is due, then one attempt
+    Wire.resetCounters();
+    (void)controller.now();
+    uint32_t idle = Wire.transactions();
+    TEST_ASSERT_EQUAL_UINT32(0, idle);
+    DS3231Host::advanceMs(1500);
+    (void)controller.now();
+    TEST_ASSERT_EQUAL_UINT16(2, controller.getHealth().consecutiveFailures);
+
+    rtc.attach();
+    DS3231Host::advanceMs(2500);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 7, 0, 14).unixtime(), controller.now().unixtime());
+    health = controller.getHealth();
+    TEST_ASSERT_EQUAL_UINT16(0, health.consecutiveFailures);
+    TEST_ASSERT_TRUE(health.state != DS3231Controller::ClockHealth::Holdover);
+    TEST_ASSERT_TRUE(health.score < 100);
+}
+
+void test_native_holdover_rejects_jump_until_confirmed(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 7, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    controller.enableHoldover(true);
+
+    // A garbage time is replaced by the software clock
+    rtc.setTime(DateTime(2031, 5, 5, 5, 5, 5));
+    DS3231Host::advanceMs(1000);
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 6, 7, 0, 1).unixtime(), controller.now().unixtime());
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getHealth().implausibleReads);
+
+    // Reads that keep agreeing mean the clock really was set
+    DS3231Host::advanceMs(1500);
+    (void)controller.now();
+    DS3231Host::advanceMs(2500);
+    uint32_t moved = controller.now().unixtime();
+    TEST_ASSERT_EQUAL_UINT32(DateTime(2031, 5, 5, 5, 5, 10).unixtime(), moved);
+    TEST_ASSERT_EQUAL_UINT32(2, controller.getHealth().implausibleReads);
+}
+
+void test_native_health_without_holdover_costs_no_bus(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 1, 6, 7, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    TEST_ASSERT_EQUAL_UINT8(100, controller.getHealth().score);
+
+    // Without holdover a failed read still reports an invalid time
+    rtc.detach();
+    TEST_ASSERT_FALSE(controller.now().isValid());
+    Wire.resetCounters();
+    DS3231Controller::HealthReport health = controller.getHealth();
+    uint32_t transactions = Wire.transactions();
+    TEST_ASSERT_EQUAL_UINT32(0, transactions);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DS3231Controller::ClockHealth::Failed),
+                            static_cast<uint8_t>(health.state));
+    TEST_ASSERT_FALSE(controller.isInHoldover());
+    TEST_ASSERT_TRUE(health.score < 100);
+}
+
+#ifdef DS3231_STATS
+// Collects printPrometheus() output
+class CapturePrint : public Print {
+public:
+    size_t write(uint8_t c) override { text += static_cast<char>(c); return 1; }
+    String text;
+};
+
+void test_native_stats_count_calls_and_waits(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    controller.resetStats();
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(controller.now().isValid());
+    }
+    const DS3231Controller::Stats& stats = controller.getStats();
+    const DS3231Controller::Stats::OpStats& now = stats.op(DS3231Controller::StatOp::Now);
+    TEST_ASSERT_EQUAL_UINT32(3, now.calls);
+    TEST_ASSERT_EQUAL_UINT32(3, now.waitHistogram[0]);  // Uncontended
+    TEST_ASSERT_EQUAL_UINT32(0, now.lockFailures);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.rtclibReads);
+
+    // Cached reads skip the lock but still count
+    controller.enableCachedClock(true);
+    TEST_ASSERT_TRUE(controller.reanchorClock());
+    TEST_ASSERT_TRUE(controller.now().isValid());
+    TEST_ASSERT_EQUAL_UINT32(4, now.calls);
+    TEST_ASSERT_EQUAL_UINT32(3, now.waitHistogram[0]);
+
+    CapturePrint out;
+    TEST_ASSERT_GREATER_THAN(0, controller.getStats().printPrometheus(out));
+    TEST_ASSERT_TRUE(out.text.indexOf("ds3231_calls_total{op=\"now\"} 4\n") >= 0);
+    TEST_ASSERT_TRUE(out.text.indexOf("ds3231_lock_wait_us_bucket{op=\"now\",le=\"+Inf\"} 3\n") >= 0);
+}
+
+void test_native_stats_charge_bus_errors_to_operation(void) {
+    DS3231Mock rtc;
+    rtc.attach();
+    rtc.setTime(DateTime(2025, 6, 1, 10, 0, 0));
+    DS3231Controller controller;
+    TEST_ASSERT_TRUE(controller.begin(&Wire));
+    controller.resetStats();
+
+    DS3231Controller::RegisterSnapshot snapshot;
+    TEST_ASSERT_TRUE(controller.readSnapshot(snapshot));
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getStats().i2cTransactions);
+
+    rtc.detach();  // Nobody answers at 0x68
+    TEST_ASSERT_FALSE(controller.readSnapshot(snapshot));
+    const DS3231Controller::Stats& stats = controller.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.i2cTransactions);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.i2cAddressNacks);
+    TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(DS3231Controller::StatError::I2cAddressNack),
+                             stats.op(DS3231Controller::StatOp::Snapshot).lastError);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.op(DS3231Controller::StatOp::Now).lastError);
+}
+#endif
+#endif
+
 // ============================================================================
 // Test Runner
 // ============================================================================
@@ -332,6 +1984,8 @@ void runAllTests() {
     RUN_TEST(test_format_day_mask_empty);
     RUN_TEST(test_format_day_mask_weekdays);
     RUN_TEST(test_format_day_mask_all_days);
+    RUN_TEST(test_format_day_mask_table_matches_masks);
+    RUN_TEST(test_format_day_mask_buffer_is_snprintf_style);
 
     // Constants and validation tests
     RUN_TEST(test_max_schedules_reasonable);
@@ -344,6 +1998,103 @@ void runAllTests() {
     RUN_TEST(test_day_mask_toggle);
     RUN_TEST(test_schedule_can_span_midnight);
 
+    // Snapshot evaluation
+    RUN_TEST(test_evaluate_at_active_window);
+    RUN_TEST(test_evaluate_at_idle_has_no_end);
+    RUN_TEST(test_evaluate_at_midnight_span_end);
+    RUN_TEST(test_evaluate_at_vacation_suppresses);
+
+    // Weekly transition table
+    RUN_TEST(test_transition_table_wraps_week);
+    RUN_TEST(test_transition_table_midnight_span_belongs_to_start_day);
+    RUN_TEST(test_transition_table_rebuilt_on_update);
+    RUN_TEST(test_coverage_merges_overlapping_and_touching);
+    RUN_TEST(test_coverage_crosses_week_end_and_rules);
+    RUN_TEST(test_coverage_round_the_clock_has_no_end);
+
+    // Recurrence rules
+    RUN_TEST(test_rule_monthly_clamps_to_month_end);
+    RUN_TEST(test_rule_every_n_days_and_date_range);
+    RUN_TEST(test_rule_once_far_ahead_and_weekly_mix);
+    RUN_TEST(test_rule_schedules_roundtrip_as_v3);
+
+    // What-if simulation
+    RUN_TEST(test_simulate_week_merges_on_time);
+    RUN_TEST(test_simulate_vacation_and_pump_exercise);
+    RUN_TEST(test_simulate_agrees_with_queries);
+
+    // Schedule storage
+    RUN_TEST(test_schedule_capacity_enforced);
+    RUN_TEST(test_schedule_name_roundtrip_truncates);
+    RUN_TEST(test_serialize_v2_compact_with_crc);
+    RUN_TEST(test_deserialize_v1_buffer);
+    RUN_TEST(test_deserialize_v1_buffer_small_names);
+    RUN_TEST(test_serialize_changes_delta);
+    RUN_TEST(test_store_commits_coalesced_and_restores);
+    RUN_TEST(test_eeprom_store_slot_geometry);
+
+    // State document
+    RUN_TEST(test_state_json_roundtrip);
+    RUN_TEST(test_state_json_carries_rules);
+    RUN_TEST(test_state_cbor_roundtrip_byte_by_byte);
+    RUN_TEST(test_state_import_merges_skips_and_rejects);
+    RUN_TEST(test_state_import_incomplete_document_removes_nothing);
+    RUN_TEST(test_state_import_publishes_pump_fields);
+
+    // Compile-time capacity
+    RUN_TEST(test_template_capacity_and_name_size);
+    RUN_TEST(test_template_default_alias);
+
+    // Lock-free read path
+    RUN_TEST(test_seq_latch_update_and_read);
+    RUN_TEST(test_snapshot_queries_follow_mutations);
+
+    // Register snapshot decoding
+    RUN_TEST(test_parse_registers_24h);
+    RUN_TEST(test_parse_registers_12h_and_invalid);
+
+    // Drift estimation
+    RUN_TEST(test_drift_estimate_prefers_reference_band);
+    RUN_TEST(test_edge_capture_requires_begin);
+    RUN_TEST(test_temperature_history_window_stats);
+    RUN_TEST(test_temperature_conversion_requires_begin);
+    RUN_TEST(test_time_zone_parses_posix_rules);
+    RUN_TEST(test_time_zone_resolves_skipped_and_repeated_hours);
+    RUN_TEST(test_time_zone_requires_valid_rules);
+
+    // Async bus requests
+    RUN_TEST(test_async_requests_need_worker);
+
+#ifdef DS3231_NATIVE
+    // Host backend
+    RUN_TEST(test_native_time_follows_mock_rtc);
+    RUN_TEST(test_native_schedule_engine_against_mock_clock);
+    RUN_TEST(test_native_alarm_for_far_edge_arms_waypoint);
+    RUN_TEST(test_native_store_debounce_commits_to_eeprom);
+    RUN_TEST(test_native_time_zone_keeps_rtc_in_utc);
+    RUN_TEST(test_native_temperature_timestamp_is_local);
+    RUN_TEST(test_native_bus_latency_and_cached_clock);
+    RUN_TEST(test_native_edge_capture_aligns_system_time);
+    RUN_TEST(test_native_status_into_caller_buffers);
+    RUN_TEST(test_native_follower_shares_source_clock);
+    RUN_TEST(test_native_failover_to_secondary_rtc);
+    RUN_TEST(test_native_failover_moves_sqw_mode);
+    RUN_TEST(test_native_begin_skips_primary_that_lost_power);
+    RUN_TEST(test_native_boot_is_one_read_and_one_write);
+    RUN_TEST(test_native_boot_policy_keeps_lost_time_and_wake_alarms);
+    RUN_TEST(test_native_boot_deferred_validation_only_probes);
+    RUN_TEST(test_native_events_queue_until_dispatched);
+    RUN_TEST(test_native_events_carry_type_and_payload);
+    RUN_TEST(test_native_full_event_queue_drops_and_counts);
+    RUN_TEST(test_native_holdover_rides_through_missing_rtc);
+    RUN_TEST(test_native_holdover_rejects_jump_until_confirmed);
+    RUN_TEST(test_native_health_without_holdover_costs_no_bus);
+#ifdef DS3231_STATS
+    RUN_TEST(test_native_stats_count_calls_and_waits);
+    RUN_TEST(test_native_stats_charge_bus_errors_to_operation);
+#endif
+#endif
+
     UNITY_END();
 }
 